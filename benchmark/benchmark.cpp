@@ -28,7 +28,16 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  */
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <numeric>
 #include <string>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 #include "benchmark.h"
 
@@ -46,6 +55,8 @@ Benchmark<T>::Benchmark(Params_t* params)
     this->pkt_size = params->pkt_size;
     this->chunk_size = params->chunk_size;
     this->samples_nb = params->samples_nb;
+    this->allocator =
+        quadiron::simd::AlignedAllocator<uint8_t>(params->alloc_policy);
     if (params->extra_param > -1) {
         this->extra_param = params->extra_param;
     }
@@ -147,6 +158,12 @@ Benchmark<T>::~Benchmark()
         delete enc_stats;
     if (dec_stats != nullptr)
         delete dec_stats;
+    if (enc_e2e_stats != nullptr)
+        delete enc_e2e_stats;
+    if (dec_e2e_stats != nullptr)
+        delete dec_e2e_stats;
+    if (dec_setup_stats != nullptr)
+        delete dec_setup_stats;
 }
 
 template <typename T>
@@ -187,6 +204,7 @@ int Benchmark<T>::init()
         return ERR_FEC_TYPE_NOT_SUPPORTED;
     }
 
+    fec->set_alloc_policy(params->alloc_policy);
     this->systematic_ec = (fec->type == quadiron::fec::FecType::SYSTEMATIC);
     if (this->systematic_ec) {
         this->n_c = this->m;
@@ -270,6 +288,10 @@ int Benchmark<T>::init()
 
     this->enc_stats = new Stats_t("Encode", chunk_size * n_c);
     this->dec_stats = new Stats_t("Decode", chunk_size * k);
+    this->enc_e2e_stats =
+        new Stats_t("Encode (end-to-end)", chunk_size * n_c);
+    this->dec_e2e_stats = new Stats_t("Decode (end-to-end)", chunk_size * k);
+    this->dec_setup_stats = new Stats_t("Decode setup", chunk_size * k);
     return 1;
 }
 
@@ -430,13 +452,69 @@ void Benchmark<T>::reset_r_streams()
     }
 }
 
+/** Draw lost fragments according to the erasure pattern
+ *
+ * Fragments are indexed as `a_streams`, i.e. data fragments come first for
+ * systematic codes. Systematic codes always lose at least a data fragment so
+ * that a decoding is needed.
+ *
+ * @param erased set to true for each lost fragment
+ */
+template <typename T>
+void Benchmark<T>::get_erased_chunks(std::vector<bool>& erased)
+{
+    // fragments whose loss requires a decoding
+    const int n_needed = systematic_ec ? k : n;
+
+    std::fill(erased.begin(), erased.end(), false);
+    switch (params->erasures) {
+    case ERASURE_SINGLE:
+        erased[std::rand() % n_needed] = true;
+        break;
+    case ERASURE_RACK: {
+        // racks hold m consecutive fragments
+        const int n_racks = (n_needed - 1) / m + 1;
+        const int first = (std::rand() % n_racks) * m;
+        for (int i = first; i < std::min(first + m, n); i++) {
+            erased[i] = true;
+        }
+        break;
+    }
+    case ERASURE_WORST: {
+        // use as many parities as possible
+        std::vector<int> ids(n_needed);
+        std::iota(ids.begin(), ids.end(), 0);
+        std::random_shuffle(ids.begin(), ids.end());
+        for (int i = 0; i < std::min(m, n_needed); i++) {
+            erased[ids[i]] = true;
+        }
+        break;
+    }
+    case ERASURE_RANDOM:
+    default:
+        break;
+    }
+}
+
 template <typename T>
 void Benchmark<T>::get_avail_chunks(
     std::vector<std::istream*>* avail_d_chunks,
     std::vector<std::istream*>* avail_c_chunks,
     std::vector<quadiron::Properties>& avail_c_props)
 {
-    std::random_shuffle(c_chunks_id->begin(), c_chunks_id->end());
+    if (params->erasures == ERASURE_RANDOM) {
+        std::random_shuffle(c_chunks_id->begin(), c_chunks_id->end());
+    } else {
+        // read the surviving fragments with the lowest indices, i.e. data
+        // fragments first as a degraded read does
+        std::vector<bool> erased(n);
+        get_erased_chunks(erased);
+        std::iota(c_chunks_id->begin(), c_chunks_id->end(), 0);
+        std::stable_partition(
+            c_chunks_id->begin(), c_chunks_id->end(), [&erased](int id) {
+                return !erased[id];
+            });
+    }
 
     int i;
     for (i = 0; i < k; i++) {
@@ -477,13 +555,19 @@ bool Benchmark<T>::encode()
     reset_d_streams();
     reset_c_streams();
 
+    const auto start = std::chrono::steady_clock::now();
     if (operation_on_packet)
         fec->encode_packet(*d_streams, *c_streams, c_props);
     else
         fec->encode_bufs(*d_streams, *c_streams, c_props);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
 
     // update stats
-    enc_stats->add(fec->total_enc_usec);
+    enc_stats->add(static_cast<uint64_t>(
+        fec->stats.get_ns(quadiron::fec::Phase::ENCODE)));
+    enc_e2e_stats->add(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+            .count());
 
     // dump("d_chunks", d_chunks);
     // dump("c_chunks", c_chunks);
@@ -505,6 +589,7 @@ bool Benchmark<T>::decode()
     reset_a_streams();
     reset_r_streams();
 
+    const auto start = std::chrono::steady_clock::now();
     if (operation_on_packet) {
         if (!fec->decode_packet(
                 d_streams_shuffled,
@@ -520,6 +605,7 @@ bool Benchmark<T>::decode()
                 *r_streams))
             return false;
     }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
 
     if (!compare(d_chunks, r_chunks)) {
         std::cerr << errors_desc.at(ERR_FAILED_REPAIR_CHUNK) << std::endl;
@@ -534,38 +620,52 @@ bool Benchmark<T>::decode()
     }
 
     // update stats
-    dec_stats->add(fec->total_dec_usec);
+    dec_stats->add(static_cast<uint64_t>(
+        fec->stats.get_ns(quadiron::fec::Phase::DECODE)));
+    dec_e2e_stats->add(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+            .count());
+    dec_setup_stats->add(static_cast<uint64_t>(
+        fec->stats.get_ns(quadiron::fec::Phase::CONTEXT)));
 
     return true;
 }
 
 template <typename T>
-void Benchmark<T>::show(Stats_t* stats)
+void Benchmark<T>::show(bool with_dec)
 {
-    if (params->compact_print == 2) {
-        params->show_ec_desc();
-        stats->show();
+    std::vector<Stats_t*> stats = {enc_stats, enc_e2e_stats};
+    if (with_dec) {
+        stats.push_back(dec_stats);
+        stats.push_back(dec_e2e_stats);
+        stats.push_back(dec_setup_stats);
     } else {
-        params->show_params();
-        params->show_speed(
-            stats->get_avg(), stats->get_std_dev(), stats->get_thrpt());
-        params->show_end();
+        stats.resize(record_keys.size(), nullptr);
     }
-}
 
-template <typename T>
-void Benchmark<T>::show(Stats_t* stats1, Stats_t* stats2)
-{
-    if (params->compact_print == 2) {
+    if (params->out_format != OUTPUT_TABLE) {
+        params->show_record(stats);
+    } else if (params->compact_print == 2) {
         params->show_ec_desc();
-        stats1->show();
-        stats2->show();
+        for (Stats_t* st : stats) {
+            if (st != nullptr) {
+                st->show();
+            }
+        }
     } else {
         params->show_params();
-        params->show_speed(
-            stats1->get_avg(), stats1->get_std_dev(), stats1->get_thrpt());
-        params->show_speed(
-            stats2->get_avg(), stats2->get_std_dev(), stats2->get_thrpt());
+        for (Stats_t* st : {stats[0], stats[2]}) {
+            if (st != nullptr) {
+                params->show_speed(
+                    st->get_avg(),
+                    st->get_std_dev(),
+                    st->get_percentile(0.99),
+                    st->get_thrpt());
+            }
+        }
+        if (with_dec) {
+            params->show_setup(dec_setup_stats->get_avg());
+        }
         params->show_end();
     }
 }
@@ -574,6 +674,7 @@ template <typename T>
 bool Benchmark<T>::enc_only()
 {
     enc_stats->begin();
+    enc_e2e_stats->begin();
     // this operation is done once per benchmark
     gen_data();
 
@@ -583,7 +684,8 @@ bool Benchmark<T>::enc_only()
     }
 
     enc_stats->end();
-    show(enc_stats);
+    enc_e2e_stats->end();
+    show(false);
 
     return true;
 }
@@ -592,7 +694,10 @@ template <typename T>
 bool Benchmark<T>::dec_only()
 {
     enc_stats->begin();
+    enc_e2e_stats->begin();
     dec_stats->begin();
+    dec_e2e_stats->begin();
+    dec_setup_stats->begin();
 
     // this operation is done once per benchmark
     gen_data();
@@ -606,8 +711,11 @@ bool Benchmark<T>::dec_only()
     }
 
     enc_stats->end();
+    enc_e2e_stats->end();
     dec_stats->end();
-    show(enc_stats, dec_stats);
+    dec_e2e_stats->end();
+    dec_setup_stats->end();
+    show(true);
 
     return true;
 }
@@ -616,7 +724,10 @@ template <typename T>
 bool Benchmark<T>::enc_dec()
 {
     enc_stats->begin();
+    enc_e2e_stats->begin();
     dec_stats->begin();
+    dec_e2e_stats->begin();
+    dec_setup_stats->begin();
 
     // this operation is done once per benchmark
     gen_data();
@@ -629,8 +740,54 @@ bool Benchmark<T>::enc_dec()
     }
 
     enc_stats->end();
+    enc_e2e_stats->end();
     dec_stats->end();
-    show(enc_stats, dec_stats);
+    dec_e2e_stats->end();
+    dec_setup_stats->end();
+    show(true);
+    return true;
+}
+
+template <typename T>
+bool Benchmark<T>::prepare()
+{
+    // this operation is done once per benchmark
+    gen_data();
+
+    if (params->sce_type != DEC_ONLY)
+        return true;
+
+    // the encoding needed by decodings is not part of the measures
+    const bool stats_enabled = fec->get_stats_enabled();
+    fec->set_stats_enabled(false);
+    const bool ok = encode();
+    fec->set_stats_enabled(stats_enabled);
+
+    return ok;
+}
+
+/** Run the operations of the scenario without showing results
+ *
+ * @param bytes incremented by the size of data processed by each operation
+ * @return false if an operation failed
+ */
+template <typename T>
+bool Benchmark<T>::run_ops(uint64_t& bytes)
+{
+    const uint64_t op_bytes = static_cast<uint64_t>(k) * chunk_size;
+
+    for (uint32_t i = 0; i < samples_nb; i++) {
+        if (params->sce_type != DEC_ONLY) {
+            if (!encode())
+                return false;
+            bytes += op_bytes;
+        }
+        if (params->sce_type != ENC_ONLY) {
+            if (!decode())
+                return false;
+            bytes += op_bytes;
+        }
+    }
     return true;
 }
 
@@ -661,8 +818,23 @@ bool Benchmark<T>::enc_dec()
               << "\t-n \tNumber of samples per operation\n"
               << "\t-t \tSize of used integer type, either "
               << "2, 4, 8, 16 for uint16_t, uint32_t, uint64_t, __uint128_t\n"
+              << "\t-d \tErasure pattern of decodings, either\n"
+              << "\t\t\trandom: Any k available chunks\n"
+              << "\t\t\tsingle: A single lost chunk\n"
+              << "\t\t\track: Loss of a rack of m consecutive chunks\n"
+              << "\t\t\tworst: m lost chunks, all data ones if systematic\n"
+              << "\t-O \tSweep object sizes from 4K up to the given size "
+              << "(bytes,\n\t\tK, M or G suffixes are accepted), chunks "
+              << "are rounded up to\n\t\twhole packets\n"
+              << "\t-H \tHuge pages backing buffers, either none, thp "
+              << "(transparent)\n\t\tor hugetlb (explicit)\n"
+              << "\t-N \tNUMA placement of buffers, either none, first-touch "
+              << "or bind\n\t\t(to the node of the allocating thread)\n"
               << "\t-g \tNumber of threads\n"
-              << "\t-x \tExtra parameter\n\n";
+              << "\t-S \tSweep 1, 2, 4, ... up to the given number of "
+              << "pinned threads\n\t\tand report their scaling\n"
+              << "\t-x \tExtra parameter\n"
+              << "\t-o \tOutput format, either table, csv or json\n\n";
     std::exit(EXIT_FAILURE);
 }
 
@@ -735,14 +907,335 @@ static void do_join(std::thread& t)
     t.join();
 }
 
+/** Outcome of a thread of a scaling step */
+struct ScalingResult {
+    bool ok = false;
+    uint64_t bytes = 0;
+    quadiron::fec::Stats stats;
+};
+
+/** Barrier releasing all threads of a scaling step at once */
+class ScalingBarrier {
+  public:
+    void arrive_and_wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready++;
+        cond.notify_all();
+        cond.wait(lock, [this] { return go; });
+    }
+
+    void wait_ready(uint32_t threads_nb)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [this, threads_nb] { return ready == threads_nb; });
+    }
+
+    void release()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        go = true;
+        cond.notify_all();
+    }
+
+  private:
+    std::mutex mutex;
+    std::condition_variable cond;
+    uint32_t ready = 0;
+    bool go = false;
+};
+
+static void pin_thread(unsigned cpu)
+{
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+}
+
+template <typename T>
+static void scaling_worker(
+    Params_t* params,
+    unsigned cpu,
+    ScalingBarrier* barrier,
+    ScalingResult* result)
+{
+    pin_thread(cpu);
+
+    // built once pinned so that buffers are first touched by their core
+    std::unique_ptr<Benchmark<T>> bench;
+    try {
+        bench.reset(new Benchmark<T>(params));
+        result->ok = bench->prepare();
+    } catch (const std::exception&) {
+        result->ok = false;
+    }
+
+    barrier->arrive_and_wait();
+
+    if (result->ok) {
+        result->ok = bench->run_ops(result->bytes);
+        result->stats = quadiron::fec::get_thread_stats();
+    }
+}
+
+/** Measures of all threads of a scaling step */
+struct ScalingStep {
+    uint32_t threads_nb = 0;
+    double wall_ns = 0;
+    uint64_t bytes = 0;
+    quadiron::fec::Stats stats;
+
+    // GB/s
+    double get_thrpt() const
+    {
+        return wall_ns > 0 ? static_cast<double>(bytes) / wall_ns : 0;
+    }
+};
+
+template <typename T>
+static bool
+run_scaling_step(Params_t* params, uint32_t threads_nb, ScalingStep* step)
+{
+    const unsigned cpus_nb = std::max(1U, std::thread::hardware_concurrency());
+    ScalingBarrier barrier;
+    std::vector<ScalingResult> results(threads_nb);
+    std::vector<std::thread> threads;
+
+    for (uint32_t i = 0; i < threads_nb; i++) {
+        threads.emplace_back(
+            scaling_worker<T>, params, i % cpus_nb, &barrier, &results[i]);
+    }
+    barrier.wait_ready(threads_nb);
+    const auto start = std::chrono::steady_clock::now();
+    barrier.release();
+    std::for_each(threads.begin(), threads.end(), do_join);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    step->threads_nb = threads_nb;
+    step->wall_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    step->bytes = 0;
+    step->stats.reset();
+    for (const ScalingResult& result : results) {
+        if (!result.ok)
+            return false;
+        step->bytes += result.bytes;
+        step->stats += result.stats;
+    }
+    return true;
+}
+
+/** Cycles per byte of data spent in each phase
+ *
+ * Cycles of operations that are not accounted to any phase, e.g. allocations
+ * of buffers, are reported as `other`.
+ */
+static std::vector<std::pair<std::string, double>>
+get_phase_costs(const ScalingStep& step)
+{
+    std::vector<std::pair<std::string, double>> costs;
+    const double bytes = static_cast<double>(std::max<uint64_t>(step.bytes, 1));
+    uint64_t accounted = 0;
+
+    for (unsigned i = 0; i < quadiron::fec::NB_PHASES; i++) {
+        const auto phase = static_cast<quadiron::fec::Phase>(i);
+        // nested in the encoding phase
+        if (phase == quadiron::fec::Phase::POST_PROCESS)
+            continue;
+        const uint64_t cycles = step.stats.get(phase).cycles;
+        accounted += cycles;
+        costs.emplace_back(quadiron::fec::phase_name(phase), cycles / bytes);
+    }
+    const uint64_t wall = step.stats.get_wall_cycles();
+    const uint64_t other = wall > accounted ? wall - accounted : 0;
+    costs.emplace_back("other", other / bytes);
+
+    return costs;
+}
+
+/** Phases whose cost per byte grows the most vs. a single thread
+ *
+ * @return pairs of phase name and ratio of costs, largest increase first
+ */
+static std::vector<std::pair<std::string, double>>
+get_hotspots(const ScalingStep& base, const ScalingStep& step)
+{
+    // increases below this ratio are considered as noise
+    static const double threshold = 1.2;
+    static const size_t max_hotspots = 3;
+
+    const auto base_costs = get_phase_costs(base);
+    const auto costs = get_phase_costs(step);
+    std::vector<std::pair<double, size_t>> increases;
+
+    for (size_t i = 0; i < costs.size(); i++) {
+        const double base_cost = base_costs[i].second;
+        if (base_cost > 0 && costs[i].second >= threshold * base_cost) {
+            increases.emplace_back(costs[i].second - base_cost, i);
+        }
+    }
+    std::sort(increases.rbegin(), increases.rend());
+    if (increases.size() > max_hotspots)
+        increases.resize(max_hotspots);
+
+    std::vector<std::pair<std::string, double>> hotspots;
+    for (const auto& increase : increases) {
+        const size_t i = increase.second;
+        hotspots.emplace_back(
+            costs[i].first, costs[i].second / base_costs[i].second);
+    }
+    return hotspots;
+}
+
+static void show_scaling_step(
+    Params_t* params,
+    const ScalingStep& base,
+    const ScalingStep& step)
+{
+    const double per_thread = step.get_thrpt() / step.threads_nb;
+    const double base_thrpt = base.get_thrpt();
+    const double efficiency = base_thrpt > 0 ? per_thread / base_thrpt : 0;
+    const auto hotspots = get_hotspots(base, step);
+    std::ostringstream os;
+
+    if (params->out_format == OUTPUT_TABLE) {
+        os << "  " << std::setw(7) << step.threads_nb << "  " << std::setw(16)
+           << step.get_thrpt() << "  " << std::setw(17) << per_thread << "  "
+           << std::setw(10) << efficiency << "  ";
+        for (const auto& hotspot : hotspots) {
+            os << " " << hotspot.first << " x" << std::setprecision(3)
+               << hotspot.second;
+        }
+        os << "\n";
+    } else if (params->out_format == OUTPUT_CSV) {
+        os << ec_desc_short.at(params->fec_type) << ","
+           << sce_desc_short.at(params->sce_type) << "," << step.threads_nb
+           << "," << step.get_thrpt() << "," << per_thread << ","
+           << efficiency << ",";
+        for (size_t i = 0; i < hotspots.size(); i++) {
+            os << (i > 0 ? ";" : "") << hotspots[i].first << ":"
+               << hotspots[i].second;
+        }
+        os << "\n";
+    } else {
+        os << "{\"fec\": \"" << ec_desc_short.at(params->fec_type)
+           << "\", \"scenario\": \"" << sce_desc_short.at(params->sce_type)
+           << "\", \"threads\": " << step.threads_nb
+           << ", \"gbs\": " << step.get_thrpt()
+           << ", \"gbs_per_thread\": " << per_thread
+           << ", \"efficiency\": " << efficiency << ", \"hotspots\": {";
+        for (size_t i = 0; i < hotspots.size(); i++) {
+            os << (i > 0 ? ", " : "") << "\"" << hotspots[i].first
+               << "\": " << hotspots[i].second;
+        }
+        os << "}}\n";
+    }
+    std::cout << os.str() << std::flush;
+}
+
+/** Sweep numbers of threads and show how throughput scales
+ *
+ * Threads are pinned to distinct cores and released together. Each thread
+ * runs its own codec built from the same parameters: codecs keep scratch
+ * buffers and statistics that can not be shared by concurrent operations.
+ */
+template <typename T>
+static void run_scaling(Params_t* params)
+{
+    std::vector<uint32_t> threads_nbs;
+    for (uint32_t nb = 1; nb < params->scaling_max_threads; nb *= 2) {
+        threads_nbs.push_back(nb);
+    }
+    threads_nbs.push_back(params->scaling_max_threads);
+
+    if (params->out_format == OUTPUT_TABLE) {
+        std::cout << "\nScaling of " << ec_desc.at(params->fec_type) << " ("
+                  << sce_desc_short.at(params->sce_type)
+                  << ", k=" << params->k << ", m=" << params->m
+                  << ", w=" << params->word_size
+                  << ", chunk size=" << params->chunk_size << ") on "
+                  << std::thread::hardware_concurrency() << " cpus\n"
+                  << "  threads  aggregate (GB/s)  per thread (GB/s)"
+                  << "  efficiency   hotspots (cost per byte vs. 1 thread)\n";
+    }
+
+    ScalingStep base;
+    for (uint32_t threads_nb : threads_nbs) {
+        ScalingStep step;
+        if (!run_scaling_step<T>(params, threads_nb, &step))
+            return;
+        if (threads_nb == 1)
+            base = step;
+        show_scaling_step(params, base, step);
+    }
+}
+
+static void run_scaling_scenario(Params_t* params)
+{
+    // get sizeof_T if necessary
+    params->get_sizeof_T();
+
+    switch (params->sizeof_T) {
+    case 2:
+        run_scaling<uint16_t>(params);
+        break;
+    case 4:
+        run_scaling<uint32_t>(params);
+        break;
+    case 8:
+        run_scaling<uint64_t>(params);
+        break;
+    case 16:
+        run_scaling<__uint128_t>(params);
+        break;
+    default:
+        std::cerr << errors_desc.at(ERR_T_NOT_SUPPORTED)
+                  << " T: " << params->sizeof_T << std::endl;
+        exit(0);
+    }
+}
+
+/** Parse a size in bytes with an optional K, M or G binary suffix */
+static uint64_t parse_size(const std::string& str)
+{
+    size_t pos;
+    uint64_t size = std::stoull(str, &pos);
+    if (pos < str.size()) {
+        switch (str[pos]) {
+        case 'G':
+        case 'g':
+            size <<= 10;
+            /* FALLTHROUGH */
+        case 'M':
+        case 'm':
+            size <<= 10;
+            /* FALLTHROUGH */
+        case 'K':
+        case 'k':
+            size <<= 10;
+            break;
+        default:
+            xusage();
+        }
+    }
+    return size;
+}
+
 int main(int argc, char** argv)
 {
     PRNG prng;
     Params_t* params;
     int opt;
+    uint64_t max_object_size = 0;
 
     params = new Params_t();
-    while ((opt = getopt(argc, argv, "t:e:w:k:m:c:n:s:x:g:p:f:")) != -1) {
+    const char* opts = "t:e:w:k:m:c:n:s:d:O:H:N:x:g:S:p:f:o:";
+    while ((opt = getopt(argc, argv, opts)) != -1) {
         switch (opt) {
         case 't':
             params->sizeof_T = std::stoi(optarg);
@@ -763,6 +1256,28 @@ int main(int argc, char** argv)
             }
             params->sce_type = sce_type_map.at(optarg);
             break;
+        case 'd':
+            if (erasure_pattern_map.find(optarg)
+                == erasure_pattern_map.end()) {
+                xusage();
+            }
+            params->erasures = erasure_pattern_map.at(optarg);
+            break;
+        case 'O':
+            max_object_size = parse_size(optarg);
+            break;
+        case 'H':
+            if (huge_pages_map.find(optarg) == huge_pages_map.end()) {
+                xusage();
+            }
+            params->alloc_policy.huge_pages = huge_pages_map.at(optarg);
+            break;
+        case 'N':
+            if (numa_map.find(optarg) == numa_map.end()) {
+                xusage();
+            }
+            params->alloc_policy.numa = numa_map.at(optarg);
+            break;
         case 'w':
             params->word_size = std::stoi(optarg);
             break;
@@ -787,9 +1302,18 @@ int main(int argc, char** argv)
         case 'g':
             params->threads_nb = std::stoi(optarg);
             break;
+        case 'S':
+            params->scaling_max_threads = std::stoi(optarg);
+            break;
         case 'f':
             params->compact_print = std::stoi(optarg);
             break;
+        case 'o':
+            if (output_format_map.find(optarg) == output_format_map.end()) {
+                xusage();
+            }
+            params->out_format = output_format_map.at(optarg);
+            break;
         default:
             xusage();
         }
@@ -805,16 +1329,66 @@ int main(int argc, char** argv)
     if (params->pkt_size <= 0) {
         params->operation_on_packet = false;
     }
-    if (params->compact_print == 2)
+    if (params->scaling_max_threads > 0) {
+        if (params->out_format == OUTPUT_CSV) {
+            std::cout << "fec,scenario,threads,gbs,gbs_per_thread,efficiency,"
+                      << "hotspots\n";
+        }
+        if (params->fec_type == EC_TYPE_ALL) {
+            for (int type = EC_TYPE_ALL + 1; type < EC_TYPE_END; type++) {
+                params->fec_type = static_cast<ec_type>(type);
+                run_scaling_scenario(params);
+            }
+        } else {
+            run_scaling_scenario(params);
+        }
+        delete params;
+        return 0;
+    }
+
+    if (params->out_format != OUTPUT_TABLE) {
+        if (params->compact_print > 0)
+            params->show_header();
+    } else if (params->compact_print == 2)
         params->print();
     else if (params->compact_print == 1)
         params->show_header();
 
-    std::vector<std::thread> threads;
-    for (uint32_t thr = 0; thr < params->threads_nb; thr++) {
-        threads.push_back(std::thread(run_benchmark, params));
+    // chunks are rounded up to whole packets as in Benchmark::check_params()
+    // so that the reported chunk size is the coded one
+    const size_t align =
+        params->pkt_size > 0 ? params->pkt_size * params->word_size : 1;
+    const auto align_chunk_size = [align](size_t chunk_size) {
+        return (chunk_size % align > 0)
+                   ? ((chunk_size - 1) / align + 1) * align
+                   : chunk_size;
+    };
+
+    std::vector<size_t> chunk_sizes = {align_chunk_size(params->chunk_size)};
+    if (max_object_size > 0) {
+        // object sizes from 4K, each one 4 times larger than the previous
+        chunk_sizes.clear();
+        for (uint64_t size = 4096; size < max_object_size; size *= 4) {
+            chunk_sizes.push_back(align_chunk_size((size - 1) / params->k + 1));
+        }
+        chunk_sizes.push_back(
+            align_chunk_size((max_object_size - 1) / params->k + 1));
+        // small objects may be rounded up to the same chunk size
+        chunk_sizes.erase(
+            std::unique(chunk_sizes.begin(), chunk_sizes.end()),
+            chunk_sizes.end());
+    }
+
+    const ec_type fec_type = params->fec_type;
+    for (size_t chunk_size : chunk_sizes) {
+        params->fec_type = fec_type;
+        params->chunk_size = chunk_size;
+        std::vector<std::thread> threads;
+        for (uint32_t thr = 0; thr < params->threads_nb; thr++) {
+            threads.push_back(std::thread(run_benchmark, params));
+        }
+        std::for_each(threads.begin(), threads.end(), do_join);
     }
-    std::for_each(threads.begin(), threads.end(), do_join);
 
     delete params;
     return 0;
@@ -31,11 +31,15 @@
 #ifndef __QUAD_BENCH_BENCHMARK_H__
 #define __QUAD_BENCH_BENCHMARK_H__
 
+#include <chrono>
 #include <iomanip>
 #include <map>
+#include <sstream>
 #include <thread>
+#include <vector>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include "quadiron.h"
 #include "simd/simd.h"
@@ -157,6 +161,90 @@ const std::map<int, std::string> sce_desc_short = {
     {ENC_DEC, "enc & dec"},
 };
 
+// Distribution of erasure patterns of decodings
+enum erasure_pattern {
+    // any k available fragments, drawn uniformly
+    ERASURE_RANDOM = 0,
+    // a single lost fragment
+    ERASURE_SINGLE,
+    // all fragments of a rack of m consecutive fragments are lost
+    ERASURE_RACK,
+    // m lost fragments, all data ones for systematic codes
+    ERASURE_WORST,
+};
+
+// NOLINTNEXTLINE(cert-err58-cpp)
+const std::map<std::string, erasure_pattern> erasure_pattern_map = {
+    {"random", ERASURE_RANDOM},
+    {"single", ERASURE_SINGLE},
+    {"rack", ERASURE_RACK},
+    {"worst", ERASURE_WORST},
+};
+
+// NOLINTNEXTLINE(cert-err58-cpp)
+const std::map<int, std::string> erasure_pattern_desc = {
+    {ERASURE_RANDOM, "random"},
+    {ERASURE_SINGLE, "single"},
+    {ERASURE_RACK, "rack"},
+    {ERASURE_WORST, "worst"},
+};
+
+// NOLINTNEXTLINE(cert-err58-cpp)
+const std::map<std::string, quadiron::simd::HugePages> huge_pages_map = {
+    {"none", quadiron::simd::HugePages::NONE},
+    {"thp", quadiron::simd::HugePages::TRANSPARENT},
+    {"hugetlb", quadiron::simd::HugePages::EXPLICIT},
+};
+
+// NOLINTNEXTLINE(cert-err58-cpp)
+const std::map<std::string, quadiron::simd::NumaPlacement> numa_map = {
+    {"none", quadiron::simd::NumaPlacement::NONE},
+    {"first-touch", quadiron::simd::NumaPlacement::FIRST_TOUCH},
+    {"bind", quadiron::simd::NumaPlacement::BIND_LOCAL},
+};
+
+enum output_format {
+    OUTPUT_TABLE = 0,
+    OUTPUT_CSV,
+    OUTPUT_JSON,
+};
+
+// NOLINTNEXTLINE(cert-err58-cpp)
+const std::map<std::string, output_format> output_format_map = {
+    {"table", OUTPUT_TABLE},
+    {"csv", OUTPUT_CSV},
+    {"json", OUTPUT_JSON},
+};
+
+// Keys of measures in CSV and JSON records: kernel time and end-to-end time
+// of encodings and decodings, and time to set decodings up
+// NOLINTNEXTLINE(cert-err58-cpp)
+const std::vector<std::string> record_keys = {
+    "enc",
+    "enc_e2e",
+    "dec",
+    "dec_e2e",
+    "dec_setup",
+};
+
+static inline const char* simd_backend()
+{
+#if defined(QUADIRON_USE_SIMD) && defined(__AVX2__)
+    return "avx2";
+#elif defined(QUADIRON_USE_SIMD) && defined(__SSE4_1__)
+    return "sse4.1";
+#else
+    return "none";
+#endif
+}
+
+static inline std::string host_name()
+{
+    char name[256] = {0};
+    gethostname(name, sizeof(name) - 1);
+    return name;
+}
+
 struct Params_t {
     ec_type fec_type = EC_TYPE_ALL;
     size_t word_size = 2;
@@ -169,11 +257,17 @@ struct Params_t {
     int extra_param = -1;
     int sizeof_T = -1;
     scenario_type sce_type = ENC_DEC;
+    erasure_pattern erasures = ERASURE_RANDOM;
     uint32_t threads_nb = 4;
+    // largest number of threads of the scaling sweep, 0 to disable it
+    uint32_t scaling_max_threads = 0;
+    // allocation of chunks and of buffers of codecs
+    quadiron::simd::AllocPolicy alloc_policy;
     // 0: show only params + speed
     // 1: show header + params + speed
     // 2: full show
     int compact_print = 1;
+    output_format out_format = OUTPUT_TABLE;
     std::string* header = nullptr;
 
     void print()
@@ -183,6 +277,8 @@ struct Params_t {
                   << std::endl;
         std::cout << "Scenario benchmark:   " << sce_desc.at(sce_type)
                   << std::endl;
+        std::cout << "Erasure pattern:      "
+                  << erasure_pattern_desc.at(erasures) << std::endl;
         std::cout << "Word size:            " << word_size << std::endl;
         std::cout << "Number of data:       " << k << std::endl;
         std::cout << "Number of parity:     " << m << std::endl;
@@ -192,6 +288,18 @@ struct Params_t {
                   << std::endl;
         std::cout << "Number of samples:    " << samples_nb << std::endl;
         std::cout << "Number of threads:    " << threads_nb << std::endl;
+        for (const auto& entry : huge_pages_map) {
+            if (entry.second == alloc_policy.huge_pages) {
+                std::cout << "Huge pages:           " << entry.first
+                          << std::endl;
+            }
+        }
+        for (const auto& entry : numa_map) {
+            if (entry.second == alloc_policy.numa) {
+                std::cout << "NUMA placement:       " << entry.first
+                          << std::endl;
+            }
+        }
         if (sizeof_T > -1)
             std::cout << "Size of integer type: " << sizeof_T << std::endl;
         if (extra_param > -1)
@@ -216,8 +324,9 @@ struct Params_t {
             begin + "            FEC" + "| scenario  " + "|       k"
             + "|       m" + "|       w" + "| T size " + "| chunk size  "
             + "| packet size " + "| #samples " + "| #threads "
-            + "| Encoding   lat (us)       throuput (MB/s) "
-            + "| Decoding   lat (us)       throuput (MB/s) " + end;
+            + "| Encoding   lat (us)    p99 (us)    throuput (MB/s) "
+            + "| Decoding   lat (us)    p99 (us)    throuput (MB/s) "
+            + "| Dec setup (us) " + end;
 
         std::string bare(content.length() - begin.length() - end.length(), '-');
         bare = begin + bare + end;
@@ -230,7 +339,84 @@ struct Params_t {
 
     void show_header()
     {
-        std::cout << get_header()->c_str();
+        if (out_format == OUTPUT_CSV) {
+            std::cout << "version,simd,host,fec,scenario,k,m,w,T,chunk_size,"
+                      << "object_size,pkt_size,samples,threads,erasures";
+            for (auto const& key : record_keys) {
+                std::cout << "," << key << "_avg_us," << key << "_std_us,"
+                          << key << "_p50_us," << key << "_p99_us," << key
+                          << "_p999_us," << key << "_max_us," << key
+                          << "_mbs";
+            }
+            std::cout << "\n";
+        } else if (out_format == OUTPUT_TABLE) {
+            std::cout << get_header()->c_str();
+        }
+    }
+
+    /** Show a CSV or JSON record of a benchmark
+     *
+     * @param stats statistics of each key of `record_keys`, nullptr for
+     * measures that are not part of the scenario
+     */
+    void show_record(const std::vector<Stats_t*>& stats)
+    {
+        const bool csv = out_format == OUTPUT_CSV;
+        std::ostringstream os;
+        const size_t pkt = operation_on_packet ? pkt_size : 0;
+        // size of the coded object, i.e. of its k data chunks
+        const size_t object_size = k * chunk_size;
+
+        if (csv) {
+            os << VERSION << "," << simd_backend() << "," << host_name()
+               << "," << ec_desc_short.at(fec_type) << ","
+               << sce_desc_short.at(sce_type) << "," << k << "," << m << ","
+               << word_size << "," << sizeof_T << "," << chunk_size << ","
+               << object_size << "," << pkt << "," << samples_nb << ","
+               << threads_nb << "," << erasure_pattern_desc.at(erasures);
+        } else {
+            os << "{\"version\": \"" << VERSION << "\", \"simd\": \""
+               << simd_backend() << "\", \"host\": \"" << host_name()
+               << "\", \"fec\": \"" << ec_desc_short.at(fec_type)
+               << "\", \"scenario\": \"" << sce_desc_short.at(sce_type)
+               << "\", \"k\": " << k << ", \"m\": " << m
+               << ", \"w\": " << word_size << ", \"T\": " << sizeof_T
+               << ", \"chunk_size\": " << chunk_size
+               << ", \"object_size\": " << object_size
+               << ", \"pkt_size\": " << pkt << ", \"samples\": " << samples_nb
+               << ", \"threads\": " << threads_nb << ", \"erasures\": \""
+               << erasure_pattern_desc.at(erasures) << "\", \"results\": {";
+        }
+
+        bool first = true;
+        for (size_t i = 0; i < record_keys.size(); ++i) {
+            Stats_t* st = stats.at(i);
+            if (csv) {
+                if (st == nullptr) {
+                    os << ",,,,,,,";
+                    continue;
+                }
+                os << "," << st->get_avg() << "," << st->get_std_dev() << ","
+                   << st->get_percentile(0.5) << ","
+                   << st->get_percentile(0.99) << ","
+                   << st->get_percentile(0.999) << "," << st->get_max()
+                   << "," << st->get_thrpt();
+            } else if (st != nullptr) {
+                os << (first ? "" : ", ") << "\"" << record_keys[i]
+                   << "\": {\"avg_us\": " << st->get_avg()
+                   << ", \"std_us\": " << st->get_std_dev()
+                   << ", \"p50_us\": " << st->get_percentile(0.5)
+                   << ", \"p99_us\": " << st->get_percentile(0.99)
+                   << ", \"p999_us\": " << st->get_percentile(0.999)
+                   << ", \"max_us\": " << st->get_max()
+                   << ", \"mbs\": " << st->get_thrpt() << "}";
+                first = false;
+            }
+        }
+        os << (csv ? "\n" : "}}\n");
+
+        // a single write so that records of threads do not interleave
+        std::cout << os.str() << std::flush;
     }
 
     void show_params()
@@ -250,10 +436,16 @@ struct Params_t {
         std::cout << "  " << std::setw(9) << threads_nb;
     }
 
-    void show_speed(double avg, double std_dev, double thrput)
+    void show_speed(double avg, double std_dev, double p99, double thrput)
     {
         std::cout << "  " << std::setw(8) << avg << "+/-" << std::setw(8)
-                  << std_dev << std::setw(20) << thrput;
+                  << std_dev << std::setw(12) << p99 << std::setw(20)
+                  << thrput;
+    }
+
+    void show_setup(double avg)
+    {
+        std::cout << "  " << std::setw(14) << avg;
     }
 
     void show_end()
@@ -283,6 +475,8 @@ class Benchmark {
     bool enc_only();
     bool dec_only();
     bool enc_dec();
+    bool prepare();
+    bool run_ops(uint64_t& bytes);
 
   private:
     int k;
@@ -314,8 +508,14 @@ class Benchmark {
     std::vector<ostreambuf<char>*>* c_ostreambufs = nullptr;
     std::vector<ostreambuf<char>*>* r_ostreambufs = nullptr;
 
+    // time spent in encode()/decode()
     Stats_t* enc_stats = nullptr;
     Stats_t* dec_stats = nullptr;
+    // time of whole operations, including stream I/O, pack and unpack
+    Stats_t* enc_e2e_stats = nullptr;
+    Stats_t* dec_e2e_stats = nullptr;
+    // time spent to build or fetch decoding contexts
+    Stats_t* dec_setup_stats = nullptr;
 
     // streams of data chunks
     std::vector<std::istream*>* d_streams = nullptr;
@@ -339,14 +539,14 @@ class Benchmark {
     void reset_c_streams();
     void reset_a_streams();
     void reset_r_streams();
+    void get_erased_chunks(std::vector<bool>& erased);
     void get_avail_chunks(
         std::vector<std::istream*>* avail_d_chunks,
         std::vector<std::istream*>* avail_c_chunks,
         std::vector<quadiron::Properties>& avail_c_props);
     bool encode();
     bool decode();
-    void show(Stats_t* stats);
-    void show(Stats_t* stats1, Stats_t* stats2);
+    void show(bool with_dec);
 };
 
 #endif
@@ -0,0 +1,539 @@
+/* -*- mode: c++ -*- */
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "quadiron.h"
+#include "simd/simd.h"
+
+namespace fft = quadiron::fft;
+namespace gf = quadiron::gf;
+namespace simd = quadiron::simd;
+namespace vec = quadiron::vec;
+
+/** A kernel to measure
+ *
+ * `bytes` is the amount of data processed by one call of `run`.
+ */
+struct Kernel {
+    std::string name;
+    size_t bytes;
+    std::function<void()> run;
+};
+
+struct Result {
+    std::string name;
+    size_t bytes;
+    uint64_t iterations;
+    double ns_per_op;
+    double cycles_per_byte;
+};
+
+struct MicroParams_t {
+    size_t pkt_size = 1024;
+    uint32_t samples_nb = 5;
+    // minimal duration of a sample, in nanoseconds
+    uint64_t min_sample_ns = 20000000;
+    std::string filter;
+    std::string output;
+    std::string baseline;
+    // relative slowdown (in percent) reported as a regression
+    double threshold = 10.0;
+};
+
+static const char* simd_backend()
+{
+#if defined(QUADIRON_USE_SIMD) && defined(__AVX2__)
+    return "avx2";
+#elif defined(QUADIRON_USE_SIMD) && defined(__SSE4_1__)
+    return "sse4.1";
+#else
+    return "none";
+#endif
+}
+
+/** Fill buffers with random elements of the field */
+template <typename T>
+static void fill_buffers(const gf::Field<T>& field, vec::Buffers<T>& bufs)
+{
+    for (int i = 0; i < bufs.get_n(); ++i) {
+        T* buf = bufs.get(i);
+        for (size_t j = 0; j < bufs.get_size(); ++j) {
+            buf[j] = field.rand();
+        }
+    }
+}
+
+/** Random element `a` of the field such as 1 < a < card - 1 */
+template <typename T>
+static T rand_coef(const gf::Field<T>& field)
+{
+    T a;
+    do {
+        a = field.rand();
+    } while (a <= 1 || a >= field.card() - 1);
+    return a;
+}
+
+template <typename T>
+static void add_ring_kernels(
+    std::vector<Kernel>& kernels,
+    const std::string& field_name,
+    std::shared_ptr<gf::Field<T>> field,
+    size_t pkt_size)
+{
+    auto bufs = std::make_shared<vec::Buffers<T>>(2, pkt_size);
+    fill_buffers(*field, *bufs);
+    const T coef = rand_coef(*field);
+    const size_t bytes = pkt_size * sizeof(T);
+
+    kernels.push_back({"ring/" + field_name + "/mul_coef_to_buf",
+                       bytes,
+                       [field, bufs, coef, pkt_size]() {
+                           field->mul_coef_to_buf(
+                               coef, bufs->get(0), bufs->get(1), pkt_size);
+                       }});
+    kernels.push_back({"ring/" + field_name + "/add_two_bufs",
+                       bytes,
+                       [field, bufs, pkt_size]() {
+                           field->add_two_bufs(
+                               bufs->get(0), bufs->get(1), pkt_size);
+                       }});
+}
+
+template <typename T>
+static void add_fft_kernels(
+    std::vector<Kernel>& kernels,
+    const std::string& field_name,
+    std::shared_ptr<gf::Field<T>> field,
+    size_t pkt_size)
+{
+    for (unsigned n = 16; n <= 1024 && n < field->card(); n *= 4) {
+        auto radix2 =
+            std::make_shared<fft::Radix2<T>>(*field, n, n, pkt_size);
+        auto input = std::make_shared<vec::Buffers<T>>(n, pkt_size);
+        auto output = std::make_shared<vec::Buffers<T>>(n, pkt_size);
+        fill_buffers(*field, *input);
+
+        kernels.push_back(
+            {"fft/" + field_name + "/radix2/n=" + std::to_string(n),
+             n * pkt_size * sizeof(T),
+             [radix2, input, output]() { radix2->fft(*output, *input); }});
+    }
+}
+
+#ifdef QUADIRON_USE_SIMD
+template <typename T>
+static void add_simd_kernels(
+    std::vector<Kernel>& kernels,
+    const std::string& field_name,
+    std::shared_ptr<gf::Field<T>> field,
+    size_t pkt_size)
+{
+    const unsigned n = 16;
+    const size_t vec_len = pkt_size / simd::countof<T>();
+    auto bufs = std::make_shared<vec::Buffers<T>>(n, pkt_size);
+    fill_buffers(*field, *bufs);
+    const T r1 = rand_coef(*field);
+    const T r2 = rand_coef(*field);
+    const T r3 = rand_coef(*field);
+    const T card = field->card();
+
+    for (unsigned m = 1; 4 * m <= n; m *= 2) {
+        kernels.push_back(
+            {"simd/" + field_name
+                 + "/butterfly_ct_two_layers_step/m=" + std::to_string(m),
+             n * pkt_size * sizeof(T),
+             [bufs, r1, r2, r3, m, vec_len, card]() {
+                 for (unsigned start = 0; start < m; ++start) {
+                     simd::butterfly_ct_two_layers_step(
+                         *bufs, r1, r2, r3, start, m, vec_len, card);
+                 }
+             }});
+    }
+}
+#endif // #ifdef QUADIRON_USE_SIMD
+
+static void add_pack_kernels(std::vector<Kernel>& kernels, size_t pkt_size)
+{
+    const int n = 8;
+
+    for (size_t word_size = 1; word_size <= 4; word_size *= 2) {
+        auto src = std::make_shared<vec::Buffers<uint8_t>>(
+            n, pkt_size * word_size);
+        auto dest = std::make_shared<vec::Buffers<uint32_t>>(n, pkt_size);
+        for (int i = 0; i < n; ++i) {
+            uint8_t* buf = src->get(i);
+            for (size_t j = 0; j < pkt_size * word_size; ++j) {
+                buf[j] = static_cast<uint8_t>(std::rand());
+            }
+        }
+
+        kernels.push_back(
+            {"vec/pack/w=" + std::to_string(word_size),
+             n * pkt_size * word_size,
+             [src, dest, pkt_size, word_size]() {
+                 vec::pack<uint8_t, uint32_t>(
+                     src->get_mem(), dest->get_mem(), n, pkt_size, word_size);
+             }});
+        kernels.push_back(
+            {"vec/unpack/w=" + std::to_string(word_size),
+             n * pkt_size * word_size,
+             [src, dest, pkt_size, word_size]() {
+                 vec::unpack<uint32_t, uint8_t>(
+                     dest->get_mem(), src->get_mem(), n, pkt_size, word_size);
+             }});
+    }
+}
+
+template <typename T>
+static void add_nf4_kernels(
+    std::vector<Kernel>& kernels,
+    const std::string& type_name,
+    size_t pkt_size)
+{
+    const int gf_n = sizeof(T) / 4;
+    std::shared_ptr<gf::NF4<T>> nf4(
+        static_cast<gf::NF4<T>*>(gf::alloc<gf::Field<T>, gf::NF4<T>>(gf_n)
+                                     .release()));
+    auto words = std::make_shared<std::vector<T>>(pkt_size);
+    auto packed = std::make_shared<std::vector<T>>(pkt_size);
+    for (size_t j = 0; j < pkt_size; ++j) {
+        (*words)[j] = nf4->unpacked_rand();
+        (*packed)[j] = nf4->pack((*words)[j]);
+    }
+    auto unpacked =
+        std::make_shared<std::vector<quadiron::GroupedValues<T>>>(pkt_size);
+
+    kernels.push_back({"nf4/" + type_name + "/pack",
+                       pkt_size * sizeof(T),
+                       [nf4, words, packed, pkt_size]() {
+                           for (size_t j = 0; j < pkt_size; ++j) {
+                               (*packed)[j] = nf4->pack((*words)[j]);
+                           }
+                       }});
+    kernels.push_back({"nf4/" + type_name + "/unpack",
+                       pkt_size * sizeof(T),
+                       [nf4, packed, unpacked, pkt_size]() {
+                           for (size_t j = 0; j < pkt_size; ++j) {
+                               nf4->unpack((*packed)[j], (*unpacked)[j]);
+                           }
+                       }});
+}
+
+template <typename T>
+static void add_matrix_kernels(
+    std::vector<Kernel>& kernels,
+    const std::string& field_name,
+    std::shared_ptr<gf::Field<T>> field)
+{
+    for (int n = 8; n <= 32 && static_cast<T>(2 * n) < field->card();
+         n *= 2) {
+        auto ref = std::make_shared<vec::Matrix<T>>(*field, n, n);
+        auto mat = std::make_shared<vec::Matrix<T>>(*field, n, n);
+        ref->cauchy();
+
+        kernels.push_back(
+            {"matrix/" + field_name + "/inv/n=" + std::to_string(n),
+             n * n * sizeof(T),
+             [ref, mat, n]() {
+                 for (int i = 0; i < n; ++i) {
+                     for (int j = 0; j < n; ++j) {
+                         mat->set(i, j, ref->get(i, j));
+                     }
+                 }
+                 mat->inv();
+             }});
+    }
+}
+
+static std::vector<Kernel> build_kernels(const MicroParams_t& params)
+{
+    const size_t pkt_size = params.pkt_size;
+    std::vector<Kernel> kernels;
+
+    std::shared_ptr<gf::Field<uint16_t>> gf257(
+        gf::alloc<gf::Field<uint16_t>, gf::Prime<uint16_t>>(257));
+    std::shared_ptr<gf::Field<uint32_t>> gf65537(
+        gf::alloc<gf::Field<uint32_t>, gf::Prime<uint32_t>>(65537));
+    std::shared_ptr<gf::Field<uint32_t>> gf2_8(
+        gf::alloc<gf::Field<uint32_t>, gf::BinExtension<uint32_t>>(8));
+    std::shared_ptr<gf::Field<uint32_t>> gf2_16(
+        gf::alloc<gf::Field<uint32_t>, gf::BinExtension<uint32_t>>(16));
+
+    add_ring_kernels<uint16_t>(kernels, "gf257", gf257, pkt_size);
+    add_ring_kernels<uint32_t>(kernels, "gf65537", gf65537, pkt_size);
+    add_ring_kernels<uint32_t>(kernels, "gf2^8", gf2_8, pkt_size);
+    add_ring_kernels<uint32_t>(kernels, "gf2^16", gf2_16, pkt_size);
+
+    add_fft_kernels<uint16_t>(kernels, "gf257", gf257, pkt_size);
+    add_fft_kernels<uint32_t>(kernels, "gf65537", gf65537, pkt_size);
+
+#ifdef QUADIRON_USE_SIMD
+    add_simd_kernels<uint16_t>(kernels, "gf257", gf257, pkt_size);
+    add_simd_kernels<uint32_t>(kernels, "gf65537", gf65537, pkt_size);
+#endif
+
+    add_pack_kernels(kernels, pkt_size);
+
+    add_nf4_kernels<uint64_t>(kernels, "uint64", pkt_size);
+    add_nf4_kernels<__uint128_t>(kernels, "uint128", pkt_size);
+
+    add_matrix_kernels<uint32_t>(kernels, "gf2^8", gf2_8);
+    add_matrix_kernels<uint32_t>(kernels, "gf65537", gf65537);
+
+    return kernels;
+}
+
+/** Run `iterations` calls of the kernel, return elapsed ns and cycles */
+static void time_kernel(
+    const Kernel& kernel,
+    uint64_t iterations,
+    uint64_t& ns,
+    uint64_t& cycles)
+{
+    const auto begin = std::chrono::steady_clock::now();
+    const uint64_t start = quadiron::hw_timer();
+    for (uint64_t i = 0; i < iterations; ++i) {
+        kernel.run();
+    }
+    cycles = quadiron::hw_timer() - start;
+    ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - begin)
+             .count();
+}
+
+/** Measure a kernel
+ *
+ * The number of iterations is doubled until a sample lasts at least
+ * `min_sample_ns`. The best of `samples_nb` samples is kept, as it is the
+ * least disturbed by the rest of the system.
+ */
+static Result measure(const Kernel& kernel, const MicroParams_t& params)
+{
+    uint64_t iterations = 1;
+    uint64_t ns = 0;
+    uint64_t cycles = 0;
+
+    time_kernel(kernel, iterations, ns, cycles);
+    while (ns < params.min_sample_ns) {
+        iterations *= 2;
+        time_kernel(kernel, iterations, ns, cycles);
+    }
+
+    double best_ns = static_cast<double>(ns);
+    double best_cycles = static_cast<double>(cycles);
+    for (uint32_t i = 1; i < params.samples_nb; ++i) {
+        time_kernel(kernel, iterations, ns, cycles);
+        best_ns = std::min(best_ns, static_cast<double>(ns));
+        best_cycles = std::min(best_cycles, static_cast<double>(cycles));
+    }
+
+    const double ops = static_cast<double>(iterations);
+    return {kernel.name,
+            kernel.bytes,
+            iterations,
+            best_ns / ops,
+            best_cycles / (ops * static_cast<double>(kernel.bytes))};
+}
+
+static void write_json(
+    std::ostream& os,
+    const MicroParams_t& params,
+    const std::vector<Result>& results)
+{
+    os << "{\n"
+       << "  \"version\": \"" << VERSION << "\",\n"
+       << "  \"simd\": \"" << simd_backend() << "\",\n"
+       << "  \"pkt_size\": " << params.pkt_size << ",\n"
+       << "  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& res = results[i];
+        os << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << res.name
+           << "\", \"bytes\": " << res.bytes
+           << ", \"iterations\": " << res.iterations
+           << ", \"ns_per_op\": " << res.ns_per_op
+           << ", \"cycles_per_byte\": " << res.cycles_per_byte << "}";
+    }
+    os << "\n  ]\n}\n";
+}
+
+/** Read `ns_per_op` of each kernel from a file written by `write_json` */
+static std::map<std::string, double> read_baseline(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "cannot open baseline file " << path << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    std::stringstream content;
+    content << file.rdbuf();
+    const std::string json = content.str();
+
+    const std::string name_key = "\"name\": \"";
+    const std::string ns_key = "\"ns_per_op\": ";
+    std::map<std::string, double> baseline;
+
+    size_t pos = json.find(name_key);
+    while (pos != std::string::npos) {
+        const size_t name_begin = pos + name_key.size();
+        const size_t name_end = json.find('"', name_begin);
+        const size_t ns_pos = json.find(ns_key, name_end);
+        if (name_end == std::string::npos || ns_pos == std::string::npos) {
+            break;
+        }
+        baseline[json.substr(name_begin, name_end - name_begin)] =
+            std::stod(json.substr(ns_pos + ns_key.size()));
+        pos = json.find(name_key, ns_pos);
+    }
+    return baseline;
+}
+
+/** Compare results to a baseline, return the number of regressions */
+static int compare_baseline(
+    const MicroParams_t& params,
+    const std::vector<Result>& results)
+{
+    const std::map<std::string, double> baseline =
+        read_baseline(params.baseline);
+    int regressions = 0;
+
+    for (auto const& res : results) {
+        auto it = baseline.find(res.name);
+        if (it == baseline.end()) {
+            continue;
+        }
+        const double delta = 100.0 * (res.ns_per_op / it->second - 1.0);
+        const bool regressed = delta > params.threshold;
+        std::cerr << (regressed ? "REGRESSION " : "           ") << res.name
+                  << ": " << it->second << " -> " << res.ns_per_op
+                  << " ns/op (" << (delta > 0 ? "+" : "") << delta << "%)\n";
+        if (regressed) {
+            regressions++;
+        }
+    }
+    return regressions;
+}
+
+[[noreturn]] static void xusage()
+{
+    std::cerr << "Usage: microbench [options]\n"
+              << "Options:\n"
+              << "\t-p \tPacket size (number of symbols per buffer)\n"
+              << "\t-n \tNumber of samples per kernel\n"
+              << "\t-d \tMinimal duration of a sample (ms)\n"
+              << "\t-f \tOnly run kernels whose name contains this string\n"
+              << "\t-l \tList kernels and exit\n"
+              << "\t-o \tWrite JSON results to this file (default: stdout)\n"
+              << "\t-b \tCompare results to this baseline JSON file\n"
+              << "\t-r \tSlowdown (%) reported as a regression (default: "
+              << "10)\n\n";
+    std::exit(EXIT_FAILURE);
+}
+
+int main(int argc, char** argv)
+{
+    MicroParams_t params;
+    bool list_only = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "p:n:d:f:lo:b:r:")) != -1) {
+        switch (opt) {
+        case 'p':
+            params.pkt_size = std::stoul(optarg);
+            break;
+        case 'n':
+            params.samples_nb = std::stoul(optarg);
+            break;
+        case 'd':
+            params.min_sample_ns = std::stoull(optarg) * 1000000;
+            break;
+        case 'f':
+            params.filter = optarg;
+            break;
+        case 'l':
+            list_only = true;
+            break;
+        case 'o':
+            params.output = optarg;
+            break;
+        case 'b':
+            params.baseline = optarg;
+            break;
+        case 'r':
+            params.threshold = std::stod(optarg);
+            break;
+        default:
+            xusage();
+        }
+    }
+    if (params.pkt_size == 0 || params.samples_nb == 0) {
+        xusage();
+    }
+
+    std::vector<Result> results;
+    for (auto const& kernel : build_kernels(params)) {
+        if (kernel.name.find(params.filter) == std::string::npos) {
+            continue;
+        }
+        if (list_only) {
+            std::cout << kernel.name << std::endl;
+            continue;
+        }
+        results.push_back(measure(kernel, params));
+    }
+    if (list_only) {
+        return 0;
+    }
+
+    if (params.output.empty()) {
+        write_json(std::cout, params, results);
+    } else {
+        std::ofstream file(params.output);
+        write_json(file, params, results);
+    }
+
+    if (!params.baseline.empty() && compare_baseline(params, results) > 0) {
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
@@ -31,10 +31,95 @@
 #ifndef __QUAD_BENCH_STATS_H__
 #define __QUAD_BENCH_STATS_H__
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
 #include <string>
-#include <cmath>
+#include <vector>
+
+/** Histogram of values with a bounded relative error.
+ *
+ * As in HDR histograms, each power of two is split into `2^SUB_BITS` linear
+ * sub-buckets, so that the relative error of a recorded value is lower than
+ * `2^-SUB_BITS` whatever its magnitude.
+ */
+class Histogram {
+  public:
+    static constexpr unsigned SUB_BITS = 5;
+    static constexpr uint64_t SUB_COUNT = 1 << SUB_BITS;
+
+    Histogram() : counts((64 - SUB_BITS + 1) * SUB_COUNT, 0) {}
+
+    void reset()
+    {
+        std::fill(counts.begin(), counts.end(), 0);
+        total = 0;
+        max = 0;
+    }
+
+    void add(uint64_t val)
+    {
+        counts[index(val)]++;
+        total++;
+        max = std::max(max, val);
+    }
+
+    uint64_t get_max() const
+    {
+        return max;
+    }
+
+    /** Value below which a ratio `q` (from 0 to 1) of recorded values are
+     *
+     * The upper bound of the bucket is returned, so that percentiles are
+     * never under-estimated.
+     */
+    uint64_t get_percentile(double q) const
+    {
+        if (total == 0) {
+            return 0;
+        }
+        const double rank_q = std::ceil(q * static_cast<double>(total));
+        const uint64_t rank =
+            std::max<uint64_t>(1, static_cast<uint64_t>(rank_q));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return std::min(max, upper_bound(i));
+            }
+        }
+        return max;
+    }
 
+  private:
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t max = 0;
+
+    static size_t index(uint64_t val)
+    {
+        if (val < SUB_COUNT) {
+            return val;
+        }
+        const unsigned msb = 63 - __builtin_clzll(val);
+        const unsigned shift = msb - SUB_BITS;
+        return ((shift + 1) << SUB_BITS) + (val >> shift) - SUB_COUNT;
+    }
+
+    static uint64_t upper_bound(size_t idx)
+    {
+        if (idx < 2 * SUB_COUNT) {
+            return idx;
+        }
+        const unsigned shift = (idx >> SUB_BITS) - 1;
+        const uint64_t sub = (idx & (SUB_COUNT - 1)) + SUB_COUNT;
+        return ((sub + 1) << shift) - 1;
+    }
+};
+
+/** Statistics of latencies, recorded in nanoseconds and shown in us */
 class Stats_t {
   public:
     Stats_t(const std::string& str, size_t work_load)
@@ -52,29 +137,46 @@ class Stats_t {
         nb = 0;
         sum = 0;
         sum_2 = 0;
+        histogram.reset();
     }
 
-    void add(uint64_t val)
+    void add(uint64_t val_ns)
     {
+        const double val = static_cast<double>(val_ns);
         nb++;
         sum += val;
-        sum_2 += (val * val);
+        sum_2 += val * val;
+        histogram.add(val_ns);
     }
 
     void end()
     {
-        avg = static_cast<double>(sum) / static_cast<double>(nb);
-        std_dev = sqrt(
-            static_cast<double>(sum_2) / static_cast<double>(nb) - avg * avg);
+        if (nb == 0) {
+            avg = 0;
+            std_dev = 0;
+            return;
+        }
+        const double avg_ns = sum / static_cast<double>(nb);
+        const double var_ns = sum_2 / static_cast<double>(nb) - avg_ns * avg_ns;
+        avg = avg_ns / 1000;
+        std_dev = std::sqrt(std::max(var_ns, 0.0)) / 1000;
     }
 
     void show()
     {
         std::cout << name << ":\tLatency(us) " << avg << " +/- " << std_dev;
-        std::cout << "\t\tThroughput " << work_load / avg << " (MB/s)"
+        std::cout << "\tp50 " << get_percentile(0.5) << " p99 "
+                  << get_percentile(0.99) << " p99.9 "
+                  << get_percentile(0.999) << " max " << get_max();
+        std::cout << "\t\tThroughput " << get_thrpt() << " (MB/s)"
                   << std::endl;
     }
 
+    const std::string& get_name()
+    {
+        return name;
+    }
+
     double get_avg()
     {
         return avg;
@@ -85,19 +187,32 @@ class Stats_t {
         return std_dev;
     }
 
+    /** Percentile of latencies (us) */
+    double get_percentile(double q)
+    {
+        return static_cast<double>(histogram.get_percentile(q)) / 1000;
+    }
+
+    /** Maximal latency (us) */
+    double get_max()
+    {
+        return static_cast<double>(histogram.get_max()) / 1000;
+    }
+
     double get_thrpt()
     {
-        return work_load / avg;
+        return avg > 0 ? work_load / avg : 0;
     }
 
   private:
     uint64_t nb;
-    uint64_t sum;
-    uint64_t sum_2;
-    double avg;
-    double std_dev;
+    double sum;
+    double sum_2;
+    double avg = 0;
+    double std_dev = 0;
     size_t work_load;
     std::string name;
+    Histogram histogram;
 };
 
 #endif
@@ -186,3 +186,16 @@ do
     do_test all ${fec_type} ${word_size} 9 5 "1 3 5 7 8" ""
     do_test all ${fec_type} ${word_size} 9 5 "" "0 1 2 3 4"
 done
+
+# asynchronous and memory-mapped fragment I/O
+for i in rs-fnt-sys_2 rs-nf4_4 rs-gf2n-v_2
+do
+    fec_type=$(echo $i|cut -d_ -f1)
+    word_size=$(echo $i|cut -d_ -f2)
+
+    for backend in uring mmap
+    do
+        do_test all ${fec_type} ${word_size} 3 3 "0 1" "0" "-b ${backend}"
+        do_test all ${fec_type} ${word_size} 9 5 "2 3 4" "2 3" "-b ${backend}"
+    done
+done
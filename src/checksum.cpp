@@ -0,0 +1,121 @@
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#include "checksum.h"
+
+namespace quadiron {
+
+namespace {
+
+// CRC-32C (iSCSI) polynomial in reversed bit order
+constexpr uint32_t POLY = 0x82F63B78;
+
+std::array<uint32_t, 256> make_table()
+{
+    std::array<uint32_t, 256> table;
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int j = 0; j < 8; ++j) {
+            crc = (crc & 1) ? (crc >> 1) ^ POLY : crc >> 1;
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+uint32_t crc32c_sw(uint32_t crc, const uint8_t* buf, size_t len)
+{
+    static const std::array<uint32_t, 256> table = make_table();
+
+    for (size_t i = 0; i < len; ++i) {
+        crc = table[(crc ^ buf[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+
+__attribute__((target("sse4.2"))) uint32_t
+crc32c_hw(uint32_t crc, const uint8_t* buf, size_t len)
+{
+    uint64_t crc64 = crc;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, buf + i, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = static_cast<uint32_t>(crc64);
+    for (; i < len; ++i) {
+        crc = _mm_crc32_u8(crc, buf[i]);
+    }
+    return crc;
+}
+
+bool has_hw_crc32c()
+{
+    static const bool has_sse42 = __builtin_cpu_supports("sse4.2");
+    return has_sse42;
+}
+
+#else
+
+uint32_t crc32c_hw(uint32_t crc, const uint8_t* buf, size_t len)
+{
+    return crc32c_sw(crc, buf, len);
+}
+
+bool has_hw_crc32c()
+{
+    return false;
+}
+
+#endif
+
+} // namespace
+
+uint32_t crc32c(uint32_t crc, const uint8_t* buf, size_t len)
+{
+    crc = ~crc;
+    if (has_hw_crc32c()) {
+        crc = crc32c_hw(crc, buf, len);
+    } else {
+        crc = crc32c_sw(crc, buf, len);
+    }
+    return ~crc;
+}
+
+} // namespace quadiron
@@ -33,14 +33,20 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstdint>
+#include <cstring>
+#include <limits>
 #include <memory>
+#include <utility>
 #include <vector>
-#include <sys/time.h>
 
+#include "checksum.h"
 #include "fec_context.h"
+#include "fec_stats.h"
 #include "fft_base.h"
 #include "gf_base.h"
+#include "membuf.h"
 #include "misc.h"
 #include "property.h"
 #include "vec_buffers.h"
@@ -60,19 +66,8 @@ namespace quadiron {
 /** Forward Error Correction code implementations. */
 namespace fec {
 
-static inline timeval tick()
-{
-    struct timeval tv;
-    gettimeofday(&tv, nullptr);
-    return tv;
-}
-
-static inline uint64_t hrtime_usec(timeval begin)
-{
-    struct timeval tv;
-    gettimeofday(&tv, nullptr);
-    return 1000000 * (tv.tv_sec - begin.tv_sec) + tv.tv_usec - begin.tv_usec;
-}
+template <typename T>
+class DecodeSession;
 
 enum class FecType {
     /** Systematic code
@@ -105,13 +100,13 @@ class FecCode {
     // FIXME: move n to protected
     T n;
 
-    uint64_t total_encode_cycles = 0;
-    uint64_t n_encode_ops = 0;
-    uint64_t total_decode_cycles = 0;
-    uint64_t n_decode_ops = 0;
-
-    uint64_t total_enc_usec = 0;
-    uint64_t total_dec_usec = 0;
+    /** Per-phase statistics of the last encoding or decoding operation.
+     *
+     * They are also accumulated to the statistics of the calling thread (see
+     * `get_thread_stats`). Statistics are collected only if the library is
+     * built with `QUADIRON_USE_STATS` and if they are enabled at runtime.
+     */
+    Stats stats;
 
     FecCode(
         FecType type,
@@ -142,6 +137,13 @@ class FecCode {
         vec::Buffers<T>&){};
     virtual void
     encode_post_process(vec::Buffers<T>&, std::vector<Properties>&, off_t){};
+    virtual void encode_delta(vec::Buffers<T>&, unsigned, T*);
+    virtual bool verify(
+        const std::vector<Properties>& props,
+        off_t offset,
+        vec::Buffers<T>& words,
+        vec::Buffers<T>& tmp,
+        vec::Buffers<T>& syndrome);
     virtual void decode_add_data(int /* fragment_index */, int /* row */){};
     virtual void decode_add_parities(int /* fragment_index */, int /* row */){};
     virtual void decode_build(void){};
@@ -175,6 +177,12 @@ class FecCode {
 
     bool read_pkt(char* pkt, std::istream& stream);
     bool write_pkt(char* pkt, std::ostream& stream);
+    bool read_pkt(
+        uint8_t** pkt,
+        uint8_t* buf,
+        std::istream& stream,
+        MemoryStreambuf* mem);
+    uint8_t* get_out_pkt(uint8_t* buf, MemoryStreambuf* mem);
 
     void encode_bufs(
         std::vector<std::istream*> input_data_bufs,
@@ -184,7 +192,29 @@ class FecCode {
     void encode_packet(
         std::vector<std::istream*> input_data_bufs,
         std::vector<std::ostream*> output_parities_bufs,
-        std::vector<Properties>& output_parities_props);
+        std::vector<Properties>& output_parities_props,
+        std::vector<uint32_t>* input_data_checksums = nullptr,
+        std::vector<uint32_t>* output_parities_checksums = nullptr);
+
+    void encode_packet_batch(
+        const std::vector<std::vector<std::istream*>>& input_data_bufs,
+        const std::vector<std::vector<std::ostream*>>& output_parities_bufs,
+        std::vector<std::vector<Properties>>& output_parities_props);
+
+    void update_packet(
+        unsigned frag_index,
+        off_t offset,
+        std::istream* old_data_buf,
+        std::istream* new_data_buf,
+        std::vector<std::istream*> input_parities_bufs,
+        std::vector<std::ostream*> output_parities_bufs,
+        std::vector<Properties>& parities_props);
+
+    bool verify_packet(
+        std::vector<std::istream*> input_data_bufs,
+        std::vector<std::istream*> input_parities_bufs,
+        const std::vector<Properties>& input_parities_props,
+        std::vector<off_t>& bad_offsets);
 
     bool decode_bufs(
         std::vector<std::istream*> input_data_bufs,
@@ -201,28 +231,173 @@ class FecCode {
         std::vector<std::istream*> input_data_bufs,
         std::vector<std::istream*> input_parities_bufs,
         const std::vector<Properties>& input_parities_props,
-        std::vector<std::ostream*> output_data_bufs);
+        std::vector<std::ostream*> output_data_bufs,
+        const std::vector<uint32_t>* input_data_checksums = nullptr,
+        const std::vector<uint32_t>* input_parities_checksums = nullptr);
+
+    bool decode_packet_batch(
+        const std::vector<std::vector<std::istream*>>& input_data_bufs,
+        const std::vector<std::vector<std::istream*>>& input_parities_bufs,
+        const std::vector<std::vector<Properties>>& input_parities_props,
+        const std::vector<std::vector<std::ostream*>>& output_data_bufs);
+
+    bool decode_range(
+        std::vector<std::istream*> input_data_bufs,
+        std::vector<std::istream*> input_parities_bufs,
+        const std::vector<Properties>& input_parities_props,
+        std::vector<std::ostream*> output_data_bufs,
+        size_t offset,
+        size_t length);
 
     const gf::Field<T>& get_gf()
     {
         return *gf;
     }
 
-    void reset_stats_enc()
+    void set_stats_enabled(bool enabled)
     {
-        total_encode_cycles = 0;
-        n_encode_ops = 0;
-        total_enc_usec = 0;
+        stats_enabled = enabled;
     }
 
-    void reset_stats_dec()
+    bool get_stats_enabled() const
     {
-        total_decode_cycles = 0;
-        n_decode_ops = 0;
-        total_dec_usec = 0;
+        return stats_enabled;
+    }
+
+    /** Embed properties of outputs in their streams
+     *
+     * When enabled, encode_packet() follows each output packet by its marks
+     * (see write_props()) and decode_packet() reads them back, so that the
+     * properties given to the latter are unused. Outputs are then
+     * self-describing but no longer made of fixed-size packets: other packet
+     * operations are not supported.
+     *
+     * @param enabled - whether properties are inline
+     */
+    void set_inline_props(bool enabled)
+    {
+        inline_props = enabled;
+    }
+
+    bool get_inline_props() const
+    {
+        return inline_props;
+    }
+
+    /** Set the allocation policy of the buffers of the codec
+     *
+     * It applies to the packet buffers of every subsequent operation and the
+     * buffers kept by the codec are re-allocated with the new policy.
+     *
+     * @param policy - huge pages and NUMA placement of the buffers
+     */
+    void set_alloc_policy(const simd::AllocPolicy& policy)
+    {
+        if (policy == alloc_policy) {
+            return;
+        }
+        alloc_policy = policy;
+        realloc_buffers();
+    }
+
+    const simd::AllocPolicy& get_alloc_policy() const
+    {
+        return alloc_policy;
     }
 
   protected:
+    simd::AllocPolicy alloc_policy;
+
+    /** Drop the cached decoding context, it is re-built on next use */
+    void reset_context_dec()
+    {
+        dec_context = nullptr;
+    }
+
+    /** Re-allocate the buffers kept by the codec after a policy change */
+    virtual void realloc_buffers()
+    {
+        // the decoding context is lazily rebuilt with the new policy
+        dec_context = nullptr;
+        dec_output = nullptr;
+        dec_fragments_ids = nullptr;
+    }
+
+    bool stats_enabled = true;
+    bool inline_props = false;
+
+    /** Throw if properties are inline, see set_inline_props() */
+    void check_no_inline_props() const
+    {
+        if (inline_props) {
+            throw LogicError("FEC base: inline properties are not supported");
+        }
+    }
+
+    void
+    write_props(std::ostream& stream, const Properties& props, off_t offset);
+    bool read_props(std::istream& stream, Properties& props, off_t offset);
+
+    // hardware timer and clock at the beginning of the current operation
+    uint64_t op_start_cycles = 0;
+    std::chrono::steady_clock::time_point op_start_time;
+
+#ifdef QUADIRON_USE_STATS
+    /** Reset statistics at the beginning of an operation */
+    inline void stats_begin_op()
+    {
+        stats.reset();
+        if (stats_enabled) {
+            op_start_time = std::chrono::steady_clock::now();
+            op_start_cycles = hw_timer();
+        }
+    }
+
+    /** Account the operation to statistics of the calling thread */
+    inline void stats_end_op()
+    {
+        if (stats_enabled) {
+            const uint64_t cycles = hw_timer() - op_start_cycles;
+            const auto elapsed =
+                std::chrono::steady_clock::now() - op_start_time;
+            stats.add_op(
+                cycles,
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                    .count());
+            add_thread_stats(stats);
+        }
+    }
+
+    /** Current value of the hardware timer, if statistics are enabled */
+    inline uint64_t stats_timer() const
+    {
+        return stats_enabled ? hw_timer() : 0;
+    }
+
+    /** Account cycles elapsed since `timer` to a phase and restart `timer`
+     *
+     * @param phase phase to which cycles are accounted
+     * @param timer value of `stats_timer()` at the beginning of the phase
+     * @param bytes number of bytes processed during the phase
+     */
+    inline void stats_lap(Phase phase, uint64_t& timer, uint64_t bytes)
+    {
+        if (stats_enabled) {
+            const uint64_t now = hw_timer();
+            stats.add(phase, now - timer, bytes);
+            timer = now;
+        }
+    }
+#else
+    inline void stats_begin_op() {}
+    inline void stats_end_op() {}
+    inline uint64_t stats_timer() const
+    {
+        return 0;
+    }
+    inline void stats_lap(Phase, uint64_t&, uint64_t) {}
+#endif // #ifdef QUADIRON_USE_STATS
+
     // primitive nth root of unity
     T r;
     std::unique_ptr<gf::Field<T>> gf = nullptr;
@@ -234,6 +409,12 @@ class FecCode {
     std::unique_ptr<vec::Vector<T>> r_powers = nullptr;
     // buffers for intermediate symbols used for systematic FNT
     std::unique_ptr<vec::Buffers<T>> dec_inter_codeword;
+    // coefficients of syndromes, computed on the first verification
+    std::vector<std::unique_ptr<vec::Vector<T>>> syndrome_coefs;
+    // decoding context of packets, cached for the last received fragments
+    std::unique_ptr<vec::Vector<T>> dec_fragments_ids = nullptr;
+    std::unique_ptr<vec::Buffers<T>> dec_output = nullptr;
+    std::unique_ptr<DecodeContext<T>> dec_context = nullptr;
 
     // pure abstract methods that will be defined in derived class
     virtual void check_params() = 0;
@@ -254,6 +435,74 @@ class FecCode {
         init_others();
     }
 
+    const DecodeContext<T>& get_context_dec(vec::Vector<T>& fragments_ids);
+
+    // sessions select fragments before their data is received
+    friend class DecodeSession<T>;
+
+    bool select_fragments(
+        const std::vector<bool>& avail_data,
+        const std::vector<bool>& avail_parities,
+        vec::Vector<T>& fragments_ids,
+        std::vector<unsigned>& avail_parity_ids,
+        unsigned& avail_data_nb);
+
+    bool select_fragments(
+        const std::vector<std::istream*>& input_data_bufs,
+        const std::vector<std::istream*>& input_parities_bufs,
+        vec::Vector<T>& fragments_ids,
+        std::vector<unsigned>& avail_parity_ids,
+        unsigned& avail_data_nb)
+    {
+        std::vector<bool> avail_data(input_data_bufs.size());
+        std::vector<bool> avail_parities(input_parities_bufs.size());
+        for (size_t i = 0; i < input_data_bufs.size(); i++) {
+            avail_data[i] = input_data_bufs[i] != nullptr;
+        }
+        for (size_t i = 0; i < input_parities_bufs.size(); i++) {
+            avail_parities[i] = input_parities_bufs[i] != nullptr;
+        }
+        return select_fragments(
+            avail_data,
+            avail_parities,
+            fragments_ids,
+            avail_parity_ids,
+            avail_data_nb);
+    }
+
+    /** Columns of a shared packet held by an object of a batch */
+    struct BatchSegment {
+        size_t object;
+        // first column and number of columns, in words
+        size_t begin;
+        size_t len;
+        // location of the first column in the object
+        off_t offset;
+    };
+
+    size_t read_batch_pkt(
+        const std::vector<std::vector<std::istream*>>& bufs,
+        const std::vector<uint8_t*>& pkts,
+        size_t& object,
+        off_t& obj_offset,
+        std::vector<BatchSegment>& segments);
+
+    void init_syndrome_coefs();
+
+    bool decode_packet_window(
+        std::vector<std::istream*> input_data_bufs,
+        std::vector<std::istream*> input_parities_bufs,
+        const std::vector<Properties>& input_parities_props,
+        std::vector<std::ostream*> output_data_bufs,
+        off_t offset,
+        size_t skip,
+        size_t length,
+        const std::vector<uint32_t>* input_data_checksums = nullptr,
+        const std::vector<uint32_t>* input_parities_checksums = nullptr);
+    bool verify_data_checksums(
+        const std::vector<std::istream*>& input_data_bufs,
+        const std::vector<uint32_t>& input_data_checksums);
+
     virtual void decode_prepare(
         const DecodeContext<T>& context,
         const std::vector<Properties>& props,
@@ -379,6 +628,146 @@ inline bool FecCode<T>::write_pkt(char* pkt, std::ostream& stream)
     return static_cast<bool>(stream.write(pkt, buf_size));
 }
 
+/** Write the marks of a packet after it, see set_inline_props()
+ *
+ * The number of marks is followed, for each mark by increasing location, by
+ * its distance to the previous mark (to the beginning of the packet for the
+ * first one) and its value. All of them are LEB128 varints, so that a packet
+ * without marks takes a single byte.
+ *
+ * @param stream output stream of the packet
+ * @param props marks of the packet
+ * @param offset location (in words) of the packet
+ */
+template <typename T>
+void FecCode<T>::write_props(
+    std::ostream& stream,
+    const Properties& props,
+    off_t offset)
+{
+    std::vector<std::pair<off_t, uint32_t>> marks;
+    for (auto const& data : props.get_map()) {
+        if (data.first >= offset && data.first < offset + off_t(pkt_size)) {
+            marks.emplace_back(data.first - offset, data.second);
+        }
+    }
+    std::sort(marks.begin(), marks.end());
+
+    std::vector<char> bytes;
+    const auto put = [&bytes](uint64_t val) {
+        for (; val >= 0x80; val >>= 7) {
+            bytes.push_back(static_cast<char>((val & 0x7f) | 0x80));
+        }
+        bytes.push_back(static_cast<char>(val));
+    };
+    put(marks.size());
+    off_t prev = 0;
+    for (auto const& mark : marks) {
+        put(mark.first - prev);
+        put(mark.second);
+        prev = mark.first;
+    }
+    stream.write(bytes.data(), bytes.size());
+}
+
+/** Read the marks following a packet, see write_props()
+ *
+ * @param stream input stream of the packet
+ * @param props receives the marks
+ * @param offset location (in words) of the packet
+ *
+ * @return false if the marks are truncated or malformed
+ */
+template <typename T>
+bool FecCode<T>::read_props(
+    std::istream& stream,
+    Properties& props,
+    off_t offset)
+{
+    const auto get = [&stream](uint64_t& val) {
+        val = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            const int byte = stream.get();
+            if (byte == std::char_traits<char>::eof()) {
+                return false;
+            }
+            val |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    uint64_t n_marks;
+    if (!get(n_marks) || n_marks > pkt_size) {
+        return false;
+    }
+    uint64_t loc = 0;
+    for (uint64_t i = 0; i < n_marks; i++) {
+        uint64_t delta;
+        uint64_t value;
+        if (!get(delta) || !get(value)) {
+            return false;
+        }
+        loc += delta;
+        if (loc >= pkt_size || value > std::numeric_limits<uint32_t>::max()) {
+            return false;
+        }
+        props.add(offset + loc, static_cast<uint32_t>(value));
+    }
+    return true;
+}
+
+/** Read a packet, in place if the stream is backed by memory
+ *
+ * @param pkt set to the packet, either in the memory of the stream or `buf`
+ * @param buf buffer of `buf_size` bytes receiving the packet otherwise
+ * @param stream stream from which the packet is read
+ * @param mem memory buffer of `stream`, nullptr if it is not backed by memory
+ */
+template <typename T>
+inline bool FecCode<T>::read_pkt(
+    uint8_t** pkt,
+    uint8_t* buf,
+    std::istream& stream,
+    MemoryStreambuf* mem)
+{
+    // e.g. a failed seek
+    if (!stream) {
+        return false;
+    }
+    if (mem != nullptr) {
+        char* bytes = mem->get_bytes(buf_size);
+        if (bytes != nullptr) {
+            *pkt = reinterpret_cast<uint8_t*>(bytes);
+            return true;
+        }
+    }
+    *pkt = buf;
+    return read_pkt(reinterpret_cast<char*>(buf), stream);
+}
+
+/** Get where an output packet is unpacked
+ *
+ * @param buf buffer of `buf_size` bytes
+ * @param mem memory buffer of the output stream, nullptr if it is not backed
+ * by memory
+ * @return the packet in the memory of the stream, already written, or `buf`
+ * that remains to be written with `write_pkt`
+ */
+template <typename T>
+inline uint8_t* FecCode<T>::get_out_pkt(uint8_t* buf, MemoryStreambuf* mem)
+{
+    if (mem != nullptr) {
+        char* bytes = mem->put_bytes(buf_size);
+        if (bytes != nullptr) {
+            return reinterpret_cast<uint8_t*>(bytes);
+        }
+    }
+    return buf;
+}
+
 /**
  * Encode buffers
  *
@@ -396,6 +785,7 @@ void FecCode<T>::encode_bufs(
     std::vector<std::ostream*> output_parities_bufs,
     std::vector<Properties>& output_parities_props)
 {
+    check_no_inline_props();
     bool cont = true;
     off_t offset = 0;
 
@@ -411,7 +801,8 @@ void FecCode<T>::encode_bufs(
         props.clear();
     }
 
-    reset_stats_enc();
+    stats_begin_op();
+    uint64_t timer = stats_timer();
 
     while (true) {
         words.zero_fill();
@@ -425,71 +816,654 @@ void FecCode<T>::encode_bufs(
         }
         if (!cont)
             break;
+        stats_lap(Phase::READ, timer, n_data * word_size);
 
         // std::cout << "words at " << offset << ": "; words.dump();
 
-        timeval t1 = tick();
-        uint64_t start = hw_timer();
         encode(output, output_parities_props, offset, words);
-        uint64_t end = hw_timer();
-        uint64_t t2 = hrtime_usec(t1);
+        stats_lap(Phase::ENCODE, timer, n_data * word_size);
 
         // std::cout << "output: "; output.dump();
 
-        total_enc_usec += t2;
-        total_encode_cycles += (end - start) / word_size;
-        n_encode_ops++;
-
         for (unsigned i = 0; i < n_outputs; i++) {
             T tmp = output.get(i);
             writew(tmp, output_parities_bufs[i]);
         }
+        stats_lap(Phase::WRITE, timer, n_outputs * word_size);
         offset++;
     }
+    stats_end_op();
 }
 
+/**
+ * Encode buffers by packets
+ *
+ * @param input_data_bufs must be exactly n_data
+ * @param output_parities_bufs must be exactly n_outputs
+ * @param output_parities_props must be exactly n_outputs specific
+ * properties that the called is supposed to store along with parities
+ * @param input_data_checksums if not nullptr, receives the CRC-32C of each
+ * data fragment
+ * @param output_parities_checksums if not nullptr, receives the CRC-32C of
+ * each output
+ *
+ * @note all streams must be of equal size
+ */
 template <typename T>
 void FecCode<T>::encode_packet(
     std::vector<std::istream*> input_data_bufs,
     std::vector<std::ostream*> output_parities_bufs,
-    std::vector<Properties>& output_parities_props)
+    std::vector<Properties>& output_parities_props,
+    std::vector<uint32_t>* input_data_checksums,
+    std::vector<uint32_t>* output_parities_checksums)
 {
     assert(input_data_bufs.size() == n_data);
     assert(output_parities_bufs.size() == n_outputs);
     assert(output_parities_props.size() == n_outputs);
 
-    // clear property vectors
-    for (auto& props : output_parities_props) {
-        props.clear();
+    // clear property vectors
+    for (auto& props : output_parities_props) {
+        props.clear();
+    }
+    if (input_data_checksums != nullptr) {
+        input_data_checksums->assign(n_data, 0);
+    }
+    if (output_parities_checksums != nullptr) {
+        output_parities_checksums->assign(n_outputs, 0);
+    }
+
+    bool cont = true;
+    off_t offset = 0;
+
+    // vector of buffers storing data read from chunk
+    vec::Buffers<uint8_t> words_char(n_data, buf_size, alloc_policy);
+    const std::vector<uint8_t*> words_mem_char = words_char.get_mem();
+    // vector of buffers storing data that are performed in encoding, i.e. FFT
+    vec::Buffers<T> words(n_data, pkt_size, alloc_policy);
+    const std::vector<T*> words_mem_T = words.get_mem();
+
+    int output_len = get_n_outputs();
+
+    // vector of buffers storing data that are performed in encoding, i.e. FFT
+    vec::Buffers<T> output(output_len, pkt_size, alloc_policy);
+    const std::vector<T*> output_mem_T = output.get_mem();
+    // vector of buffers storing data in output chunk
+    vec::Buffers<uint8_t> output_char(output_len, buf_size, alloc_policy);
+    const std::vector<uint8_t*> output_mem_char = output_char.get_mem();
+
+    // packets of streams backed by memory are accessed in place
+    const std::vector<MemoryStreambuf*> input_mems =
+        get_memory_bufs(input_data_bufs);
+    const std::vector<MemoryStreambuf*> output_mems =
+        get_memory_bufs(output_parities_bufs);
+    std::vector<uint8_t*> input_pkts(words_mem_char);
+    std::vector<uint8_t*> output_pkts(output_mem_char);
+
+    // marks of the current packet when they are written inline
+    std::vector<Properties> pkt_props(n_outputs);
+    std::vector<Properties>& enc_props =
+        inline_props ? pkt_props : output_parities_props;
+
+    stats_begin_op();
+    uint64_t timer = stats_timer();
+
+    while (true) {
+        // TODO: get number of read bytes -> true buf size
+        for (unsigned i = 0; i < n_data; i++) {
+            if (!read_pkt(
+                    &input_pkts[i],
+                    words_mem_char[i],
+                    *(input_data_bufs[i]),
+                    input_mems[i])) {
+                cont = false;
+                break;
+            }
+        }
+        if (!cont)
+            break;
+        stats_lap(Phase::READ, timer, n_data * buf_size);
+
+        if (input_data_checksums != nullptr) {
+            for (unsigned i = 0; i < n_data; i++) {
+                (*input_data_checksums)[i] = crc32c(
+                    (*input_data_checksums)[i], input_pkts[i], buf_size);
+            }
+            stats_lap(Phase::CHECKSUM, timer, n_data * buf_size);
+        }
+
+        vec::pack<uint8_t, T>(
+            input_pkts, words_mem_T, n_data, pkt_size, word_size);
+        stats_lap(Phase::PACK, timer, n_data * buf_size);
+
+        encode(output, enc_props, offset, words);
+        stats_lap(Phase::ENCODE, timer, n_data * buf_size);
+
+        for (unsigned i = 0; i < n_outputs; i++) {
+            output_pkts[i] = get_out_pkt(output_mem_char[i], output_mems[i]);
+        }
+        vec::unpack<T, uint8_t>(
+            output_mem_T, output_pkts, output_len, pkt_size, word_size);
+        stats_lap(Phase::UNPACK, timer, output_len * buf_size);
+
+        if (output_parities_checksums != nullptr) {
+            for (unsigned i = 0; i < n_outputs; i++) {
+                (*output_parities_checksums)[i] = crc32c(
+                    (*output_parities_checksums)[i],
+                    output_pkts[i],
+                    buf_size);
+            }
+            stats_lap(Phase::CHECKSUM, timer, n_outputs * buf_size);
+        }
+
+        for (unsigned i = 0; i < n_outputs; i++) {
+            if (output_pkts[i] == output_mem_char[i]) {
+                write_pkt(
+                    reinterpret_cast<char*>(output_mem_char[i]),
+                    *(output_parities_bufs[i]));
+            }
+        }
+        if (inline_props) {
+            for (unsigned i = 0; i < n_outputs; i++) {
+                write_props(*(output_parities_bufs[i]), pkt_props[i], offset);
+                for (auto const& data : pkt_props[i].get_map()) {
+                    output_parities_props[i].add(data.first, data.second);
+                }
+                pkt_props[i].clear();
+            }
+        }
+        stats_lap(Phase::WRITE, timer, n_outputs * buf_size);
+        offset += pkt_size;
+    }
+    stats_end_op();
+}
+
+/**
+ * Fill a packet with the next columns of the objects of a batch
+ *
+ * Objects are laid out one after the other in the columns of the packet,
+ * unused columns at the end of the batch are zero-filled.
+ *
+ * @param bufs streams of each object, in the order of `pkts`
+ * @param pkts buffers of `buf_size` bytes receiving the packet
+ * @param object current object, updated
+ * @param obj_offset location (in words) of the next column of the current
+ * object, updated
+ * @param segments receives the columns held by each object
+ *
+ * @return number of bytes filled in each buffer, 0 once all objects are read
+ */
+template <typename T>
+size_t FecCode<T>::read_batch_pkt(
+    const std::vector<std::vector<std::istream*>>& bufs,
+    const std::vector<uint8_t*>& pkts,
+    size_t& object,
+    off_t& obj_offset,
+    std::vector<BatchSegment>& segments)
+{
+    size_t filled = 0;
+
+    segments.clear();
+    while (filled < buf_size && object < bufs.size()) {
+        const std::vector<std::istream*>& inputs = bufs[object];
+        size_t len = 0;
+        for (size_t i = 0; i < pkts.size(); i++) {
+            inputs[i]->read(
+                reinterpret_cast<char*>(pkts[i] + filled), buf_size - filled);
+            const size_t got = inputs[i]->gcount();
+            if (i == 0) {
+                len = got;
+            } else if (got != len) {
+                throw InvalidArgument(
+                    "FEC base: fragments of an object differ in size");
+            }
+        }
+        if (len % word_size != 0) {
+            throw InvalidArgument(
+                "FEC base: fragment size is not a multiple of words");
+        }
+        if (len == 0) {
+            object++;
+            obj_offset = 0;
+            continue;
+        }
+        const size_t n_words = len / word_size;
+        segments.push_back({object, filled / word_size, n_words, obj_offset});
+        filled += len;
+        obj_offset += n_words;
+    }
+    if (filled > 0 && filled < buf_size) {
+        for (uint8_t* pkt : pkts) {
+            std::memset(pkt + filled, 0, buf_size - filled);
+        }
+    }
+    return filled;
+}
+
+/**
+ * Encode a batch of independent objects by packets
+ *
+ * Symbols at a same position of the fragments form independent codewords,
+ * so the objects are laid out one after the other in the columns of shared
+ * packets: a packet may hold several small objects and an object may span
+ * several packets. Each packet is encoded once for all the objects it holds,
+ * and buffers are set up once for the whole batch.
+ *
+ * Outputs and properties of an object are the same as if it was encoded
+ * alone, by a code of same parameters whose packets divide its fragments.
+ *
+ * @param input_data_bufs n_data streams for each object, fragments of an
+ * object must be of equal size, a multiple of the word size
+ * @param output_parities_bufs n_outputs streams for each object
+ * @param output_parities_props n_outputs properties for each object
+ */
+template <typename T>
+void FecCode<T>::encode_packet_batch(
+    const std::vector<std::vector<std::istream*>>& input_data_bufs,
+    const std::vector<std::vector<std::ostream*>>& output_parities_bufs,
+    std::vector<std::vector<Properties>>& output_parities_props)
+{
+    check_no_inline_props();
+    const size_t n_objects = input_data_bufs.size();
+    assert(output_parities_bufs.size() == n_objects);
+    assert(output_parities_props.size() == n_objects);
+
+    for (size_t obj = 0; obj < n_objects; ++obj) {
+        assert(input_data_bufs[obj].size() == n_data);
+        assert(output_parities_bufs[obj].size() == n_outputs);
+        assert(output_parities_props[obj].size() == n_outputs);
+        for (auto& props : output_parities_props[obj]) {
+            props.clear();
+        }
+    }
+
+    // vector of buffers storing columns of objects read from chunks
+    vec::Buffers<uint8_t> words_char(n_data, buf_size, alloc_policy);
+    const std::vector<uint8_t*> words_mem_char = words_char.get_mem();
+    // vector of buffers storing data that are performed in encoding, i.e. FFT
+    vec::Buffers<T> words(n_data, pkt_size, alloc_policy);
+    const std::vector<T*> words_mem_T = words.get_mem();
+
+    const int output_len = get_n_outputs();
+
+    vec::Buffers<T> output(output_len, pkt_size, alloc_policy);
+    const std::vector<T*> output_mem_T = output.get_mem();
+    vec::Buffers<uint8_t> output_char(output_len, buf_size, alloc_policy);
+    const std::vector<uint8_t*> output_mem_char = output_char.get_mem();
+
+    // properties of the current packet, located by column
+    std::vector<Properties> pkt_props(n_outputs);
+    std::vector<BatchSegment> segments;
+
+    size_t obj = 0;
+    off_t obj_offset = 0;
+
+    stats_begin_op();
+    uint64_t timer = stats_timer();
+
+    while (true) {
+        const size_t filled = read_batch_pkt(
+            input_data_bufs, words_mem_char, obj, obj_offset, segments);
+        if (filled == 0) {
+            break;
+        }
+        stats_lap(Phase::READ, timer, n_data * filled);
+
+        vec::pack<uint8_t, T>(
+            words_mem_char, words_mem_T, n_data, pkt_size, word_size);
+        stats_lap(Phase::PACK, timer, n_data * buf_size);
+
+        for (auto& props : pkt_props) {
+            props.clear();
+        }
+        encode(output, pkt_props, 0, words);
+        stats_lap(Phase::ENCODE, timer, n_data * buf_size);
+
+        vec::unpack<T, uint8_t>(
+            output_mem_T, output_mem_char, output_len, pkt_size, word_size);
+        stats_lap(Phase::UNPACK, timer, output_len * buf_size);
+
+        // split outputs and properties among the objects
+        for (const BatchSegment& seg : segments) {
+            for (unsigned i = 0; i < n_outputs; i++) {
+                output_parities_bufs[seg.object][i]->write(
+                    reinterpret_cast<char*>(
+                        output_mem_char[i] + seg.begin * word_size),
+                    seg.len * word_size);
+            }
+        }
+        for (unsigned i = 0; i < n_outputs; i++) {
+            for (const auto& prop : pkt_props[i].get_map()) {
+                const size_t col = prop.first;
+                auto seg = std::upper_bound(
+                    segments.begin(),
+                    segments.end(),
+                    col,
+                    [](size_t c, const BatchSegment& s) {
+                        return c < s.begin;
+                    });
+                // properties of unused columns are dropped
+                if (seg == segments.begin()) {
+                    continue;
+                }
+                --seg;
+                if (col < seg->begin + seg->len) {
+                    output_parities_props[seg->object][i].add(
+                        seg->offset + (col - seg->begin), prop.second);
+                }
+            }
+        }
+        stats_lap(Phase::WRITE, timer, n_outputs * filled);
+    }
+    stats_end_op();
+}
+
+/**
+ * Compute the changes of outputs induced by a change of one data fragment
+ *
+ * As the code is linear, the delta of each output is the delta of the data
+ * fragment multiplied by the corresponding coefficient of the generator
+ * matrix.
+ *
+ * @param output deltas of outputs, must be at least n_outputs
+ * @param frag_index index of the updated data fragment
+ * @param delta difference (new - old) of the data fragment, must be of
+ * `pkt_size` words
+ */
+template <typename T>
+void FecCode<T>::encode_delta(vec::Buffers<T>&, unsigned, T*)
+{
+    throw LogicError("FEC base: delta encoding is not supported");
+}
+
+/**
+ * Update parities after an overwrite of a range of a data fragment
+ *
+ * Only the updated data fragment and the outputs are read, i.e. the others
+ * data fragments are not needed.
+ *
+ * @param frag_index index of the updated data fragment
+ * @param offset location (in bytes) of the range in the fragment, must be a
+ * multiple of `buf_size`
+ * @param old_data_buf old content of the data fragment range
+ * @param new_data_buf new content of the data fragment range
+ * @param input_parities_bufs current content of outputs, must be exactly
+ * n_outputs
+ * @param output_parities_bufs updated outputs, must be exactly n_outputs
+ * @param parities_props properties bound to outputs, marks inside the range
+ * are updated
+ *
+ * @note all streams must be positioned at the beginning of the range and be
+ * of equal size
+ */
+template <typename T>
+void FecCode<T>::update_packet(
+    unsigned frag_index,
+    off_t offset,
+    std::istream* old_data_buf,
+    std::istream* new_data_buf,
+    std::vector<std::istream*> input_parities_bufs,
+    std::vector<std::ostream*> output_parities_bufs,
+    std::vector<Properties>& parities_props)
+{
+    check_no_inline_props();
+    assert(frag_index < n_data);
+    assert(offset % buf_size == 0);
+    assert(input_parities_bufs.size() == n_outputs);
+    assert(output_parities_bufs.size() == n_outputs);
+    assert(parities_props.size() == n_outputs);
+
+    bool cont = true;
+
+    // buffers storing old and new data read from the data fragment
+    vec::Buffers<uint8_t> data_char(2, buf_size, alloc_policy);
+    const std::vector<uint8_t*> data_mem_char = data_char.get_mem();
+    vec::Buffers<T> data(2, pkt_size, alloc_policy);
+    const std::vector<T*> data_mem_T = data.get_mem();
+
+    const int output_len = n_outputs;
+
+    // buffers storing outputs read from chunks
+    vec::Buffers<T> output(output_len, pkt_size, alloc_policy);
+    const std::vector<T*> output_mem_T = output.get_mem();
+    vec::Buffers<uint8_t> output_char(output_len, buf_size, alloc_policy);
+    const std::vector<uint8_t*> output_mem_char = output_char.get_mem();
+    // buffers storing deltas of outputs
+    vec::Buffers<T> deltas(output_len, pkt_size, alloc_policy);
+
+    const T thres = gf->card() - 1;
+
+    // location (in words) of the current packet, as marks
+    off_t pkt_offset = offset / word_size;
+
+    stats_begin_op();
+    uint64_t timer = stats_timer();
+
+    while (true) {
+        if (!read_pkt(
+                reinterpret_cast<char*>(data_mem_char.at(0)), *old_data_buf)
+            || !read_pkt(
+                   reinterpret_cast<char*>(data_mem_char.at(1)),
+                   *new_data_buf)) {
+            break;
+        }
+        for (unsigned i = 0; i < n_outputs; i++) {
+            if (!read_pkt(
+                    reinterpret_cast<char*>(output_mem_char.at(i)),
+                    *(input_parities_bufs[i]))) {
+                cont = false;
+                break;
+            }
+        }
+        if (!cont)
+            break;
+        stats_lap(Phase::READ, timer, (2 + output_len) * buf_size);
+
+        vec::pack<uint8_t, T>(
+            data_mem_char, data_mem_T, 2, pkt_size, word_size);
+        vec::pack<uint8_t, T>(
+            output_mem_char, output_mem_T, output_len, pkt_size, word_size);
+        stats_lap(Phase::PACK, timer, (2 + output_len) * buf_size);
+
+        // delta = new - old
+        gf->sub_two_bufs(
+            data_mem_T.at(1), data_mem_T.at(0), data_mem_T.at(0), pkt_size);
+
+        encode_delta(deltas, frag_index, data_mem_T.at(0));
+
+        // restore the out-of-range symbols, their marks are re-computed below
+        const off_t offset_max = pkt_offset + pkt_size;
+        for (unsigned i = 0; i < n_outputs; i++) {
+            T* chunk = output.get(i);
+            const std::map<off_t, uint32_t>& marks =
+                parities_props[i].get_map();
+            auto it = marks.lower_bound(pkt_offset);
+            const auto end = marks.lower_bound(offset_max);
+            while (it != end) {
+                const off_t loc_offset = it->first;
+                const bool oor = it->second == OOR_MARK;
+                ++it;
+                if (oor) {
+                    chunk[loc_offset - pkt_offset] = thres;
+                    parities_props[i].remove(loc_offset);
+                }
+            }
+        }
+
+        gf->add_vecp_to_vecp(deltas, output);
+
+        encode_post_process(output, parities_props, pkt_offset);
+        stats_lap(Phase::ENCODE, timer, 2 * buf_size);
+
+        vec::unpack<T, uint8_t>(
+            output_mem_T, output_mem_char, output_len, pkt_size, word_size);
+        stats_lap(Phase::UNPACK, timer, output_len * buf_size);
+
+        for (unsigned i = 0; i < n_outputs; i++) {
+            write_pkt(
+                reinterpret_cast<char*>(output_mem_char.at(i)),
+                *(output_parities_bufs[i]));
+        }
+        stats_lap(Phase::WRITE, timer, output_len * buf_size);
+        pkt_offset += pkt_size;
+    }
+    stats_end_op();
+}
+
+/* Initialize coefficients of syndromes
+ * It supports for FEC using multiplicative FFT over FNT
+ *
+ * Fragment t of the codeword is the evaluation at x_t = r^t of a polynomial
+ * of degree lower than k. The dual code is a generalized RS code, hence a
+ * word c is a codeword iff for j = 0, ..., m-1:
+ *
+ *   S_j = sum_t c_t * v_t * x_t^j = 0
+ *
+ * where v_t = 1 / prod_{l != t} (x_t - x_l).
+ */
+template <typename T>
+void FecCode<T>::init_syndrome_coefs()
+{
+    if (this->r_powers == nullptr) {
+        throw LogicError("FEC base: vector r^i must be initialized");
+    }
+
+    vec::Vector<T> v(*gf, code_len);
+    for (unsigned t = 0; t < code_len; ++t) {
+        const T x_t = r_powers->get(t);
+        T prod = 1;
+        for (unsigned l = 0; l < code_len; ++l) {
+            if (l != t) {
+                prod = gf->mul(prod, gf->sub(x_t, r_powers->get(l)));
+            }
+        }
+        v.set(t, gf->inv(prod));
+    }
+
+    syndrome_coefs.clear();
+    for (unsigned j = 0; j < n_parities; ++j) {
+        auto coefs = std::make_unique<vec::Vector<T>>(*gf, code_len);
+        for (unsigned t = 0; t < code_len; ++t) {
+            coefs->set(t, gf->mul(v.get(t), r_powers->get((t * j) % n)));
+        }
+        syndrome_coefs.push_back(std::move(coefs));
+    }
+}
+
+/**
+ * Check the consistency of a packet of codeword
+ *
+ * The syndromes of the codeword are computed, they are all zero iff the
+ * fragments are consistent. No decoding is performed.
+ *
+ * @param props properties bound to parities, marked symbols are restored
+ * @param offset location of the packet
+ * @param words the code_len fragments of the codeword, i.e. data fragments
+ * followed by parities if SYSTEMATIC
+ * @param tmp scratch buffers of code_len packets
+ * @param syndrome scratch buffer of one packet
+ * @return true if the packet is consistent
+ */
+template <typename T>
+bool FecCode<T>::verify(
+    const std::vector<Properties>& props,
+    off_t offset,
+    vec::Buffers<T>& words,
+    vec::Buffers<T>& tmp,
+    vec::Buffers<T>& syndrome)
+{
+    assert(words.get_n() == static_cast<int>(code_len));
+    assert(tmp.get_n() == static_cast<int>(code_len));
+    assert(syndrome.get_n() == 1);
+
+    if (syndrome_coefs.empty()) {
+        init_syndrome_coefs();
+    }
+
+    // restore symbols marked as out of range
+    const off_t offset_max = offset + pkt_size;
+    const T thres = gf->card() - 1;
+    const unsigned first_output = (type == FecType::SYSTEMATIC) ? n_data : 0;
+    for (unsigned i = 0; i < n_outputs; ++i) {
+        T* chunk = words.get(first_output + i);
+        const std::map<off_t, uint32_t>& marks = props[i].get_map();
+        const auto end = marks.lower_bound(offset_max);
+        for (auto it = marks.lower_bound(offset); it != end; ++it) {
+            if (it->second == OOR_MARK) {
+                chunk[it->first - offset] = thres;
+            }
+        }
+    }
+
+    T* syn = syndrome.get(0);
+
+    for (unsigned j = 0; j < n_parities; ++j) {
+        gf->mul_vec_to_vecp(*syndrome_coefs[j], words, tmp);
+        syndrome.copy(0, tmp.get(0));
+        for (unsigned t = 1; t < code_len; ++t) {
+            gf->add_two_bufs(tmp.get(t), syn, pkt_size);
+        }
+        for (size_t i = 0; i < pkt_size; ++i) {
+            if (syn[i] != 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Check the consistency of all fragments of codewords
+ *
+ * @param input_data_bufs if SYSTEMATIC must be exactly n_data otherwise it is
+ * unused
+ * @param input_parities_bufs must be exactly n_outputs
+ * @param input_parities_props must be exactly n_outputs
+ * @param bad_offsets receives locations of inconsistent packets
+ *
+ * @note all streams must be available and of equal size
+ *
+ * @return true if all packets are consistent
+ */
+template <typename T>
+bool FecCode<T>::verify_packet(
+    std::vector<std::istream*> input_data_bufs,
+    std::vector<std::istream*> input_parities_bufs,
+    const std::vector<Properties>& input_parities_props,
+    std::vector<off_t>& bad_offsets)
+{
+    check_no_inline_props();
+    assert(input_parities_bufs.size() == n_outputs);
+    assert(input_parities_props.size() == n_outputs);
+
+    // all fragments in the order of the codeword
+    std::vector<std::istream*> input_bufs;
+    if (type == FecType::SYSTEMATIC) {
+        assert(input_data_bufs.size() == n_data);
+        input_bufs = input_data_bufs;
     }
+    input_bufs.insert(
+        input_bufs.end(),
+        input_parities_bufs.begin(),
+        input_parities_bufs.end());
 
     bool cont = true;
     off_t offset = 0;
 
-    // vector of buffers storing data read from chunk
-    vec::Buffers<uint8_t> words_char(n_data, buf_size);
+    vec::Buffers<uint8_t> words_char(code_len, buf_size, alloc_policy);
     const std::vector<uint8_t*> words_mem_char = words_char.get_mem();
-    // vector of buffers storing data that are performed in encoding, i.e. FFT
-    vec::Buffers<T> words(n_data, pkt_size);
+    vec::Buffers<T> words(code_len, pkt_size, alloc_policy);
     const std::vector<T*> words_mem_T = words.get_mem();
+    // scratch buffers of verify()
+    vec::Buffers<T> tmp(code_len, pkt_size, alloc_policy);
+    vec::Buffers<T> syndrome(1, pkt_size, alloc_policy);
 
-    int output_len = get_n_outputs();
-
-    // vector of buffers storing data that are performed in encoding, i.e. FFT
-    vec::Buffers<T> output(output_len, pkt_size);
-    const std::vector<T*> output_mem_T = output.get_mem();
-    // vector of buffers storing data in output chunk
-    vec::Buffers<uint8_t> output_char(output_len, buf_size);
-    const std::vector<uint8_t*> output_mem_char = output_char.get_mem();
-
-    reset_stats_enc();
+    bad_offsets.clear();
 
     while (true) {
-        // TODO: get number of read bytes -> true buf size
-        for (unsigned i = 0; i < n_data; i++) {
+        for (unsigned i = 0; i < code_len; i++) {
             if (!read_pkt(
                     reinterpret_cast<char*>(words_mem_char.at(i)),
-                    *(input_data_bufs[i]))) {
+                    *(input_bufs[i]))) {
                 cont = false;
                 break;
             }
@@ -498,28 +1472,15 @@ void FecCode<T>::encode_packet(
             break;
 
         vec::pack<uint8_t, T>(
-            words_mem_char, words_mem_T, n_data, pkt_size, word_size);
-
-        timeval t1 = tick();
-        uint64_t start = hw_timer();
-        encode(output, output_parities_props, offset, words);
-        uint64_t end = hw_timer();
-        uint64_t t2 = hrtime_usec(t1);
-
-        total_enc_usec += t2;
-        total_encode_cycles += (end - start) / buf_size;
-        n_encode_ops++;
+            words_mem_char, words_mem_T, code_len, pkt_size, word_size);
 
-        vec::unpack<T, uint8_t>(
-            output_mem_T, output_mem_char, output_len, pkt_size, word_size);
-
-        for (unsigned i = 0; i < n_outputs; i++) {
-            write_pkt(
-                reinterpret_cast<char*>(output_mem_char.at(i)),
-                *(output_parities_bufs[i]));
+        if (!verify(input_parities_props, offset, words, tmp, syndrome)) {
+            bad_offsets.push_back(offset);
         }
         offset += pkt_size;
     }
+
+    return bad_offsets.empty();
 }
 
 /**
@@ -546,6 +1507,7 @@ bool FecCode<T>::decode_bufs(
     const std::vector<Properties>& input_parities_props,
     std::vector<std::ostream*> output_data_bufs)
 {
+    check_no_inline_props();
     off_t offset = 0;
     bool cont = true;
 
@@ -560,7 +1522,7 @@ bool FecCode<T>::decode_bufs(
     assert(input_parities_props.size() == n_outputs);
     assert(output_data_bufs.size() == n_data);
 
-    reset_stats_dec();
+    stats_begin_op();
     // ids of received fragments, from 0 to codelen-1
     vec::Vector<T> fragments_ids(*(this->gf), n_data);
 
@@ -574,8 +1536,10 @@ bool FecCode<T>::decode_bufs(
         }
         avail_data_nb = fragment_index;
         // data is in clear so nothing to do
-        if (fragment_index == n_data)
+        if (fragment_index == n_data) {
+            stats_end_op();
             return true;
+        }
     }
 
     vec::Vector<T> avail_parity_ids(*(this->gf), n_data - avail_data_nb);
@@ -596,8 +1560,10 @@ bool FecCode<T>::decode_bufs(
             }
         }
         // unable to decode
-        if (fragment_index < n_data)
+        if (fragment_index < n_data) {
+            stats_end_op();
             return false;
+        }
     }
 
     decode_build();
@@ -610,7 +1576,10 @@ bool FecCode<T>::decode_bufs(
     vec::Vector<T> words(*(this->gf), n_words);
     vec::Vector<T> output(*(this->gf), n_data);
 
+    uint64_t timer = stats_timer();
     std::unique_ptr<DecodeContext<T>> context = init_context_dec(fragments_ids);
+    stats_lap(Phase::CONTEXT, timer, 0);
+
     while (true) {
         words.zero_fill();
         if (type == FecType::SYSTEMATIC) {
@@ -637,16 +1606,10 @@ bool FecCode<T>::decode_bufs(
         }
         if (!cont)
             break;
+        stats_lap(Phase::READ, timer, n_data * word_size);
 
-        timeval t1 = tick();
-        uint64_t start = hw_timer();
         decode(*context, output, input_parities_props, offset, words);
-        uint64_t end = hw_timer();
-        uint64_t t2 = hrtime_usec(t1);
-
-        total_dec_usec += t2;
-        total_decode_cycles += (end - start) / word_size;
-        n_decode_ops++;
+        stats_lap(Phase::DECODE, timer, n_data * word_size);
 
         for (unsigned i = 0; i < n_data; i++) {
             if (output_data_bufs[i] != nullptr) {
@@ -654,9 +1617,11 @@ bool FecCode<T>::decode_bufs(
                 writew(tmp, output_data_bufs[i]);
             }
         }
+        stats_lap(Phase::WRITE, timer, n_data * word_size);
 
         offset++;
     }
+    stats_end_op();
 
     return true;
 }
@@ -760,7 +1725,17 @@ std::unique_ptr<DecodeContext<T>> FecCode<T>::init_context_dec(
     }
 
     return std::make_unique<DecodeContext<T>>(
-        *gf, *fft, *fft_2k, fragments_ids, vx, n_data, n, -1, size, output);
+        *gf,
+        *fft,
+        *fft_2k,
+        fragments_ids,
+        vx,
+        n_data,
+        n,
+        -1,
+        size,
+        output,
+        alloc_policy);
 }
 
 /* Prepare for decoding
@@ -857,149 +1832,642 @@ void FecCode<T>::decode_apply(
  * get_n_outputs() (use nullptr when missing)
  * @param input_parities_props if SYSTEMATIC must be exactly n_parities
  * otherwise get_n_outputs() caller is supposed to provide specific information
- * bound to parities
+ * bound to parities, unused if properties are inline (see set_inline_props())
  * @param output_data_bufs must be exactly n_data (use nullptr when not
  * missing/wanted)
+ * @param input_data_checksums if not nullptr, CRC-32C of data fragments
+ * (exactly n_data) that are verified on the fragments read
+ * @param input_parities_checksums if not nullptr, CRC-32C of parities
+ * (exactly n_outputs) that are verified on the fragments read
  *
  * @pre All streams must be of equal size
  *
- * @return true if decode succeeded, else false
+ * @note When all data fragments are available, nothing is decoded but their
+ * checksums are still verified, which reads the data streams to their end.
+ * Otherwise checksums are verified once every packet is decoded: outputs
+ * are already written when a mismatch is reported, and must be discarded.
+ *
+ * @note The decoding context and output buffers are cached on the codec
+ * (see get_context_dec()): a codec must not run concurrent decodings, use
+ * one codec per thread.
+ *
+ * @return true if decode succeeded, else false (including a checksum
+ * mismatch)
  */
 template <typename T>
 bool FecCode<T>::decode_packet(
     std::vector<std::istream*> input_data_bufs,
     std::vector<std::istream*> input_parities_bufs,
     const std::vector<Properties>& input_parities_props,
-    std::vector<std::ostream*> output_data_bufs)
+    std::vector<std::ostream*> output_data_bufs,
+    const std::vector<uint32_t>* input_data_checksums,
+    const std::vector<uint32_t>* input_parities_checksums)
 {
-    bool cont = true;
-    off_t offset = 0;
+    return decode_packet_window(
+        input_data_bufs,
+        input_parities_bufs,
+        input_parities_props,
+        output_data_bufs,
+        0,
+        0,
+        std::numeric_limits<size_t>::max(),
+        input_data_checksums,
+        input_parities_checksums);
+}
 
-    unsigned fragment_index = 0;
-    unsigned parity_index = 0;
-    unsigned avail_data_nb = 0;
+/**
+ * Decode a batch of stripes sharing the same erasure pattern by packets
+ *
+ * Received fragments are selected and the decoding context is built once
+ * for the whole batch. As for encode_packet_batch(), stripes are laid out
+ * one after the other in the columns of shared packets, so that a packet
+ * holding several small stripes is decoded at once.
+ *
+ * @param input_data_bufs for each stripe, see decode_packet(), unused for
+ * NON_SYSTEMATIC
+ * @param input_parities_bufs for each stripe, see decode_packet()
+ * @param input_parities_props for each stripe, see decode_packet()
+ * @param output_data_bufs for each stripe, see decode_packet()
+ *
+ * @pre Fragments of a stripe must be of equal size, a multiple of the word
+ * size, and the same fragments must be missing in all the stripes
+ *
+ * @note As decode_packet(), it updates the decoding context cached on the
+ * codec, so a codec must not run concurrent decodings.
+ *
+ * @return true if decode succeeded, else false
+ */
+template <typename T>
+bool FecCode<T>::decode_packet_batch(
+    const std::vector<std::vector<std::istream*>>& input_data_bufs,
+    const std::vector<std::vector<std::istream*>>& input_parities_bufs,
+    const std::vector<std::vector<Properties>>& input_parities_props,
+    const std::vector<std::vector<std::ostream*>>& output_data_bufs)
+{
+    check_no_inline_props();
+    const size_t n_stripes = input_parities_bufs.size();
+    const bool systematic = (type == FecType::SYSTEMATIC);
 
-    if (type == FecType::SYSTEMATIC) {
-        assert(input_data_bufs.size() == n_data);
+    if (systematic) {
+        assert(input_data_bufs.size() == n_stripes);
+    }
+    assert(input_parities_props.size() == n_stripes);
+    assert(output_data_bufs.size() == n_stripes);
+
+    if (n_stripes == 0) {
+        return true;
+    }
+
+    // the erasure pattern is the one of the first stripe
+    const std::vector<std::istream*> no_data;
+    const std::vector<std::istream*>& pattern_data =
+        systematic ? input_data_bufs[0] : no_data;
+    const std::vector<std::istream*>& pattern_parities =
+        input_parities_bufs[0];
+    for (size_t s = 0; s < n_stripes; s++) {
+        if (systematic) {
+            assert(input_data_bufs[s].size() == n_data);
+            for (unsigned i = 0; i < n_data; i++) {
+                if ((input_data_bufs[s][i] == nullptr)
+                    != (pattern_data[i] == nullptr)) {
+                    throw InvalidArgument(
+                        "FEC base: stripes of a batch differ in erasures");
+                }
+            }
+        }
+        assert(input_parities_bufs[s].size() == n_outputs);
+        assert(input_parities_props[s].size() == n_outputs);
+        assert(output_data_bufs[s].size() == n_data);
+        for (unsigned i = 0; i < n_outputs; i++) {
+            if ((input_parities_bufs[s][i] == nullptr)
+                != (pattern_parities[i] == nullptr)) {
+                throw InvalidArgument(
+                    "FEC base: stripes of a batch differ in erasures");
+            }
+        }
     }
-    assert(input_parities_bufs.size() == n_outputs);
-    assert(input_parities_props.size() == n_outputs);
-    assert(output_data_bufs.size() == n_data);
 
     // ids of received fragments, from 0 to codelen-1
     vec::Vector<T> fragments_ids(*(this->gf), n_data);
+    std::vector<unsigned> avail_parity_ids;
+    unsigned avail_data_nb = 0;
+
+    // unable to decode
+    if (!select_fragments(
+            pattern_data,
+            pattern_parities,
+            fragments_ids,
+            avail_parity_ids,
+            avail_data_nb)) {
+        return false;
+    }
+    // data is in clear so nothing to do
+    if (avail_data_nb == n_data)
+        return true;
+
+    decode_build();
+
+    // received streams of each stripe, in the order of `words`
+    std::vector<std::vector<std::istream*>> received(n_stripes);
+    for (size_t s = 0; s < n_stripes; s++) {
+        received[s].reserve(n_data);
+        for (unsigned i = 0; i < avail_data_nb; i++) {
+            received[s].push_back(input_data_bufs[s][fragments_ids.get(i)]);
+        }
+        for (unsigned parity_idx : avail_parity_ids) {
+            received[s].push_back(input_parities_bufs[s][parity_idx]);
+        }
+    }
+
+    // vector of buffers storing columns of stripes read from chunks
+    vec::Buffers<uint8_t> words_char(n_data, buf_size, alloc_policy);
+    const std::vector<uint8_t*> words_mem_char = words_char.get_mem();
+    // vector of buffers storing data that are performed in decoding, i.e. FFT
+    vec::Buffers<T> words(n_data, pkt_size, alloc_policy);
+    const std::vector<T*> words_mem_T = words.get_mem();
+
+    const int output_len = n_data;
+
+    stats_begin_op();
+    uint64_t timer = stats_timer();
+    const DecodeContext<T>& context = get_context_dec(fragments_ids);
+    stats_lap(Phase::CONTEXT, timer, 0);
+
+    vec::Buffers<T>& output = *dec_output;
+    const std::vector<T*> output_mem_T = output.get_mem();
+    vec::Buffers<uint8_t> output_char(output_len, buf_size, alloc_policy);
+    const std::vector<uint8_t*> output_mem_char = output_char.get_mem();
+
+    // properties of the current packet, located by column
+    std::vector<Properties> pkt_props(n_outputs);
+    std::vector<BatchSegment> segments;
+
+    size_t stripe = 0;
+    off_t stripe_offset = 0;
+
+    while (true) {
+        const size_t filled = read_batch_pkt(
+            received, words_mem_char, stripe, stripe_offset, segments);
+        if (filled == 0) {
+            break;
+        }
+        stats_lap(Phase::READ, timer, n_data * filled);
+
+        vec::pack<uint8_t, T>(
+            words_mem_char, words_mem_T, n_data, pkt_size, word_size);
+        stats_lap(Phase::PACK, timer, n_data * buf_size);
+
+        // relocate properties of received parities to the columns
+        for (unsigned parity_idx : avail_parity_ids) {
+            Properties& props = pkt_props[parity_idx];
+            props.clear();
+            for (const BatchSegment& seg : segments) {
+                // only visit the marks of the segment
+                const std::map<off_t, uint32_t>& marks =
+                    input_parities_props[seg.object][parity_idx].get_map();
+                const off_t seg_end = seg.offset + seg.len;
+                const auto end = marks.lower_bound(seg_end);
+                for (auto it = marks.lower_bound(seg.offset); it != end; ++it) {
+                    props.add(seg.begin + (it->first - seg.offset), it->second);
+                }
+            }
+        }
+
+        decode(context, output, pkt_props, 0, words);
+        stats_lap(Phase::DECODE, timer, n_data * buf_size);
+
+        vec::unpack<T, uint8_t>(
+            output_mem_T, output_mem_char, output_len, pkt_size, word_size);
+        stats_lap(Phase::UNPACK, timer, output_len * buf_size);
+
+        for (const BatchSegment& seg : segments) {
+            for (unsigned i = 0; i < n_data; i++) {
+                std::ostream* out = output_data_bufs[seg.object][i];
+                if (out != nullptr) {
+                    out->write(
+                        reinterpret_cast<char*>(
+                            output_mem_char[i] + seg.begin * word_size),
+                        seg.len * word_size);
+                }
+            }
+        }
+        stats_lap(Phase::WRITE, timer, n_data * filled);
+    }
+    stats_end_op();
+
+    return true;
+}
+
+/**
+ * Decode a byte range of buffers
+ *
+ * Only the packets covering the range are read: input streams are moved to
+ * the first of them and only the properties located inside the range are
+ * considered.
+ *
+ * @param input_data_bufs if SYSTEMATIC must be exactly n_data otherwise it is
+ * unused (use nullptr when missing)
+ * @param input_parities_bufs if SYSTEMATIC must be exactly n_parities otherwise
+ * get_n_outputs() (use nullptr when missing)
+ * @param input_parities_props if SYSTEMATIC must be exactly n_parities
+ * otherwise get_n_outputs() caller is supposed to provide specific information
+ * bound to parities
+ * @param output_data_bufs must be exactly n_data (use nullptr when not
+ * missing/wanted), only the bytes of the range are written
+ * @param offset location (in bytes) of the range in the data fragments
+ * @param length length (in bytes) of the range
+ *
+ * @pre All input streams must be seekable and of equal size
+ *
+ * @note As decode_packet(), it updates the decoding context cached on the
+ * codec, so a codec must not run concurrent decodings.
+ *
+ * @return true if decode succeeded, else false
+ */
+template <typename T>
+bool FecCode<T>::decode_range(
+    std::vector<std::istream*> input_data_bufs,
+    std::vector<std::istream*> input_parities_bufs,
+    const std::vector<Properties>& input_parities_props,
+    std::vector<std::ostream*> output_data_bufs,
+    size_t offset,
+    size_t length)
+{
+    check_no_inline_props();
+    assert(input_parities_props.size() == n_outputs);
+
+    const size_t first_pkt = offset / buf_size;
+    const size_t end_pkt = (offset + length + buf_size - 1) / buf_size;
+    const off_t word_begin = first_pkt * pkt_size;
+    const off_t word_end = end_pkt * pkt_size;
+
+    // seek to the first packet covering the range
+    for (auto* stream : input_data_bufs) {
+        if (stream != nullptr) {
+            stream->seekg(first_pkt * buf_size);
+        }
+    }
+    for (auto* stream : input_parities_bufs) {
+        if (stream != nullptr) {
+            stream->seekg(first_pkt * buf_size);
+        }
+    }
+
+    // keep only marked symbols inside the covering packets
+    std::vector<Properties> range_props(n_outputs);
+    for (unsigned i = 0; i < n_outputs; i++) {
+        for (auto const& data : input_parities_props[i].get_map()) {
+            if (data.first >= word_begin && data.first < word_end) {
+                range_props[i].add(data.first, data.second);
+            }
+        }
+    }
+
+    return decode_packet_window(
+        input_data_bufs,
+        input_parities_bufs,
+        range_props,
+        output_data_bufs,
+        word_begin,
+        offset - first_pkt * buf_size,
+        length);
+}
+
+/**
+ * Select the received fragments used to decode
+ *
+ * Available data fragments come first (for SYSTEMATIC), completed by the
+ * first available parities.
+ *
+ * @param avail_data availability of data fragments, must be exactly n_data
+ * for SYSTEMATIC
+ * @param avail_parities availability of outputs, must be exactly n_outputs
+ * @param fragments_ids receives the sorted ids of selected fragments, must
+ * be exactly n_data
+ * @param avail_parity_ids receives indices of the selected parities
+ * @param avail_data_nb receives the number of selected data fragments
+ *
+ * @return false if too few fragments are available
+ */
+template <typename T>
+bool FecCode<T>::select_fragments(
+    const std::vector<bool>& avail_data,
+    const std::vector<bool>& avail_parities,
+    vec::Vector<T>& fragments_ids,
+    std::vector<unsigned>& avail_parity_ids,
+    unsigned& avail_data_nb)
+{
+    unsigned fragment_index = 0;
+
+    avail_data_nb = 0;
+    avail_parity_ids.clear();
 
     if (type == FecType::SYSTEMATIC) {
         for (unsigned i = 0; i < n_data; i++) {
-            if (input_data_bufs[i] != nullptr) {
+            if (avail_data[i]) {
                 decode_add_data(fragment_index, i);
                 fragments_ids.set(fragment_index, i);
                 fragment_index++;
             }
         }
         avail_data_nb = fragment_index;
-        // data is in clear so nothing to do
-        if (fragment_index == n_data)
-            return true;
     }
 
-    vec::Vector<T> avail_parity_ids(*(this->gf), n_data - avail_data_nb);
+    // finish with parities available
+    for (unsigned i = 0; i < n_outputs && fragment_index < n_data; i++) {
+        if (avail_parities[i]) {
+            decode_add_parities(fragment_index, i);
+            unsigned j = (type == FecType::SYSTEMATIC) ? n_data + i : i;
+            fragments_ids.set(fragment_index, j);
+            avail_parity_ids.push_back(i);
+            fragment_index++;
+        }
+    }
+    if (fragment_index < n_data)
+        return false;
+    fragments_ids.sort();
 
-    if (fragment_index < n_data) {
-        // finish with parities available
-        for (unsigned i = 0; i < n_outputs; i++) {
-            if (input_parities_bufs[i] != nullptr) {
-                decode_add_parities(fragment_index, i);
-                unsigned j = (type == FecType::SYSTEMATIC) ? n_data + i : i;
-                fragments_ids.set(fragment_index, j);
-                avail_parity_ids.set(parity_index, i);
-                fragment_index++;
-                parity_index++;
-                // stop when we have enough parities
-                if (fragment_index == n_data)
-                    break;
-            }
+    return true;
+}
+
+/**
+ * Return the decoding context of packets for given received fragments
+ *
+ * The context is re-used as long as the received fragments do not change.
+ * It is owned by the codec: the returned reference is only valid until the
+ * next call with other fragments, or a change of the allocation policy.
+ *
+ * @param fragments_ids sorted ids of received fragments
+ */
+template <typename T>
+const DecodeContext<T>&
+FecCode<T>::get_context_dec(vec::Vector<T>& fragments_ids)
+{
+    if (dec_context != nullptr && *dec_fragments_ids == fragments_ids) {
+        return *dec_context;
+    }
+
+    if (dec_fragments_ids == nullptr) {
+        dec_fragments_ids = std::make_unique<vec::Vector<T>>(*gf, n_data);
+        dec_output =
+            std::make_unique<vec::Buffers<T>>(n_data, pkt_size, alloc_policy);
+    }
+    dec_context = nullptr;
+    dec_fragments_ids->copy(&fragments_ids);
+    dec_context =
+        init_context_dec(*dec_fragments_ids, pkt_size, dec_output.get());
+
+    return *dec_context;
+}
+
+/**
+ * Verify checksums of data fragments read to their end
+ *
+ * As in encode_packet(), only whole packets are hashed: a trailing partial
+ * packet is not part of the checksum.
+ *
+ * @param input_data_bufs exactly n_data streams of data fragments
+ * @param input_data_checksums expected CRC-32C of data fragments
+ *
+ * @return true if all checksums match, else false
+ */
+template <typename T>
+bool FecCode<T>::verify_data_checksums(
+    const std::vector<std::istream*>& input_data_bufs,
+    const std::vector<uint32_t>& input_data_checksums)
+{
+    vec::Buffers<uint8_t> buf(1, buf_size, alloc_policy);
+    const std::vector<MemoryStreambuf*> input_mems =
+        get_memory_bufs(input_data_bufs);
+
+    for (unsigned i = 0; i < n_data; i++) {
+        uint32_t checksum = 0;
+        uint8_t* pkt = buf.get(0);
+        while (read_pkt(
+            &pkt, buf.get(0), *(input_data_bufs[i]), input_mems[i])) {
+            checksum = crc32c(checksum, pkt, buf_size);
         }
-        // unable to decode
-        if (fragment_index < n_data)
+        if (input_data_checksums.at(i) != checksum) {
             return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Decode packets of buffers and write a window of decoded data
+ *
+ * @param input_data_bufs see decode_packet()
+ * @param input_parities_bufs see decode_packet()
+ * @param input_parities_props see decode_packet()
+ * @param output_data_bufs see decode_packet()
+ * @param offset location (in words) of the first packet read
+ * @param skip number of bytes of the first packet that are not written
+ * @param length maximal number of bytes written in each output
+ * @param input_data_checksums see decode_packet()
+ * @param input_parities_checksums see decode_packet()
+ *
+ * @return true if decode succeeded, else false
+ */
+template <typename T>
+bool FecCode<T>::decode_packet_window(
+    std::vector<std::istream*> input_data_bufs,
+    std::vector<std::istream*> input_parities_bufs,
+    const std::vector<Properties>& input_parities_props,
+    std::vector<std::ostream*> output_data_bufs,
+    off_t offset,
+    size_t skip,
+    size_t length,
+    const std::vector<uint32_t>* input_data_checksums,
+    const std::vector<uint32_t>* input_parities_checksums)
+{
+    bool cont = true;
+
+    if (type == FecType::SYSTEMATIC) {
+        assert(input_data_bufs.size() == n_data);
+    }
+    assert(input_parities_bufs.size() == n_outputs);
+    assert(input_parities_props.size() == n_outputs);
+    assert(output_data_bufs.size() == n_data);
+
+    // ids of received fragments, from 0 to codelen-1
+    vec::Vector<T> fragments_ids(*(this->gf), n_data);
+    std::vector<unsigned> avail_parity_ids;
+    unsigned avail_data_nb = 0;
+
+    // unable to decode
+    if (!select_fragments(
+            input_data_bufs,
+            input_parities_bufs,
+            fragments_ids,
+            avail_parity_ids,
+            avail_data_nb)) {
+        return false;
+    }
+    // data is in clear so there is nothing to decode
+    if (avail_data_nb == n_data) {
+        return input_data_checksums == nullptr
+               || verify_data_checksums(input_data_bufs, *input_data_checksums);
     }
-    fragments_ids.sort();
 
     decode_build();
 
     // vector of buffers storing data read from chunk
-    vec::Buffers<uint8_t> words_char(n_data, buf_size);
+    vec::Buffers<uint8_t> words_char(n_data, buf_size, alloc_policy);
     const std::vector<uint8_t*> words_mem_char = words_char.get_mem();
     // vector of buffers storing data that are performed in encoding, i.e. FFT
-    vec::Buffers<T> words(n_data, pkt_size);
+    vec::Buffers<T> words(n_data, pkt_size, alloc_policy);
     const std::vector<T*> words_mem_T = words.get_mem();
 
     int output_len = n_data;
 
+    stats_begin_op();
+    uint64_t timer = stats_timer();
+    const DecodeContext<T>& context = get_context_dec(fragments_ids);
+    stats_lap(Phase::CONTEXT, timer, 0);
+
     // vector of buffers storing data that are performed in decoding, i.e. FFT
-    vec::Buffers<T> output(output_len, pkt_size);
+    vec::Buffers<T>& output = *dec_output;
     const std::vector<T*> output_mem_T = output.get_mem();
     // vector of buffers storing data in output chunk
-    vec::Buffers<uint8_t> output_char(output_len, buf_size);
+    vec::Buffers<uint8_t> output_char(output_len, buf_size, alloc_policy);
     const std::vector<uint8_t*> output_mem_char = output_char.get_mem();
 
-    std::unique_ptr<DecodeContext<T>> context =
-        init_context_dec(fragments_ids, pkt_size, &output);
-
-    reset_stats_dec();
-
-    while (true) {
+    // window of written bytes, relatively to the first packet
+    const size_t window_end =
+        (length < std::numeric_limits<size_t>::max() - skip)
+            ? skip + length
+            : std::numeric_limits<size_t>::max();
+    size_t pkt_begin = 0;
+
+    // packets of streams backed by memory are accessed in place
+    const std::vector<MemoryStreambuf*> input_data_mems =
+        get_memory_bufs(input_data_bufs);
+    const std::vector<MemoryStreambuf*> input_parities_mems =
+        get_memory_bufs(input_parities_bufs);
+    const std::vector<MemoryStreambuf*> output_mems =
+        get_memory_bufs(output_data_bufs);
+    std::vector<uint8_t*> input_pkts(words_mem_char);
+    std::vector<uint8_t*> output_pkts(output_mem_char);
+
+    // running checksums of received fragments, in the order of `words`
+    const bool verify = input_data_checksums != nullptr
+                        || input_parities_checksums != nullptr;
+    std::vector<uint32_t> checksums(n_data, 0);
+
+    // marks of the current packet when they are read inline
+    std::vector<Properties> pkt_props(n_outputs);
+    const std::vector<Properties>& dec_props =
+        inline_props ? pkt_props : input_parities_props;
+
+    while (pkt_begin < window_end) {
         // TODO: get number of read bytes -> true buf size
         if (type == FecType::SYSTEMATIC) {
             for (unsigned i = 0; i < avail_data_nb; i++) {
                 unsigned data_idx = fragments_ids.get(i);
                 if (!read_pkt(
-                        reinterpret_cast<char*>(words_mem_char.at(i)),
-                        *(input_data_bufs[data_idx]))) {
+                        &input_pkts[i],
+                        words_mem_char[i],
+                        *(input_data_bufs[data_idx]),
+                        input_data_mems[data_idx])) {
                     cont = false;
                     break;
                 }
             }
         }
         for (unsigned i = 0; i < n_data - avail_data_nb; ++i) {
-            unsigned parity_idx = avail_parity_ids.get(i);
+            unsigned parity_idx = avail_parity_ids[i];
+            const unsigned j = avail_data_nb + i;
             if (!read_pkt(
-                    reinterpret_cast<char*>(
-                        words_mem_char.at(avail_data_nb + i)),
-                    *(input_parities_bufs[parity_idx]))) {
+                    &input_pkts[j],
+                    words_mem_char[j],
+                    *(input_parities_bufs[parity_idx]),
+                    input_parities_mems[parity_idx])) {
                 cont = false;
                 break;
             }
+            if (inline_props) {
+                pkt_props[parity_idx].clear();
+                if (!read_props(
+                        *(input_parities_bufs[parity_idx]),
+                        pkt_props[parity_idx],
+                        offset)) {
+                    throw InvalidArgument(
+                        "FEC base: malformed inline properties");
+                }
+            }
         }
 
         if (!cont)
             break;
+        stats_lap(Phase::READ, timer, n_data * buf_size);
+
+        if (verify) {
+            for (unsigned i = 0; i < n_data; i++) {
+                checksums[i] = crc32c(checksums[i], input_pkts[i], buf_size);
+            }
+            stats_lap(Phase::CHECKSUM, timer, n_data * buf_size);
+        }
 
         vec::pack<uint8_t, T>(
-            words_mem_char, words_mem_T, n_data, pkt_size, word_size);
+            input_pkts, words_mem_T, n_data, pkt_size, word_size);
+        stats_lap(Phase::PACK, timer, n_data * buf_size);
 
-        timeval t1 = tick();
-        uint64_t start = hw_timer();
-        decode(*context, output, input_parities_props, offset, words);
-        uint64_t end = hw_timer();
-        uint64_t t2 = hrtime_usec(t1);
+        decode(context, output, dec_props, offset, words);
+        stats_lap(Phase::DECODE, timer, n_data * buf_size);
 
-        total_dec_usec += t2;
-        total_decode_cycles += (end - start) / word_size;
-        n_decode_ops++;
+        // bytes of the packet that are inside the window
+        const size_t lo = std::max(skip, pkt_begin) - pkt_begin;
+        const size_t hi = std::min(window_end - pkt_begin, buf_size);
 
+        // only whole packets are unpacked in place
+        for (unsigned i = 0; i < n_data; i++) {
+            output_pkts[i] = output_mem_char[i];
+            if (lo == 0 && hi == buf_size) {
+                output_pkts[i] =
+                    get_out_pkt(output_mem_char[i], output_mems[i]);
+            }
+        }
         vec::unpack<T, uint8_t>(
-            output_mem_T, output_mem_char, output_len, pkt_size, word_size);
+            output_mem_T, output_pkts, output_len, pkt_size, word_size);
+        stats_lap(Phase::UNPACK, timer, output_len * buf_size);
 
         for (unsigned i = 0; i < n_data; i++) {
-            if (output_data_bufs[i] != nullptr) {
+            if (output_data_bufs[i] == nullptr
+                || output_pkts[i] != output_mem_char[i]) {
+                continue;
+            }
+            if (lo == 0 && hi == buf_size) {
                 write_pkt(
                     reinterpret_cast<char*>(output_mem_char.at(i)),
                     *(output_data_bufs[i]));
+            } else if (lo < hi) {
+                output_data_bufs[i]->write(
+                    reinterpret_cast<char*>(output_mem_char.at(i)) + lo,
+                    hi - lo);
             }
         }
+        stats_lap(Phase::WRITE, timer, lo < hi ? n_data * (hi - lo) : 0);
         offset += pkt_size;
+        pkt_begin += buf_size;
+    }
+    stats_end_op();
+
+    if (verify) {
+        for (unsigned i = 0; i < n_data; i++) {
+            unsigned frag_id = fragments_ids.get(i);
+            const std::vector<uint32_t>* expected = input_parities_checksums;
+            if (type == FecType::SYSTEMATIC) {
+                if (frag_id < n_data) {
+                    expected = input_data_checksums;
+                } else {
+                    frag_id -= n_data;
+                }
+            }
+            if (expected != nullptr && expected->at(frag_id) != checksums[i]) {
+                return false;
+            }
+        }
     }
 
     return true;
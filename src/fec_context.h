@@ -35,6 +35,7 @@
 #include <cassert>
 #include <cstdint>
 #include <memory>
+#include <utility>
 #include <vector>
 #include <sys/time.h>
 
@@ -72,7 +73,8 @@ class DecodeContext {
         const int n,
         int vx_zero = -1,
         const size_t size = 0,
-        vec::Buffers<T>* output = nullptr)
+        vec::Buffers<T>* output = nullptr,
+        const simd::AllocPolicy& policy = simd::AllocPolicy())
     {
         this->k = k;
         this->n = n;
@@ -110,9 +112,11 @@ class DecodeContext {
 
             // Buffers each of which is fully allocated
             // Buffer of length `len_2k`
-            buf1_2k = std::make_unique<vec::Buffers<T>>(len_2k, size);
+            buf1_2k =
+                std::make_unique<vec::Buffers<T>>(len_2k, size, policy);
             // Buffer of length `max_n_2k - k`
-            bNmK = std::make_unique<vec::Buffers<T>>(max_n_2k - k, size);
+            bNmK = std::make_unique<vec::Buffers<T>>(
+                max_n_2k - k, size, policy);
 
             // Buffers that are derived from the two above ones
             // Buffer sliced from `k` first elements of `buf1_2k`
@@ -132,7 +136,22 @@ class DecodeContext {
         init(vx);
     }
 
-    ~DecodeContext() = default;
+    /** Context of codes decoding by the inverse of a matrix
+     *
+     * Only the ids of received fragments are kept, the decoding matrix is
+     * handled by the code itself.
+     */
+    DecodeContext(
+        const gf::Field<T>& gf,
+        const vec::Vector<T>& fragments_ids,
+        const int k,
+        const int n)
+        : vx_zero(-1), k(k), n(n), len_2k(0), max_n_2k(n), size(0), gf(&gf),
+          fft(nullptr), fft_2k(nullptr), fragments_ids(&fragments_ids)
+    {
+    }
+
+    virtual ~DecodeContext() = default;
 
     unsigned get_len_2k() const
     {
@@ -144,6 +163,37 @@ class DecodeContext {
         return *fragments_ids;
     }
 
+    /** Decode by direct combinations of the received fragments
+     *
+     * @param coefs for each output, its coefficients for the received
+     * fragments, nullptr if the output is itself received
+     * @param src for each received output, its position among the received
+     * fragments
+     */
+    void set_direct(
+        std::vector<std::unique_ptr<vec::Vector<T>>> coefs,
+        std::vector<unsigned> src)
+    {
+        assert(coefs.size() == src.size());
+        direct_coefs = std::move(coefs);
+        direct_src = std::move(src);
+    }
+
+    bool is_direct() const
+    {
+        return !direct_coefs.empty();
+    }
+
+    const vec::Vector<T>* get_direct_coefs(unsigned i) const
+    {
+        return direct_coefs[i].get();
+    }
+
+    unsigned get_direct_src(unsigned i) const
+    {
+        return direct_src[i];
+    }
+
     vec::Vector<T>& get_vector(CtxVec type) const
     {
         switch (type) {
@@ -306,6 +356,10 @@ class DecodeContext {
     std::unique_ptr<vec::Buffers<T>> buf2_n = nullptr;
     // An `len_2k`-length buffer sliced from `buf_max_n_2k`
     std::unique_ptr<vec::Buffers<T>> buf2_2k = nullptr;
+
+    // Coefficients and sources of outputs for a direct decoding
+    std::vector<std::unique_ptr<vec::Vector<T>>> direct_coefs;
+    std::vector<unsigned> direct_src;
 };
 
 } // namespace fec
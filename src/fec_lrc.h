@@ -0,0 +1,445 @@
+/* -*- mode: c++ -*- */
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __QUAD_FEC_LRC_H__
+#define __QUAD_FEC_LRC_H__
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <vector>
+
+#include "exceptions.h"
+#include "fec_base.h"
+#include "property.h"
+
+namespace quadiron {
+namespace fec {
+
+/// Number of bytes of fragments XORed at once by local parities
+static constexpr size_t LRC_BLOCK_SIZE = 64 * 1024;
+
+/** Fragments to read for repairing a lost fragment of a Lrc */
+struct RepairPlan {
+    /// true if the fragment is repaired from its local group only
+    bool local = false;
+    /// ids of the fragments to read, empty if the fragment cannot be repaired
+    std::vector<unsigned> reads;
+};
+
+/** Locally Repairable Code (LRC) on top of a systematic code
+ *
+ * The `n_data` data fragments are split into `n_groups` local groups of
+ * consecutive fragments, each protected by a local parity: the XOR of the
+ * fragments of the group. The global code (e.g. a systematic RsFnt) adds its
+ * parities computed on all the data fragments.
+ *
+ * A lost data fragment, or a lost local parity, is repaired by reading the
+ * other fragments of its group, i.e. about `n_data / n_groups` fragments
+ * instead of `n_data` for the global code. Other losses fall back to the
+ * global code.
+ *
+ * Fragments are numbered data first, then local parities and parities of the
+ * global code:
+ *
+ * data          | local parities              | global parities
+ * ------------- | --------------------------- | ---------------------------
+ * 0..n_data-1   | n_data..n_data+n_groups-1   | n_data+n_groups..
+ *
+ * As for the global code, fragments are processed by packets: all fragments
+ * are of equal size, a multiple of `buf_size` of the global code.
+ */
+template <typename T>
+class Lrc {
+  public:
+    Lrc(FecCode<T>& global, unsigned n_groups);
+
+    unsigned get_n_data() const;
+    unsigned get_n_groups() const;
+    unsigned get_n_fragments() const;
+    unsigned get_group(unsigned fragment) const;
+    std::vector<unsigned> get_group_members(unsigned group) const;
+
+    void encode(
+        const std::vector<std::istream*>& data_bufs,
+        const std::vector<std::ostream*>& local_bufs,
+        const std::vector<std::ostream*>& global_bufs,
+        std::vector<Properties>& global_props);
+
+    RepairPlan
+    plan_repair(unsigned lost, const std::vector<bool>& avail) const;
+
+    bool repair(
+        unsigned lost,
+        const RepairPlan& plan,
+        const std::vector<std::istream*>& inputs,
+        const std::vector<Properties>& global_props,
+        std::ostream* output,
+        Properties* output_props = nullptr);
+
+  private:
+    FecCode<T>* global;
+    unsigned n_data;
+    unsigned n_groups;
+    // number of data fragments of a group, the last one may be smaller
+    unsigned group_size;
+    unsigned n_global;
+
+    void
+    xor_bufs(const std::vector<std::istream*>& inputs, std::ostream& output);
+};
+
+/**
+ * Create a LRC
+ *
+ * @param global systematic code of the global parities
+ * @param n_groups number of local groups, at most the number of data
+ * fragments of `global`
+ */
+template <typename T>
+Lrc<T>::Lrc(FecCode<T>& global, unsigned n_groups)
+{
+    if (global.type != FecType::SYSTEMATIC) {
+        throw InvalidArgument("LRC: the global code must be systematic");
+    }
+    if (n_groups == 0 || n_groups > global.n_data) {
+        throw InvalidArgument("LRC: invalid number of local groups");
+    }
+    this->global = &global;
+    this->n_data = global.n_data;
+    this->group_size = (n_data + n_groups - 1) / n_groups;
+    // groups of `group_size` data fragments, none of them empty
+    this->n_groups = (n_data + group_size - 1) / group_size;
+    this->n_global = global.n_outputs;
+}
+
+template <typename T>
+inline unsigned Lrc<T>::get_n_data() const
+{
+    return n_data;
+}
+
+/** Return the number of local groups
+ *
+ * @note it may be lower than requested so that no group is empty
+ */
+template <typename T>
+inline unsigned Lrc<T>::get_n_groups() const
+{
+    return n_groups;
+}
+
+template <typename T>
+inline unsigned Lrc<T>::get_n_fragments() const
+{
+    return n_data + n_groups + n_global;
+}
+
+/** Return the local group of a data fragment or of a local parity */
+template <typename T>
+inline unsigned Lrc<T>::get_group(unsigned fragment) const
+{
+    assert(fragment < n_data + n_groups);
+
+    return (fragment < n_data) ? fragment / group_size : fragment - n_data;
+}
+
+/** Return the fragments of a group: its data fragments then local parity */
+template <typename T>
+std::vector<unsigned> Lrc<T>::get_group_members(unsigned group) const
+{
+    assert(group < n_groups);
+
+    std::vector<unsigned> members;
+    const unsigned end = std::min((group + 1) * group_size, n_data);
+    for (unsigned i = group * group_size; i < end; i++) {
+        members.push_back(i);
+    }
+    members.push_back(n_data + group);
+
+    return members;
+}
+
+/**
+ * Encode local and global parities
+ *
+ * @param data_bufs must be exactly `n_data` seekable streams, as they are
+ * read once for the local parities and once for the global code
+ * @param local_bufs must be exactly `n_groups`
+ * @param global_bufs outputs of the global code
+ * @param global_props properties of the outputs of the global code
+ */
+template <typename T>
+void Lrc<T>::encode(
+    const std::vector<std::istream*>& data_bufs,
+    const std::vector<std::ostream*>& local_bufs,
+    const std::vector<std::ostream*>& global_bufs,
+    std::vector<Properties>& global_props)
+{
+    assert(data_bufs.size() == n_data);
+    assert(local_bufs.size() == n_groups);
+
+    std::vector<std::streampos> starts;
+    for (std::istream* buf : data_bufs) {
+        starts.push_back(buf->tellg());
+        if (starts.back() == std::streampos(-1)) {
+            throw InvalidArgument("LRC: data fragments must be seekable");
+        }
+    }
+
+    for (unsigned g = 0; g < n_groups; g++) {
+        std::vector<std::istream*> group;
+        for (const unsigned i : get_group_members(g)) {
+            if (i < n_data) {
+                group.push_back(data_bufs[i]);
+            }
+        }
+        xor_bufs(group, *local_bufs[g]);
+    }
+
+    for (unsigned i = 0; i < n_data; i++) {
+        data_bufs[i]->clear();
+        data_bufs[i]->seekg(starts[i]);
+    }
+    global->encode_packet(data_bufs, global_bufs, global_props);
+}
+
+/**
+ * Plan the repair of a lost fragment
+ *
+ * A data fragment or a local parity is repaired from its group when all the
+ * other fragments of the group are available. Otherwise `n_data` fragments are
+ * read for the global code: available data fragments first, as they need no
+ * decoding, then global parities.
+ *
+ * @param lost id of the fragment to repair
+ * @param avail availability of each fragment, must be exactly
+ * get_n_fragments()
+ *
+ * @return fragments to read, none if the fragment cannot be repaired
+ */
+template <typename T>
+RepairPlan
+Lrc<T>::plan_repair(unsigned lost, const std::vector<bool>& avail) const
+{
+    assert(lost < get_n_fragments());
+    assert(avail.size() == get_n_fragments());
+
+    RepairPlan plan;
+
+    if (lost < n_data + n_groups) {
+        plan.local = true;
+        for (const unsigned i : get_group_members(get_group(lost))) {
+            if (i == lost) {
+                continue;
+            }
+            if (!avail[i]) {
+                plan.local = false;
+                break;
+            }
+            plan.reads.push_back(i);
+        }
+        if (plan.local) {
+            return plan;
+        }
+        plan.reads.clear();
+    }
+
+    for (unsigned i = 0; i < n_data; i++) {
+        if (i != lost && avail[i]) {
+            plan.reads.push_back(i);
+        }
+    }
+    for (unsigned i = 0; i < n_global && plan.reads.size() < n_data; i++) {
+        const unsigned id = n_data + n_groups + i;
+        if (id != lost && avail[id]) {
+            plan.reads.push_back(id);
+        }
+    }
+    if (plan.reads.size() < n_data) {
+        plan.reads.clear();
+    }
+
+    return plan;
+}
+
+/**
+ * Repair a lost fragment
+ *
+ * @param lost id of the fragment to repair
+ * @param plan plan of the repair, see plan_repair()
+ * @param inputs must be exactly get_n_fragments(), streams of the fragments
+ * read by the plan, others are unused
+ * @param global_props properties of the outputs of the global code
+ * @param output receives the repaired fragment
+ * @param output_props receives the properties of a repaired global parity
+ *
+ * @return false if the fragment cannot be repaired
+ */
+template <typename T>
+bool Lrc<T>::repair(
+    unsigned lost,
+    const RepairPlan& plan,
+    const std::vector<std::istream*>& inputs,
+    const std::vector<Properties>& global_props,
+    std::ostream* output,
+    Properties* output_props)
+{
+    assert(inputs.size() == get_n_fragments());
+    assert(global_props.size() == n_global);
+
+    if (plan.reads.empty()) {
+        return false;
+    }
+    if (plan.local) {
+        std::vector<std::istream*> group;
+        for (const unsigned i : plan.reads) {
+            group.push_back(inputs[i]);
+        }
+        xor_bufs(group, *output);
+        return true;
+    }
+
+    // data fragments needed to rebuild the lost fragment
+    std::vector<bool> needed(n_data, false);
+    if (lost < n_data) {
+        needed[lost] = true;
+    } else if (lost < n_data + n_groups) {
+        for (const unsigned i : get_group_members(lost - n_data)) {
+            if (i < n_data) {
+                needed[i] = true;
+            }
+        }
+    } else {
+        needed.assign(n_data, true);
+    }
+
+    std::vector<std::istream*> data_bufs(n_data, nullptr);
+    std::vector<std::istream*> parities_bufs(n_global, nullptr);
+    for (const unsigned i : plan.reads) {
+        if (i < n_data) {
+            data_bufs[i] = inputs[i];
+        } else {
+            parities_bufs[i - n_data - n_groups] = inputs[i];
+        }
+    }
+
+    // the decoder consumes available data fragments: needed ones are taken
+    // from its outputs as well
+    std::vector<std::unique_ptr<std::stringstream>> decoded(n_data);
+    std::vector<std::istream*> data(data_bufs);
+    if (std::count(data_bufs.begin(), data_bufs.end(), nullptr) > 0) {
+        std::vector<std::ostream*> decoded_bufs(n_data, nullptr);
+        for (unsigned i = 0; i < n_data; i++) {
+            if (i == lost) {
+                decoded_bufs[i] = output;
+            } else if (needed[i]) {
+                decoded[i] = std::make_unique<std::stringstream>();
+                decoded_bufs[i] = decoded[i].get();
+                data[i] = decoded[i].get();
+            }
+        }
+        if (!global->decode_packet(
+                data_bufs, parities_bufs, global_props, decoded_bufs)) {
+            return false;
+        }
+    }
+    if (lost < n_data) {
+        return true;
+    }
+
+    if (lost < n_data + n_groups) {
+        std::vector<std::istream*> group;
+        for (const unsigned i : get_group_members(lost - n_data)) {
+            if (i < n_data) {
+                group.push_back(data[i]);
+            }
+        }
+        xor_bufs(group, *output);
+        return true;
+    }
+
+    // re-encode the lost global parity only
+    const unsigned parity = lost - n_data - n_groups;
+    std::vector<std::unique_ptr<std::ostringstream>> others(n_global);
+    std::vector<std::ostream*> global_bufs(n_global);
+    std::vector<Properties> props(n_global);
+    for (unsigned i = 0; i < n_global; i++) {
+        if (i == parity) {
+            global_bufs[i] = output;
+        } else {
+            others[i] = std::make_unique<std::ostringstream>();
+            global_bufs[i] = others[i].get();
+        }
+    }
+    global->encode_packet(data, global_bufs, props);
+    if (output_props != nullptr) {
+        *output_props = props[parity];
+    }
+
+    return true;
+}
+
+/** Write the XOR of streams of equal size */
+template <typename T>
+void Lrc<T>::xor_bufs(
+    const std::vector<std::istream*>& inputs,
+    std::ostream& output)
+{
+    std::vector<char> acc(LRC_BLOCK_SIZE);
+    std::vector<char> block(LRC_BLOCK_SIZE);
+
+    while (true) {
+        inputs[0]->read(acc.data(), LRC_BLOCK_SIZE);
+        const size_t len = inputs[0]->gcount();
+        for (size_t u = 1; u < inputs.size(); u++) {
+            inputs[u]->read(block.data(), std::max<size_t>(len, 1));
+            if (static_cast<size_t>(inputs[u]->gcount()) != len) {
+                throw InvalidArgument("LRC: fragments differ in size");
+            }
+            for (size_t j = 0; j < len; j++) {
+                acc[j] ^= block[j];
+            }
+        }
+        if (len == 0) {
+            break;
+        }
+        output.write(acc.data(), len);
+    }
+}
+
+} // namespace fec
+} // namespace quadiron
+
+#endif
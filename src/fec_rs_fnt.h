@@ -41,6 +41,16 @@
 namespace quadiron {
 namespace fec {
 
+/** Algorithms decoding packets of RsFnt */
+enum class DecodeAlgo {
+    /** The cheapest one for the received fragments */
+    AUTO,
+    /** Lagrange interpolation by FFT */
+    FFT,
+    /** Combination of the received fragments for each missing one */
+    DIRECT
+};
+
 /** Reed-Solomon (RS) erasure code based on Fermat Number Transform (FNT).
  *
  * This class implements a Forward Error Correction (FEC) code based on FNT
@@ -59,6 +69,12 @@ class RsFnt : public FecCode<T> {
     std::unique_ptr<vec::Vector<T>> enc_frag_ids;
     // decoding context used in encoding of systematic FNT
     std::unique_ptr<DecodeContext<T>> enc_context;
+    // coefficients of outputs per data fragment, used for delta encoding
+    std::vector<std::unique_ptr<vec::Vector<T>>> delta_coefs;
+    // algorithm decoding packets
+    DecodeAlgo decode_algo = DecodeAlgo::AUTO;
+    // products of received fragments by coefficients, for direct decoding
+    std::unique_ptr<vec::Buffers<T>> direct_tmp;
 
     // Indices used for accelerated functions
     size_t simd_vec_len;
@@ -66,6 +82,8 @@ class RsFnt : public FecCode<T> {
     size_t simd_offset;
 
   public:
+    using FecCode<T>::decode;
+
     RsFnt(
         FecType type,
         unsigned word_size,
@@ -143,25 +161,269 @@ class RsFnt : public FecCode<T> {
                 enc_frag_ids->set(i, i);
             }
 
-            inter_words =
-                std::make_unique<vec::Buffers<T>>(this->n_data, this->pkt_size);
-            suffix_words = std::make_unique<vec::Buffers<T>>(
-                this->n - this->n_data - this->n_outputs, this->pkt_size);
+            alloc_systematic_buffers();
+        }
+
+        // computed lazily on the first update of each data fragment
+        delta_coefs.resize(this->n_data);
+    }
+
+    /** Allocate buffers of intermediate symbols used for systematic FNT */
+    void alloc_systematic_buffers()
+    {
+        const simd::AllocPolicy& policy = this->alloc_policy;
+
+        // the context refers to `inter_words`: release it first
+        enc_context = nullptr;
+        inter_words = std::make_unique<vec::Buffers<T>>(
+            this->n_data, this->pkt_size, policy);
+        suffix_words = std::make_unique<vec::Buffers<T>>(
+            this->n - this->n_data - this->n_outputs, this->pkt_size, policy);
 
-            enc_context = this->init_context_dec(
-                *enc_frag_ids, this->pkt_size, inter_words.get());
+        enc_context = this->init_context_dec(
+            *enc_frag_ids, this->pkt_size, inter_words.get());
+
+        // for decoding
+        this->dec_inter_codeword = std::make_unique<vec::Buffers<T>>(
+            this->n, this->pkt_size, policy);
+    }
 
-            // for decoding
-            this->dec_inter_codeword =
-                std::make_unique<vec::Buffers<T>>(this->n, this->pkt_size);
+    void realloc_buffers() override
+    {
+        FecCode<T>::realloc_buffers();
+        direct_tmp = nullptr;
+        if (this->type == FecType::SYSTEMATIC) {
+            alloc_systematic_buffers();
         }
     }
 
+    /**
+     * Compute the coefficients decoding directly each output
+     *
+     * With \f$x_i\f$ the evaluation points of the received fragments, the
+     * interpolating polynomial is \f$P(x) = \sum_i v_i L_i(x)\f$ where,
+     * with \f$A(x) = \prod_m (x - x_m)\f$,
+     * \f[
+     *  L_i(x) = \frac{A(x)}{(x - x_i) A'(x_i)}
+     * \f]
+     * For SYSTEMATIC, a missing data fragment \f$j\f$ is \f$P(r^j)\f$, i.e.
+     * the coefficient of \f$v_i\f$ is \f$L_i(r^j)\f$. For NON_SYSTEMATIC,
+     * data are the coefficients of \f$P\f$: the coefficient of \f$v_i\f$ for
+     * the data \f$t\f$ is the one of \f$x^t\f$ in \f$L_i\f$, obtained by a
+     * synthetic division of \f$A\f$ by \f$(x - x_i)\f$.
+     *
+     * @param context context of the received fragments
+     */
+    void init_direct(DecodeContext<T>& context)
+    {
+        const gf::Field<T>& gf = *(this->gf);
+        const vec::Vector<T>& fragments_ids = context.get_fragments_id();
+        const unsigned k = this->n_data;
+
+        // evaluation points and 1 / A'_i(x_i)
+        std::vector<T> x(k);
+        std::vector<T> inv_a(k);
+        for (unsigned i = 0; i < k; i++) {
+            x[i] = this->r_powers->get(fragments_ids.get(i));
+        }
+        for (unsigned i = 0; i < k; i++) {
+            T a = 1;
+            for (unsigned m = 0; m < k; m++) {
+                if (m != i) {
+                    a = gf.mul(a, gf.sub(x[i], x[m]));
+                }
+            }
+            inv_a[i] = gf.inv(a);
+        }
+
+        std::vector<std::unique_ptr<vec::Vector<T>>> coefs(k);
+        std::vector<unsigned> src(k, 0);
+
+        if (this->type == FecType::SYSTEMATIC) {
+            std::vector<bool> received(k, false);
+            for (unsigned i = 0; i < k; i++) {
+                const unsigned id = fragments_ids.get(i);
+                if (id < k) {
+                    received[id] = true;
+                    src[id] = i;
+                }
+            }
+            for (unsigned j = 0; j < k; j++) {
+                if (received[j]) {
+                    continue;
+                }
+                const T x_j = this->r_powers->get(j);
+                T a_j = 1;
+                for (unsigned m = 0; m < k; m++) {
+                    a_j = gf.mul(a_j, gf.sub(x_j, x[m]));
+                }
+                coefs[j] = std::make_unique<vec::Vector<T>>(gf, k);
+                for (unsigned i = 0; i < k; i++) {
+                    const T l_i = gf.mul(a_j, gf.inv(gf.sub(x_j, x[i])));
+                    coefs[j]->set(i, gf.mul(l_i, inv_a[i]));
+                }
+            }
+        } else {
+            // A(x) = prod_m (x - x_m)
+            std::vector<T> a(k + 1, 0);
+            a[0] = 1;
+            for (unsigned m = 0; m < k; m++) {
+                for (unsigned t = m + 1; t > 0; t--) {
+                    a[t] = gf.sub(a[t - 1], gf.mul(x[m], a[t]));
+                }
+                a[0] = gf.sub(0, gf.mul(x[m], a[0]));
+            }
+            for (unsigned t = 0; t < k; t++) {
+                coefs[t] = std::make_unique<vec::Vector<T>>(gf, k);
+            }
+            std::vector<T> q(k);
+            for (unsigned i = 0; i < k; i++) {
+                // A(x) / (x - x_i)
+                q[k - 1] = a[k];
+                for (unsigned t = k - 1; t > 0; t--) {
+                    q[t - 1] = gf.add(a[t], gf.mul(x[i], q[t]));
+                }
+                for (unsigned t = 0; t < k; t++) {
+                    coefs[t]->set(i, gf.mul(q[t], inv_a[i]));
+                }
+            }
+        }
+
+        context.set_direct(std::move(coefs), std::move(src));
+    }
+
+    /**
+     * Compute the column of the generator matrix for a data fragment
+     *
+     * For NON_SYSTEMATIC, output j is \f$\sum_i d_i r^{ij}\f$.
+     *
+     * For SYSTEMATIC, output j is \f$P(x_{k+j})\f$ where \f$P\f$ interpolates
+     * the data at \f$x_i = r^i\f$. Hence the coefficient of \f$d_i\f$ is the
+     * Lagrange basis polynomial
+     * \f[
+     *  L_i(x) = \frac{A(x)}{(x - x_i) A'_i(x_i)}
+     * \f]
+     * evaluated at \f$x_{k+j}\f$, where \f$1/(x_i A'_i(x_i))\f$ is already
+     * stored in the encoding context.
+     *
+     * @param frag_index index of the data fragment
+     */
+    void init_delta_coefs(unsigned frag_index)
+    {
+        auto coefs =
+            std::make_unique<vec::Vector<T>>(*(this->gf), this->n_outputs);
+
+        if (this->type == FecType::SYSTEMATIC) {
+            const vec::Vector<T>& inv_A_i =
+                enc_context->get_vector(CtxVec::INV_A_I);
+            const T x_i = this->r_powers->get(frag_index);
+            // x_i / (x_i * A'_i(x_i))
+            const T c_i = this->gf->mul(inv_A_i.get(frag_index), x_i);
+
+            for (unsigned j = 0; j < this->n_outputs; ++j) {
+                const T x = this->r_powers->get(this->n_data + j);
+                // A(x) / (x - x_i)
+                T a = 1;
+                for (unsigned m = 0; m < this->n_data; ++m) {
+                    if (m != frag_index) {
+                        a = this->gf->mul(
+                            a, this->gf->sub(x, this->r_powers->get(m)));
+                    }
+                }
+                coefs->set(j, this->gf->mul(a, c_i));
+            }
+        } else {
+            for (unsigned j = 0; j < this->n_outputs; ++j) {
+                coefs->set(j, this->r_powers->get((frag_index * j) % this->n));
+            }
+        }
+
+        delta_coefs[frag_index] = std::move(coefs);
+    }
+
     int get_n_outputs() override
     {
         return (this->type == FecType::SYSTEMATIC) ? this->n_parities : this->n;
     }
 
+    /** Set the algorithm decoding packets
+     *
+     * @param algo - DecodeAlgo::AUTO (default) selects it per received
+     * fragments, see get_decode_algo()
+     */
+    void set_decode_algo(DecodeAlgo algo)
+    {
+        decode_algo = algo;
+        // cached contexts are built for the previous algorithm
+        FecCode<T>::realloc_buffers();
+    }
+
+    /**
+     * Return the algorithm decoding packets from given received fragments
+     *
+     * The cost of each algorithm is estimated by its number of
+     * multiplications per word. Lagrange interpolation runs an inverse FFT
+     * of length \f$n\f$, two FFTs of length \f$2k\f$ and, for SYSTEMATIC,
+     * another FFT of length \f$n\f$, whatever the number of missing data
+     * fragments. Direct decoding combines the \f$k\f$ received fragments for
+     * each of the \f$e\f$ missing data fragments (all of them for
+     * NON_SYSTEMATIC), i.e. \f$e k\f$ multiplications.
+     *
+     * @param fragments_ids sorted ids of received fragments
+     */
+    DecodeAlgo get_decode_algo(const vec::Vector<T>& fragments_ids) const
+    {
+        if (decode_algo != DecodeAlgo::AUTO) {
+            return decode_algo;
+        }
+        const bool systematic = this->type == FecType::SYSTEMATIC;
+        const size_t k = this->n_data;
+        size_t n_missing = k;
+        if (systematic) {
+            n_missing = 0;
+            for (unsigned i = 0; i < k; i++) {
+                if (fragments_ids.get(i) >= k) {
+                    n_missing++;
+                }
+            }
+        }
+
+        // radix-2 FFT of length `len`
+        const auto fft_cost = [](size_t len) {
+            return len / 2 * arith::log2<T>(static_cast<int>(len));
+        };
+        const size_t n = this->n;
+        const size_t len_2k = this->gf->get_code_len_high_compo(2 * k);
+        size_t lagrange_cost =
+            k + fft_cost(n) + 2 * fft_cost(len_2k) + len_2k;
+        if (systematic) {
+            lagrange_cost += fft_cost(n);
+        }
+
+        return (n_missing * k < lagrange_cost) ? DecodeAlgo::DIRECT
+                                                : DecodeAlgo::FFT;
+    }
+
+    /**
+     * Initialize the context of decoding
+     *
+     * Contexts of packets are completed by the coefficients of a direct
+     * decoding if it is the cheapest algorithm, see get_decode_algo().
+     */
+    std::unique_ptr<DecodeContext<T>> init_context_dec(
+        vec::Vector<T>& fragments_ids,
+        size_t size = 0,
+        vec::Buffers<T>* output = nullptr) override
+    {
+        std::unique_ptr<DecodeContext<T>> context =
+            FecCode<T>::init_context_dec(fragments_ids, size, output);
+
+        if (size > 0 && get_decode_algo(fragments_ids) == DecodeAlgo::DIRECT) {
+            init_direct(*context);
+        }
+        return context;
+    }
+
     /**
      * Encode vector
      *
@@ -242,7 +504,79 @@ class RsFnt : public FecCode<T> {
         } else {
             this->fft->fft(output, words);
         }
+        uint64_t timer = this->stats_timer();
         encode_post_process(output, props, offset);
+        this->stats_lap(
+            Phase::POST_PROCESS, timer, this->n_outputs * this->buf_size);
+    }
+
+    /**
+     * Decode a packet
+     *
+     * A direct decoding computes each missing data fragment as a
+     * multiply-accumulate of the received fragments, others are copied.
+     */
+    void decode(
+        const DecodeContext<T>& context,
+        vec::Buffers<T>& output,
+        const std::vector<Properties>& props,
+        off_t offset,
+        vec::Buffers<T>& words) override
+    {
+        if (!context.is_direct()) {
+            FecCode<T>::decode(context, output, props, offset, words);
+            return;
+        }
+        // out-of-range symbols are restored in `words`
+        this->decode_prepare(context, props, offset, words);
+
+        if (direct_tmp == nullptr) {
+            direct_tmp = std::make_unique<vec::Buffers<T>>(
+                1, this->pkt_size, this->alloc_policy);
+        }
+        T* tmp = direct_tmp->get(0);
+        const size_t len = output.get_size();
+        const T h = this->gf->card_minus_one();
+
+        for (unsigned i = 0; i < this->n_data; i++) {
+            const vec::Vector<T>* coefs = context.get_direct_coefs(i);
+            if (coefs == nullptr) {
+                output.copy(i, words.get(context.get_direct_src(i)));
+                continue;
+            }
+            T* out = output.get(i);
+            output.fill(i, 0);
+            for (unsigned j = 0; j < this->n_data; j++) {
+                const T coef = coefs->get(j);
+                // SIMD products are only valid for 1 < coef < card - 1
+                if (coef == 0) {
+                    continue;
+                } else if (coef == 1) {
+                    this->gf->add_two_bufs(words.get(j), out, len);
+                } else if (coef == h) {
+                    this->gf->sub_two_bufs(out, words.get(j), out, len);
+                } else {
+                    this->gf->mul_coef_to_buf(coef, words.get(j), tmp, len);
+                    this->gf->add_two_bufs(tmp, out, len);
+                }
+            }
+        }
+    }
+
+    void encode_delta(vec::Buffers<T>& output, unsigned frag_index, T* delta)
+        override
+    {
+        assert(frag_index < this->n_data);
+
+        if (delta_coefs[frag_index] == nullptr) {
+            init_delta_coefs(frag_index);
+        }
+
+        // all outputs are computed from the same delta
+        const std::vector<T*> delta_mem(this->n_outputs, delta);
+        vec::Buffers<T> deltas(this->n_outputs, this->pkt_size, delta_mem);
+
+        this->gf->mul_vec_to_vecp(*delta_coefs[frag_index], deltas, output);
     }
 
     void encode_post_process(
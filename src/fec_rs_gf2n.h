@@ -31,8 +31,11 @@
 #ifndef __QUAD_FEC_RS_GF2N_H__
 #define __QUAD_FEC_RS_GF2N_H__
 
+#include <map>
+
 #include "fec_base.h"
 #include "gf_bin_ext.h"
+#include "vec_bitslice.h"
 #include "vec_matrix.h"
 #include "vec_vector.h"
 
@@ -43,6 +46,15 @@ enum class RsMatrixType { VANDERMONDE, CAUCHY };
 
 /** Reed-Solomon (RS) Erasure code over GF(2<sup>n</sup>) (Cauchy or
  *  Vandermonde).
+ *
+ * Packets are encoded and decoded on bit-sliced buffers (see
+ * vec::BitSlicedBuffers): each coefficient of the matrix is expanded into a
+ * binary matrix, so that coding is a pure sequence of XORs of bit-planes.
+ * XOR schedules are computed once for encoding and for each pattern of
+ * received fragments (see vec::XorSchedule).
+ *
+ * Fields wider than vec::BITSLICE_MAX_BITS are not bit-sliced: their packets
+ * are coded word by word with the matrices.
  */
 template <typename T>
 class RsGf2n : public FecCode<T> {
@@ -56,8 +68,14 @@ class RsGf2n : public FecCode<T> {
         unsigned word_size,
         unsigned n_data,
         unsigned n_parities,
-        RsMatrixType type)
-        : FecCode<T>(FecType::SYSTEMATIC, word_size, n_data, n_parities)
+        RsMatrixType type,
+        size_t pkt_size = 8)
+        : FecCode<T>(
+              FecType::SYSTEMATIC,
+              word_size,
+              n_data,
+              n_parities,
+              pkt_size)
     {
         mat_type = type;
         this->fec_init();
@@ -94,6 +112,15 @@ class RsGf2n : public FecCode<T> {
         // has to be a n_data*n_data invertible square matrix
         decode_mat = std::unique_ptr<vec::Matrix<T>>(new vec::Matrix<T>(
             *(this->gf), mat->get_n_cols(), mat->get_n_cols()));
+
+        const unsigned gf_n = 8 * this->word_size;
+        sliced = gf_n <= vec::BITSLICE_MAX_BITS;
+        if (sliced) {
+            const vec::BitSlicedMatrix<T> bit_mat(*(this->gf), gf_n, *mat);
+            enc_schedule =
+                std::make_unique<vec::XorSchedule<T>>(bit_mat, this->pkt_size);
+        }
+        alloc_sliced_buffers();
     }
 
     int get_n_outputs() override
@@ -110,6 +137,21 @@ class RsGf2n : public FecCode<T> {
         mat->mul(&output, &words);
     }
 
+    void encode(
+        vec::Buffers<T>& output,
+        std::vector<Properties>&,
+        off_t,
+        vec::Buffers<T>& words) override
+    {
+        if (!sliced) {
+            mul_words(*mat, output, words);
+            return;
+        }
+        sliced_words->slice(words);
+        enc_schedule->apply(*sliced_output, *sliced_words);
+        sliced_output->unslice(output);
+    }
+
     void decode_add_data(int fragment_index, int row) override
     {
         // for each data available generate the corresponding identity
@@ -144,16 +186,162 @@ class RsGf2n : public FecCode<T> {
         decode_mat->mul(&output, &words);
     }
 
-    std::unique_ptr<DecodeContext<T>>
-    init_context_dec(vec::Vector<T>&, size_t, vec::Buffers<T>*) override
+    void decode(
+        const DecodeContext<T>& context,
+        vec::Buffers<T>& output,
+        const std::vector<Properties>&,
+        off_t,
+        vec::Buffers<T>& words) override
+    {
+        const PacketContext& pkt_context =
+            static_cast<const PacketContext&>(context);
+        if (!sliced) {
+            mul_words(*(pkt_context.mat), output, words);
+            return;
+        }
+        sliced_words->slice(words);
+        pkt_context.schedule->apply(*sliced_decoded, *sliced_words);
+        sliced_decoded->unslice(output);
+    }
+
+    /**
+     * Create the decoding context of received fragments
+     *
+     * For packets, the XOR schedule of the inverted matrix (see
+     * decode_build()) is looked up in a cache of patterns of received
+     * fragments, or computed. Fields that are not bit-sliced need no
+     * schedule: the context keeps a copy of the inverted matrix instead.
+     */
+    std::unique_ptr<DecodeContext<T>> init_context_dec(
+        vec::Vector<T>& fragments_ids,
+        size_t size,
+        vec::Buffers<T>*) override
     {
-        std::unique_ptr<DecodeContext<T>> context;
+        if (size == 0) {
+            return std::make_unique<DecodeContext<T>>(
+                *(this->gf), fragments_ids, this->n_data, this->code_len);
+        }
+
+        auto context = std::make_unique<PacketContext>(
+            *(this->gf), fragments_ids, this->n_data, this->code_len);
+        if (!sliced) {
+            const int n_rows = decode_mat->get_n_rows();
+            const int n_cols = decode_mat->get_n_cols();
+            context->mat =
+                std::make_unique<vec::Matrix<T>>(*(this->gf), n_rows, n_cols);
+            for (int i = 0; i < n_rows; i++) {
+                for (int j = 0; j < n_cols; j++) {
+                    context->mat->set(i, j, decode_mat->get(i, j));
+                }
+            }
+        } else {
+            std::vector<T> pattern(
+                fragments_ids.get_mem(),
+                fragments_ids.get_mem() + this->n_data);
+            auto it = dec_schedules.find(pattern);
+            if (it == dec_schedules.end()) {
+                if (dec_schedules.size() >= DEC_SCHEDULES_MAX) {
+                    dec_schedules.clear();
+                }
+                const unsigned gf_n = 8 * this->word_size;
+                const vec::BitSlicedMatrix<T> bit_mat(
+                    *(this->gf), gf_n, *decode_mat);
+                it = dec_schedules
+                         .emplace(
+                             pattern,
+                             std::make_shared<vec::XorSchedule<T>>(
+                                 bit_mat, this->pkt_size))
+                         .first;
+            }
+            context->schedule = it->second;
+        }
+
         return context;
     }
 
+  protected:
+    void realloc_buffers() override
+    {
+        FecCode<T>::realloc_buffers();
+        alloc_sliced_buffers();
+    }
+
   private:
     std::unique_ptr<vec::Matrix<T>> mat = nullptr;
     std::unique_ptr<vec::Matrix<T>> decode_mat = nullptr;
+    // whether packets are coded on bit-sliced buffers
+    bool sliced = false;
+    // largest number of cached decoding schedules
+    static constexpr size_t DEC_SCHEDULES_MAX = 64;
+
+    std::unique_ptr<vec::XorSchedule<T>> enc_schedule = nullptr;
+    // decoding schedules by ids of received fragments, shared with contexts
+    std::map<std::vector<T>, std::shared_ptr<vec::XorSchedule<T>>>
+        dec_schedules;
+    // bit-sliced packets of received fragments, parities and decoded data
+    std::unique_ptr<vec::BitSlicedBuffers<T>> sliced_words = nullptr;
+    std::unique_ptr<vec::BitSlicedBuffers<T>> sliced_output = nullptr;
+    std::unique_ptr<vec::BitSlicedBuffers<T>> sliced_decoded = nullptr;
+
+    /** Decoding context of packets
+     *
+     * It holds the XOR schedule decoding bit-sliced packets, or the inverted
+     * matrix decoding packets word by word.
+     */
+    class PacketContext : public DecodeContext<T> {
+      public:
+        PacketContext(
+            const gf::Field<T>& gf,
+            const vec::Vector<T>& fragments_ids,
+            int k,
+            int n)
+            : DecodeContext<T>(gf, fragments_ids, k, n)
+        {
+        }
+
+        std::shared_ptr<vec::XorSchedule<T>> schedule;
+        std::unique_ptr<vec::Matrix<T>> mat;
+    };
+
+    void alloc_sliced_buffers()
+    {
+        if (!sliced) {
+            return;
+        }
+        const unsigned gf_n = 8 * this->word_size;
+        sliced_words = std::make_unique<vec::BitSlicedBuffers<T>>(
+            gf_n, this->n_data, this->pkt_size, this->alloc_policy);
+        sliced_output = std::make_unique<vec::BitSlicedBuffers<T>>(
+            gf_n, this->n_parities, this->pkt_size, this->alloc_policy);
+        sliced_decoded = std::make_unique<vec::BitSlicedBuffers<T>>(
+            gf_n, this->n_data, this->pkt_size, this->alloc_policy);
+    }
+
+    /**
+     * Multiply each column of words of a packet by a matrix
+     *
+     * @param m matrix
+     * @param output receives the `m.get_n_rows()` buffers of products
+     * @param words `m.get_n_cols()` buffers of words
+     */
+    void mul_words(
+        vec::Matrix<T>& m,
+        vec::Buffers<T>& output,
+        vec::Buffers<T>& words)
+    {
+        vec::Vector<T> column(*(this->gf), m.get_n_cols());
+        vec::Vector<T> products(*(this->gf), m.get_n_rows());
+
+        for (size_t j = 0; j < words.get_size(); j++) {
+            for (int i = 0; i < m.get_n_cols(); i++) {
+                column.set(i, words.get(i)[j]);
+            }
+            m.mul(&products, &column);
+            for (int i = 0; i < m.get_n_rows(); i++) {
+                output.get(i)[j] = products.get(i);
+            }
+        }
+    }
 };
 
 } // namespace fec
@@ -34,6 +34,7 @@
 #include <string>
 
 #include "fec_base.h"
+#include "fec_rs_fnt.h"
 #include "fft_2n.h"
 #include "gf_base.h"
 #include "gf_nf4.h"
@@ -42,21 +43,31 @@
 namespace quadiron {
 namespace fec {
 
-/** Reed-Solomon (RS) Erasure code over `n` GF(F<sub>4</sub>). */
+/** Reed-Solomon (RS) Erasure code over `n` GF(F<sub>4</sub>).
+ *
+ * In planar layout, the encoding and decoding of packets do not work on
+ * packed words: each lane of the words of a packet is moved into its own
+ * plane of GF(F<sub>4</sub>) symbols, and each plane is processed by an FNT
+ * over GF(65537). The output is identical to the packed layout.
+ */
 template <typename T>
 class RsNf4 : public FecCode<T> {
   public:
+    using FecCode<T>::decode;
+
     RsNf4(
         unsigned word_size,
         unsigned n_data,
         unsigned n_parities,
-        size_t pkt_size = 8)
+        size_t pkt_size = 8,
+        bool planar = false)
         : FecCode<T>(
               FecType::NON_SYSTEMATIC,
               word_size,
               n_data,
               n_parities,
-              pkt_size)
+              pkt_size),
+          planar(planar)
     {
         this->fec_init();
     }
@@ -110,6 +121,10 @@ class RsNf4 : public FecCode<T> {
         for (unsigned i = 0; i < this->n; i++) {
             this->r_powers->set(i, ngff4->exp(this->r, i));
         }
+
+        if (planar) {
+            init_planar();
+        }
     }
 
     int get_n_outputs() override
@@ -167,17 +182,324 @@ class RsNf4 : public FecCode<T> {
         assert(false);
     }
 
+    bool verify(
+        const std::vector<Properties>&,
+        off_t,
+        vec::Buffers<T>&,
+        vec::Buffers<T>&,
+        vec::Buffers<T>&) override
+    {
+        throw LogicError("RsNf4: verification is not supported");
+    }
+
+    void encode(
+        vec::Buffers<T>& output,
+        std::vector<Properties>& props,
+        off_t offset,
+        vec::Buffers<T>& words) override
+    {
+        if (planar) {
+            encode_planar(output, props, offset, words);
+            return;
+        }
+        for (unsigned i = 0; i < this->n_data; ++i) {
+            T* chunk = words.get(i);
+            for (size_t j = 0; j < this->pkt_size; ++j) {
+                chunk[j] = ngff4->pack(chunk[j]);
+            }
+        }
+        this->fft->fft(output, words);
+        uint64_t timer = this->stats_timer();
+        encode_post_process(output, props, offset);
+        this->stats_lap(
+            Phase::POST_PROCESS, timer, this->n_outputs * this->buf_size);
+    }
+
+    void decode(
+        const DecodeContext<T>& context,
+        vec::Buffers<T>& output,
+        const std::vector<Properties>& props,
+        off_t offset,
+        vec::Buffers<T>& words) override
+    {
+        if (planar) {
+            decode_planar(context, output, props, offset, words);
+            return;
+        }
+        FecCode<T>::decode(context, output, props, offset, words);
+    }
+
   private:
     const gf::Field<uint32_t>* sub_field;
     gf::NF4<T>* ngff4;
     int gf_n;
 
+    bool planar;
+    // FNT over GF(65537) applied on planes
+    std::unique_ptr<fft::Radix2<uint32_t>> planar_fft;
+    // code over GF(65537) used to decode planes
+    std::unique_ptr<RsFnt<uint32_t>> planar_fec;
+    // planes of input symbols, one per lane
+    std::vector<std::unique_ptr<vec::Buffers<uint32_t>>> planes_in;
+    // planes of output symbols, one per lane
+    std::vector<std::unique_ptr<vec::Buffers<uint32_t>>> planes_out;
+    // planes of decoded symbols, one per lane
+    std::vector<std::unique_ptr<vec::Buffers<uint32_t>>> planes_dec;
+    // properties of planes, symbols are restored before decoding
+    std::vector<Properties> planar_props;
+
+    /** Decoding context of packets in planar layout
+     *
+     * It holds the decoding contexts of planes, one per lane as they own
+     * their output.
+     */
+    class PlanarContext : public DecodeContext<T> {
+      public:
+        PlanarContext(
+            const gf::Field<T>& gf,
+            const vec::Vector<T>& fragments_ids,
+            int k,
+            int n)
+            : DecodeContext<T>(gf, fragments_ids, k, n)
+        {
+        }
+
+        // ids of received fragments, referred to by contexts of planes
+        std::unique_ptr<vec::Vector<uint32_t>> ids;
+        std::vector<std::unique_ptr<DecodeContext<uint32_t>>> lanes;
+    };
+
+    void init_planar()
+    {
+        planar_fft = std::make_unique<fft::Radix2<uint32_t>>(
+            *sub_field,
+            this->n,
+            arith::ceil2<int>(this->n_data),
+            this->pkt_size);
+        planar_fec = std::make_unique<RsFnt<uint32_t>>(
+            FecType::NON_SYSTEMATIC,
+            2,
+            this->n_data,
+            this->n_parities,
+            this->pkt_size);
+        assert(planar_fec->n == this->n);
+
+        alloc_planes();
+        planar_props.resize(this->n);
+    }
+
+    /** Allocate the planes of every lane */
+    void alloc_planes()
+    {
+        const simd::AllocPolicy& policy = this->alloc_policy;
+
+        planes_in.clear();
+        planes_out.clear();
+        planes_dec.clear();
+        for (int lane = 0; lane < gf_n; ++lane) {
+            planes_in.push_back(std::make_unique<vec::Buffers<uint32_t>>(
+                this->n_data, this->pkt_size, policy));
+            planes_out.push_back(std::make_unique<vec::Buffers<uint32_t>>(
+                this->n, this->pkt_size, policy));
+            planes_dec.push_back(std::make_unique<vec::Buffers<uint32_t>>(
+                this->n_data, this->pkt_size, policy));
+        }
+    }
+
+    void realloc_buffers() override
+    {
+        FecCode<T>::realloc_buffers();
+        if (planar_fec != nullptr) {
+            planar_fec->set_alloc_policy(this->alloc_policy);
+            alloc_planes();
+        }
+    }
+
+    /** Move lanes of `len` words into their planes */
+    void planar_split(size_t len, const T* src, uint32_t* const* planes)
+    {
+        planar_split_rem(0, len, src, planes);
+    }
+
+    /** Merge `len` symbols of planes into words
+     *
+     * Symbols equal to 65536 are set to zero and marked in `flags`.
+     *
+     * @return true if at least one symbol is marked
+     */
+    bool planar_merge(
+        size_t len,
+        const uint32_t* const* planes,
+        T* dest,
+        uint32_t* flags)
+    {
+        return planar_merge_rem(0, len, planes, dest, flags);
+    }
+
+    void planar_split_rem(
+        size_t start,
+        size_t len,
+        const T* src,
+        uint32_t* const* planes)
+    {
+        for (size_t j = start; j < len; ++j) {
+            T word = src[j];
+            for (int lane = 0; lane < gf_n; ++lane) {
+                planes[lane][j] = static_cast<uint32_t>(word & MASK16);
+                word >>= 16;
+            }
+        }
+    }
+
+    bool planar_merge_rem(
+        size_t start,
+        size_t len,
+        const uint32_t* const* planes,
+        T* dest,
+        uint32_t* flags)
+    {
+        bool marked = false;
+        for (size_t j = start; j < len; ++j) {
+            T word = 0;
+            uint32_t flag = 0;
+            for (int lane = gf_n - 1; lane >= 0; --lane) {
+                const uint32_t symb = planes[lane][j];
+                word = (word << 16) | (symb & MASK16);
+                flag = (flag << 1) | (symb >> 16);
+            }
+            dest[j] = word;
+            flags[j] = flag;
+            marked = marked || (flag != 0);
+        }
+        return marked;
+    }
+
+    void split_words(vec::Buffers<T>& words, unsigned nb)
+    {
+        std::vector<uint32_t*> planes(gf_n);
+        for (unsigned i = 0; i < nb; ++i) {
+            for (int lane = 0; lane < gf_n; ++lane) {
+                planes[lane] = planes_in[lane]->get(i);
+            }
+            planar_split(this->pkt_size, words.get(i), planes.data());
+        }
+    }
+
+    void encode_planar(
+        vec::Buffers<T>& output,
+        std::vector<Properties>& props,
+        off_t offset,
+        vec::Buffers<T>& words)
+    {
+        split_words(words, this->n_data);
+        for (int lane = 0; lane < gf_n; ++lane) {
+            planar_fft->fft(*planes_out[lane], *planes_in[lane]);
+        }
+
+        std::vector<const uint32_t*> planes(gf_n);
+        std::vector<uint32_t> flags(this->pkt_size);
+        for (unsigned i = 0; i < this->code_len; ++i) {
+            for (int lane = 0; lane < gf_n; ++lane) {
+                planes[lane] = planes_out[lane]->get(i);
+            }
+            T* chunk = output.get(i);
+            if (!planar_merge(
+                    this->pkt_size, planes.data(), chunk, flags.data())) {
+                continue;
+            }
+            for (size_t j = 0; j < this->pkt_size; ++j) {
+                if (flags[j]) {
+                    props[i].add(offset + j, flags[j]);
+                }
+            }
+        }
+    }
+
+    /** Build the decoding contexts of planes for given received fragments */
+    std::unique_ptr<PlanarContext>
+    init_planar_context(const vec::Vector<T>& fragments_ids)
+    {
+        auto context = std::make_unique<PlanarContext>(
+            *(this->gf), fragments_ids, this->n_data, this->n);
+
+        context->ids =
+            std::make_unique<vec::Vector<uint32_t>>(*sub_field, this->n_data);
+        for (unsigned i = 0; i < this->n_data; ++i) {
+            context->ids->set(i, fragments_ids.get(i));
+        }
+        for (int lane = 0; lane < gf_n; ++lane) {
+            context->lanes.push_back(planar_fec->init_context_dec(
+                *(context->ids), this->pkt_size, planes_dec[lane].get()));
+        }
+        return context;
+    }
+
+    void decode_planar(
+        const DecodeContext<T>& context,
+        vec::Buffers<T>& output,
+        const std::vector<Properties>& props,
+        off_t offset,
+        vec::Buffers<T>& words)
+    {
+        const vec::Vector<T>& fragments_ids = context.get_fragments_id();
+
+        split_words(words, this->n_data);
+
+        // restore marked symbols
+        const off_t offset_max = offset + this->pkt_size;
+        for (unsigned i = 0; i < this->n_data; ++i) {
+            const int frag_id = fragments_ids.get(i);
+            for (auto const& data : props[frag_id].get_map()) {
+                const off_t loc_offset = data.first;
+                if (loc_offset >= offset && loc_offset < offset_max) {
+                    const size_t j = loc_offset - offset;
+                    for (int lane = 0; lane < gf_n; ++lane) {
+                        if (data.second & (1 << lane)) {
+                            planes_in[lane]->get(i)[j] = 65536;
+                        }
+                    }
+                }
+            }
+        }
+
+        const PlanarContext& planar_context =
+            static_cast<const PlanarContext&>(context);
+        for (int lane = 0; lane < gf_n; ++lane) {
+            planar_fec->decode(
+                *(planar_context.lanes[lane]),
+                *planes_dec[lane],
+                planar_props,
+                offset,
+                *planes_in[lane]);
+        }
+
+        std::vector<const uint32_t*> planes(gf_n);
+        std::vector<uint32_t> flags(this->pkt_size);
+        for (unsigned i = 0; i < this->n_data; ++i) {
+            for (int lane = 0; lane < gf_n; ++lane) {
+                planes[lane] = planes_dec[lane]->get(i);
+            }
+            planar_merge(
+                this->pkt_size, planes.data(), output.get(i), flags.data());
+        }
+    }
+
   protected:
+    /**
+     * Create the decoding context of received fragments
+     *
+     * In planar layout, packets are decoded by the contexts of planes: they
+     * are built, and held by the returned context, instead of a full context
+     * over GF(F<sub>4</sub>).
+     */
     std::unique_ptr<DecodeContext<T>> init_context_dec(
         vec::Vector<T>& fragments_ids,
         size_t size,
         vec::Buffers<T>* output) override
     {
+        if (planar && size > 0) {
+            return init_planar_context(fragments_ids);
+        }
         if (this->inv_r_powers == nullptr) {
             throw LogicError("FEC base: vector (inv_r)^i must be initialized");
         }
@@ -251,22 +573,6 @@ class RsNf4 : public FecCode<T> {
 
     /********** Encoding & Decoding using Buffers **********/
 
-    void encode(
-        vec::Buffers<T>& output,
-        std::vector<Properties>& props,
-        off_t offset,
-        vec::Buffers<T>& words) override
-    {
-        for (unsigned i = 0; i < this->n_data; ++i) {
-            T* chunk = words.get(i);
-            for (size_t j = 0; j < this->pkt_size; ++j) {
-                chunk[j] = ngff4->pack(chunk[j]);
-            }
-        }
-        this->fft->fft(output, words);
-        encode_post_process(output, props, offset);
-    }
-
     void encode_post_process(
         vec::Buffers<T>& output,
         std::vector<Properties>& props,
@@ -351,6 +657,25 @@ class RsNf4 : public FecCode<T> {
     }
 };
 
+#ifdef QUADIRON_USE_SIMD
+
+/* Operations are vectorized by SIMD */
+
+template <>
+void RsNf4<__uint128_t>::planar_split(
+    size_t len,
+    const __uint128_t* src,
+    uint32_t* const* planes);
+
+template <>
+bool RsNf4<__uint128_t>::planar_merge(
+    size_t len,
+    const uint32_t* const* planes,
+    __uint128_t* dest,
+    uint32_t* flags);
+
+#endif // #ifdef QUADIRON_USE_SIMD
+
 } // namespace fec
 } // namespace quadiron
 
@@ -0,0 +1,671 @@
+/* -*- mode: c++ -*- */
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __QUAD_FEC_RS_PIGGYBACK_H__
+#define __QUAD_FEC_RS_PIGGYBACK_H__
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "exceptions.h"
+#include "fec_base.h"
+#include "fec_rs_fnt.h"
+#include "property.h"
+#include "vec_buffers.h"
+#include "vec_cast.h"
+
+namespace quadiron {
+namespace fec {
+
+/** Substripes of fragments read for repairing a lost fragment of a
+ *  RsPiggyback
+ */
+struct PiggybackRepairPlan {
+    /// true if a data fragment is repaired thanks to the piggybacks
+    bool piggyback = false;
+    /// fragments whose first substripe is read
+    std::vector<unsigned> reads_a;
+    /// fragments whose second substripe is read
+    std::vector<unsigned> reads_b;
+};
+
+/** Piggybacked systematic RS code over FNT (Hitchhiker-XOR construction)
+ *
+ * Each packet is split into two substripes \f$a\f$ (first half of words) and
+ * \f$b\f$ (second half), coded by the same systematic RsFnt code. Data
+ * fragments are split into `n_parities - 1` groups \f$S_i\f$, and the
+ * substripe \f$b\f$ of the parity \f$i \geq 1\f$ carries the sum of the
+ * substripes \f$a\f$ of its group:
+ *
+ * \f[
+ *  p_0(b), \quad p_i(b) + \sum_{j \in S_i} a_j
+ * \f]
+ *
+ * The code remains MDS: the substripes \f$a\f$ are decoded first, then
+ * piggybacks are removed to decode the substripes \f$b\f$.
+ *
+ * A lost data fragment \f$j \in S_i\f$ is repaired by reading the
+ * substripes \f$b\f$ of the `n_data - 1` other data fragments and of the
+ * parities 0 and \f$i\f$, along with the substripes \f$a\f$ of the others
+ * fragments of \f$S_i\f$: `n_data + |S_i|` substripes instead of
+ * `2 * n_data` (see plan_repair()).
+ *
+ * Substripes of a fragment, as served for repairs, are the concatenation of
+ * the corresponding halves of its packets (see split_substripes()).
+ *
+ * @note only packets are coded, i.e. `pkt_size` must be even and word-based
+ * operations are not supported
+ */
+template <typename T>
+class RsPiggyback : public RsFnt<T> {
+  public:
+    using FecCode<T>::decode;
+    using FecCode<T>::encode;
+
+    RsPiggyback(
+        unsigned word_size,
+        unsigned n_data,
+        unsigned n_parities,
+        size_t pkt_size = 8)
+        : RsFnt<T>(
+              FecType::SYSTEMATIC,
+              word_size,
+              n_data,
+              n_parities,
+              pkt_size)
+    {
+        if (n_parities < 2) {
+            throw InvalidArgument("piggyback: at least 2 parities needed");
+        }
+        if (pkt_size % 2 != 0) {
+            throw InvalidArgument("piggyback: packet size must be even");
+        }
+        half = pkt_size / 2;
+        sub_fec = std::make_unique<RsFnt<T>>(
+            FecType::SYSTEMATIC, word_size, n_data, n_parities, half);
+        no_props.resize(n_parities);
+    }
+
+    /** Return the parity whose substripe b carries the data fragment */
+    unsigned get_piggyback(unsigned frag_index) const
+    {
+        assert(frag_index < this->n_data);
+
+        return 1 + frag_index * (this->n_parities - 1) / this->n_data;
+    }
+
+    /** Return the data fragments piggybacked on a parity */
+    std::vector<unsigned> get_group(unsigned parity) const
+    {
+        std::vector<unsigned> group;
+        for (unsigned i = 0; i < this->n_data; i++) {
+            if (get_piggyback(i) == parity) {
+                group.push_back(i);
+            }
+        }
+        return group;
+    }
+
+    void encode(
+        vec::Vector<T>&,
+        std::vector<Properties>&,
+        off_t,
+        vec::Vector<T>&) override
+    {
+        throw LogicError("piggyback: only packets are supported");
+    }
+
+    void decode(
+        const DecodeContext<T>&,
+        vec::Vector<T>&,
+        const std::vector<Properties>&,
+        off_t,
+        vec::Vector<T>&) override
+    {
+        throw LogicError("piggyback: only packets are supported");
+    }
+
+    void encode(
+        vec::Buffers<T>& output,
+        std::vector<Properties>& props,
+        off_t offset,
+        vec::Buffers<T>& words) override
+    {
+        RsFnt<T>::encode(output, props, offset, words);
+
+        const T thres = this->gf->card() - 1;
+        for (unsigned i = 1; i < this->n_parities; i++) {
+            T* chunk_b = output.get(i) + half;
+            // marks of the substripe b are re-computed
+            for (size_t j = 0; j < half; j++) {
+                if (chunk_b[j] == thres) {
+                    props[i].remove(offset + half + j);
+                }
+            }
+            for (const unsigned frag : get_group(i)) {
+                add_words(chunk_b, words.get(frag), half);
+            }
+            for (size_t j = 0; j < half; j++) {
+                if (chunk_b[j] == thres) {
+                    props[i].add(offset + half + j, OOR_MARK);
+                }
+            }
+        }
+    }
+
+    void encode_delta(vec::Buffers<T>& output, unsigned frag_index, T* delta)
+        override
+    {
+        RsFnt<T>::encode_delta(output, frag_index, delta);
+
+        T* chunk_b = output.get(get_piggyback(frag_index)) + half;
+        add_words(chunk_b, delta, half);
+    }
+
+    /**
+     * Decode a packet
+     *
+     * Received piggybacked parities are decoded twice: first for the
+     * substripes a, then for the substripes b once piggybacks are removed.
+     */
+    void decode(
+        const DecodeContext<T>& context,
+        vec::Buffers<T>& output,
+        const std::vector<Properties>& props,
+        off_t offset,
+        vec::Buffers<T>& words) override
+    {
+        const vec::Vector<T>& fragments_ids = context.get_fragments_id();
+
+        // out-of-range symbols are restored in `words`
+        RsFnt<T>::decode(context, output, props, offset, words);
+
+        bool piggybacked = false;
+        for (unsigned i = 0; i < this->n_data; i++) {
+            const unsigned frag_id = fragments_ids.get(i);
+            if (frag_id > this->n_data) {
+                const unsigned parity = frag_id - this->n_data;
+                remove_piggybacks(parity, words.get(i), output);
+                piggybacked = true;
+            }
+        }
+        if (piggybacked) {
+            RsFnt<T>::decode(context, output, no_props, offset, words);
+        }
+    }
+
+    bool verify(
+        const std::vector<Properties>& props,
+        off_t offset,
+        vec::Buffers<T>& words,
+        vec::Buffers<T>& tmp,
+        vec::Buffers<T>& syndrome) override
+    {
+        const off_t offset_max = offset + this->pkt_size;
+        const T thres = this->gf->card() - 1;
+        for (unsigned i = 0; i < this->n_parities; ++i) {
+            T* chunk = words.get(this->n_data + i);
+            const std::map<off_t, uint32_t>& marks = props[i].get_map();
+            const auto end = marks.lower_bound(offset_max);
+            for (auto it = marks.lower_bound(offset); it != end; ++it) {
+                if (it->second == OOR_MARK) {
+                    chunk[it->first - offset] = thres;
+                }
+            }
+            if (i > 0) {
+                remove_piggybacks(i, chunk, words);
+            }
+        }
+        return RsFnt<T>::verify(no_props, offset, words, tmp, syndrome);
+    }
+
+    void split_substripes(
+        std::istream& fragment,
+        std::ostream& a,
+        std::ostream& b);
+    PiggybackRepairPlan
+    plan_repair(unsigned lost, const std::vector<bool>& avail) const;
+    bool repair(
+        unsigned lost,
+        const PiggybackRepairPlan& plan,
+        const std::vector<std::istream*>& inputs_a,
+        const std::vector<std::istream*>& inputs_b,
+        const std::vector<Properties>& props,
+        std::ostream* output,
+        Properties* output_props = nullptr);
+
+  private:
+    // number of words of a substripe of a packet
+    size_t half;
+    // code of substripes, i.e. of half packets
+    std::unique_ptr<RsFnt<T>> sub_fec;
+    std::vector<Properties> no_props;
+
+    /* Substripes b are not aligned on SIMD vectors, their words are added
+     * one by one */
+    void add_words(T* dest, const T* src, size_t len) const
+    {
+        for (size_t i = 0; i < len; i++) {
+            dest[i] = this->gf->add(dest[i], src[i]);
+        }
+    }
+
+    void sub_words(T* dest, const T* src, size_t len) const
+    {
+        for (size_t i = 0; i < len; i++) {
+            dest[i] = this->gf->sub(dest[i], src[i]);
+        }
+    }
+
+    /** Remove piggybacks from the substripe b of a parity
+     *
+     * @param parity index of the parity
+     * @param chunk words of a packet of the parity
+     * @param data buffers whose first `n_data` hold the data of the packet
+     */
+    void remove_piggybacks(unsigned parity, T* chunk, vec::Buffers<T>& data)
+    {
+        for (const unsigned frag : get_group(parity)) {
+            sub_words(chunk + half, data.get(frag), half);
+        }
+    }
+
+    /** Read a stream until its end */
+    static std::string read_all(std::istream& stream)
+    {
+        return std::string(
+            std::istreambuf_iterator<char>(stream),
+            std::istreambuf_iterator<char>());
+    }
+
+    void
+    split_props(const Properties& props, Properties& a, Properties& b) const;
+    std::vector<T> read_words(const std::string& buf) const;
+    bool repair_full(
+        unsigned lost,
+        const PiggybackRepairPlan& plan,
+        const std::vector<std::istream*>& inputs_a,
+        const std::vector<std::istream*>& inputs_b,
+        const std::vector<Properties>& props,
+        std::ostream* output,
+        Properties* output_props);
+};
+
+/**
+ * Split a fragment into its substripes
+ *
+ * @param fragment stream of a whole fragment
+ * @param a receives the first halves of packets
+ * @param b receives the second halves of packets
+ */
+template <typename T>
+void RsPiggyback<T>::split_substripes(
+    std::istream& fragment,
+    std::ostream& a,
+    std::ostream& b)
+{
+    const size_t half_size = sub_fec->buf_size;
+    std::vector<char> pkt(this->buf_size);
+
+    while (this->read_pkt(pkt.data(), fragment)) {
+        a.write(pkt.data(), half_size);
+        b.write(pkt.data() + half_size, half_size);
+    }
+}
+
+/** Locate marks of properties of whole packets in substripes */
+template <typename T>
+void RsPiggyback<T>::split_props(
+    const Properties& props,
+    Properties& a,
+    Properties& b) const
+{
+    for (auto const& data : props.get_map()) {
+        const off_t pkt = data.first / this->pkt_size;
+        const off_t col = data.first % this->pkt_size;
+        if (col < static_cast<off_t>(half)) {
+            a.add(pkt * half + col, data.second);
+        } else {
+            b.add(pkt * half + col - half, data.second);
+        }
+    }
+}
+
+/** Read words of a buffer of bytes */
+template <typename T>
+std::vector<T> RsPiggyback<T>::read_words(const std::string& buf) const
+{
+    const size_t n_words = buf.size() / this->word_size;
+    std::vector<T> words(n_words);
+    const std::vector<uint8_t*> src = {
+        reinterpret_cast<uint8_t*>(const_cast<char*>(buf.data()))};
+    const std::vector<T*> dest = {words.data()};
+
+    vec::pack<uint8_t, T>(src, dest, 1, n_words, this->word_size);
+
+    return words;
+}
+
+/**
+ * Plan the repair of a lost fragment
+ *
+ * A data fragment is repaired thanks to its piggyback when the other data
+ * fragments and the parities 0 and get_piggyback() are available. Otherwise
+ * both substripes of `n_data` fragments are read: available data fragments
+ * first, then parities.
+ *
+ * @param lost id of the fragment to repair, parities being numbered from
+ * `n_data`
+ * @param avail availability of each fragment, must be exactly `code_len`
+ *
+ * @return substripes to read, none if the fragment cannot be repaired
+ */
+template <typename T>
+PiggybackRepairPlan
+RsPiggyback<T>::plan_repair(unsigned lost, const std::vector<bool>& avail) const
+{
+    assert(lost < this->code_len);
+    assert(avail.size() == this->code_len);
+
+    PiggybackRepairPlan plan;
+
+    if (lost < this->n_data) {
+        const unsigned parity = get_piggyback(lost);
+        plan.piggyback =
+            avail[this->n_data] && avail[this->n_data + parity];
+        for (unsigned i = 0; i < this->n_data && plan.piggyback; i++) {
+            plan.piggyback = (i == lost) || avail[i];
+        }
+        if (plan.piggyback) {
+            for (unsigned i = 0; i < this->n_data; i++) {
+                if (i != lost) {
+                    plan.reads_b.push_back(i);
+                }
+            }
+            plan.reads_b.push_back(this->n_data);
+            plan.reads_b.push_back(this->n_data + parity);
+            for (const unsigned i : get_group(parity)) {
+                if (i != lost) {
+                    plan.reads_a.push_back(i);
+                }
+            }
+            return plan;
+        }
+    }
+
+    for (unsigned i = 0;
+         i < this->code_len && plan.reads_b.size() < this->n_data;
+         i++) {
+        if (i != lost && avail[i]) {
+            plan.reads_b.push_back(i);
+        }
+    }
+    if (plan.reads_b.size() < this->n_data) {
+        plan.reads_b.clear();
+    }
+    plan.reads_a = plan.reads_b;
+
+    return plan;
+}
+
+/**
+ * Repair a lost fragment
+ *
+ * @param lost id of the fragment to repair
+ * @param plan plan of the repair, see plan_repair()
+ * @param inputs_a must be exactly `code_len`, streams of the substripes a
+ * read by the plan, others are unused
+ * @param inputs_b must be exactly `code_len`, streams of the substripes b
+ * read by the plan, others are unused
+ * @param props properties of parities
+ * @param output receives the repaired fragment
+ * @param output_props receives the properties of a repaired parity
+ *
+ * @return false if the fragment cannot be repaired
+ */
+template <typename T>
+bool RsPiggyback<T>::repair(
+    unsigned lost,
+    const PiggybackRepairPlan& plan,
+    const std::vector<std::istream*>& inputs_a,
+    const std::vector<std::istream*>& inputs_b,
+    const std::vector<Properties>& props,
+    std::ostream* output,
+    Properties* output_props)
+{
+    assert(inputs_a.size() == this->code_len);
+    assert(inputs_b.size() == this->code_len);
+    assert(props.size() == this->n_parities);
+
+    if (plan.reads_b.empty()) {
+        return false;
+    }
+    if (!plan.piggyback) {
+        return repair_full(
+            lost, plan, inputs_a, inputs_b, props, output, output_props);
+    }
+
+    const unsigned n_data = this->n_data;
+    const unsigned parity = get_piggyback(lost);
+
+    std::vector<std::string> subs_a(n_data);
+    std::vector<std::string> subs_b(this->code_len);
+    for (const unsigned i : plan.reads_a) {
+        subs_a[i] = read_all(*inputs_a[i]);
+    }
+    for (const unsigned i : plan.reads_b) {
+        subs_b[i] = read_all(*inputs_b[i]);
+    }
+    const size_t size = subs_b[n_data].size();
+    for (const unsigned i : plan.reads_b) {
+        if (subs_b[i].size() != size) {
+            throw InvalidArgument("piggyback: substripes differ in size");
+        }
+    }
+    for (const unsigned i : plan.reads_a) {
+        if (subs_a[i].size() != size) {
+            throw InvalidArgument("piggyback: substripes differ in size");
+        }
+    }
+
+    std::vector<Properties> props_b(this->n_parities);
+    Properties unused;
+    split_props(props[0], unused, props_b[0]);
+    split_props(props[parity], unused, props_b[parity]);
+
+    // substripe b of the lost fragment, from the parity 0
+    {
+        std::vector<std::istringstream> streams;
+        std::vector<std::istream*> data_bufs(n_data, nullptr);
+        std::vector<std::istream*> parities_bufs(this->n_parities, nullptr);
+        std::ostringstream decoded;
+        std::vector<std::ostream*> decoded_bufs(n_data, nullptr);
+        streams.reserve(n_data);
+        for (unsigned i = 0; i < n_data; i++) {
+            streams.emplace_back(subs_b[(i == lost) ? n_data : i]);
+            if (i == lost) {
+                parities_bufs[0] = &streams.back();
+            } else {
+                data_bufs[i] = &streams.back();
+            }
+        }
+        decoded_bufs[lost] = &decoded;
+        if (!sub_fec->decode_packet(
+                data_bufs, parities_bufs, props_b, decoded_bufs)) {
+            return false;
+        }
+        subs_b[lost] = decoded.str();
+    }
+
+    // substripe b of the piggybacked parity without its piggyback
+    std::vector<Properties> enc_props(this->n_parities);
+    std::string encoded;
+    {
+        std::vector<std::istringstream> streams;
+        std::vector<std::istream*> data_bufs;
+        std::vector<std::ostringstream> outputs(this->n_parities);
+        std::vector<std::ostream*> output_bufs;
+        streams.reserve(n_data);
+        for (unsigned i = 0; i < n_data; i++) {
+            streams.emplace_back(subs_b[i]);
+            data_bufs.push_back(&streams.back());
+        }
+        for (unsigned i = 0; i < this->n_parities; i++) {
+            output_bufs.push_back(&outputs[i]);
+        }
+        sub_fec->encode_packet(data_bufs, output_bufs, enc_props);
+        encoded = outputs[parity].str();
+    }
+
+    // a_lost = piggyback - sum of substripes a of the others of the group
+    const T thres = this->gf->card() - 1;
+    std::vector<T> piggy = read_words(subs_b[n_data + parity]);
+    std::vector<T> plain = read_words(encoded);
+    for (auto const& data : props_b[parity].get_map()) {
+        piggy[data.first] = thres;
+    }
+    for (auto const& data : enc_props[parity].get_map()) {
+        plain[data.first] = thres;
+    }
+    const size_t n_words = piggy.size();
+    sub_words(piggy.data(), plain.data(), n_words);
+    for (const unsigned i : plan.reads_a) {
+        std::vector<T> other = read_words(subs_a[i]);
+        sub_words(piggy.data(), other.data(), n_words);
+    }
+    std::string sub_a(size, 0);
+    const std::vector<T*> src = {piggy.data()};
+    const std::vector<uint8_t*> dest = {
+        reinterpret_cast<uint8_t*>(&sub_a[0])};
+    vec::unpack<T, uint8_t>(src, dest, 1, n_words, this->word_size);
+
+    // interleave substripes by packets
+    const size_t half_size = sub_fec->buf_size;
+    for (size_t pos = 0; pos < size; pos += half_size) {
+        output->write(&sub_a[pos], half_size);
+        output->write(&subs_b[lost][pos], half_size);
+    }
+
+    return true;
+}
+
+/** Repair a fragment by decoding whole fragments, see repair() */
+template <typename T>
+bool RsPiggyback<T>::repair_full(
+    unsigned lost,
+    const PiggybackRepairPlan& plan,
+    const std::vector<std::istream*>& inputs_a,
+    const std::vector<std::istream*>& inputs_b,
+    const std::vector<Properties>& props,
+    std::ostream* output,
+    Properties* output_props)
+{
+    const unsigned n_data = this->n_data;
+    const size_t half_size = sub_fec->buf_size;
+
+    // merge substripes of read fragments
+    std::vector<std::unique_ptr<std::stringstream>> frags(this->code_len);
+    for (const unsigned i : plan.reads_b) {
+        const std::string sub_a = read_all(*inputs_a[i]);
+        const std::string sub_b = read_all(*inputs_b[i]);
+        if (sub_a.size() != sub_b.size() || sub_a.size() % half_size != 0) {
+            throw InvalidArgument("piggyback: substripes differ in size");
+        }
+        frags[i] = std::make_unique<std::stringstream>();
+        for (size_t pos = 0; pos < sub_a.size(); pos += half_size) {
+            frags[i]->write(&sub_a[pos], half_size);
+            frags[i]->write(&sub_b[pos], half_size);
+        }
+    }
+
+    std::vector<std::istream*> data_bufs(n_data, nullptr);
+    std::vector<std::istream*> parities_bufs(this->n_parities, nullptr);
+    for (unsigned i = 0; i < this->code_len; i++) {
+        if (frags[i] != nullptr) {
+            if (i < n_data) {
+                data_bufs[i] = frags[i].get();
+            } else {
+                parities_bufs[i - n_data] = frags[i].get();
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<std::stringstream>> decoded(n_data);
+    std::vector<std::ostream*> decoded_bufs(n_data, nullptr);
+    const bool all_data =
+        std::count(data_bufs.begin(), data_bufs.end(), nullptr) == 0;
+    if (lost < n_data) {
+        decoded_bufs[lost] = output;
+    } else if (!all_data) {
+        for (unsigned i = 0; i < n_data; i++) {
+            decoded[i] = std::make_unique<std::stringstream>();
+            decoded_bufs[i] = decoded[i].get();
+        }
+    }
+    if (!all_data
+        && !this->decode_packet(
+               data_bufs, parities_bufs, props, decoded_bufs)) {
+        return false;
+    }
+    if (lost < n_data) {
+        return true;
+    }
+
+    // re-encode the lost parity
+    const unsigned parity = lost - n_data;
+    std::vector<std::istream*> data(data_bufs);
+    if (!all_data) {
+        for (unsigned i = 0; i < n_data; i++) {
+            data[i] = decoded[i].get();
+        }
+    }
+    std::vector<std::ostringstream> others(this->n_parities);
+    std::vector<std::ostream*> output_bufs;
+    std::vector<Properties> output_parities_props(this->n_parities);
+    for (unsigned i = 0; i < this->n_parities; i++) {
+        output_bufs.push_back((i == parity) ? output : &others[i]);
+    }
+    this->encode_packet(data, output_bufs, output_parities_props);
+    if (output_props != nullptr) {
+        *output_props = output_parities_props[parity];
+    }
+
+    return true;
+}
+
+} // namespace fec
+} // namespace quadiron
+
+#endif
@@ -0,0 +1,440 @@
+/* -*- mode: c++ -*- */
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __QUAD_FEC_SESSION_H__
+#define __QUAD_FEC_SESSION_H__
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "exceptions.h"
+#include "fec_base.h"
+#include "fec_context.h"
+#include "property.h"
+#include "vec_buffers.h"
+#include "vec_cast.h"
+#include "vec_vector.h"
+
+namespace quadiron {
+namespace fec {
+
+/** Incremental encoder of an object received by chunks
+ *
+ * The object is striped over the data fragments by packets: its stripe
+ * \f$s\f$ holds the packet \f$s\f$ of each data fragment, i.e. bytes
+ * \f$[(s k + i) \times buf\_size, (s k + i + 1) \times buf\_size)\f$ go to
+ * the data fragment \f$i\f$.
+ *
+ * Chunks of any size are fed, a stripe is encoded as soon as it is complete
+ * so that only one stripe is buffered. flush() zero-pads and encodes the
+ * last stripe.
+ *
+ * Example:
+ * @code
+ * fec::EncodeSession<uint32_t> session(fec, store_packets);
+ * while (recv(sock, buf, len)) {
+ *     session.feed(buf, len);
+ * }
+ * session.flush();
+ * // store session.get_size() and session.get_props() along fragments
+ * @endcode
+ */
+template <typename T>
+class EncodeSession {
+  public:
+    /** Receive the packets of fragments of an encoded stripe
+     *
+     * `offset` is the location (in words) of the packets in the fragments.
+     * `pkts` holds `buf_size` bytes per fragment: data fragments followed by
+     * parities for SYSTEMATIC, outputs otherwise. They are valid until the
+     * handler returns.
+     */
+    using PacketHandler = std::function<
+        void(off_t offset, const std::vector<const uint8_t*>& pkts)>;
+
+    EncodeSession(FecCode<T>& fec, PacketHandler handler);
+
+    void feed(const uint8_t* data, size_t len);
+    void flush();
+
+    /** Return the number of bytes fed, i.e. the size of the object */
+    size_t get_size() const
+    {
+        return size;
+    }
+
+    /** Return the properties of outputs, they are complete once flushed */
+    const std::vector<Properties>& get_props() const
+    {
+        return props;
+    }
+
+  private:
+    FecCode<T>& fec;
+    PacketHandler handler;
+    const size_t stripe_size;
+    // data packets of the current stripe
+    vec::Buffers<uint8_t> stripe;
+    size_t filled = 0;
+    vec::Buffers<T> words;
+    vec::Buffers<T> output;
+    vec::Buffers<uint8_t> output_char;
+    std::vector<const uint8_t*> pkts;
+    std::vector<Properties> props;
+    off_t offset = 0;
+    size_t size = 0;
+    bool flushed = false;
+
+    void encode_stripe(const std::vector<uint8_t*>& data_pkts);
+};
+
+template <typename T>
+EncodeSession<T>::EncodeSession(FecCode<T>& fec, PacketHandler handler)
+    : fec(fec), handler(std::move(handler)),
+      stripe_size(fec.n_data * fec.buf_size),
+      stripe(fec.n_data, fec.buf_size, fec.get_alloc_policy()),
+      words(fec.n_data, fec.pkt_size, fec.get_alloc_policy()),
+      output(fec.get_n_outputs(), fec.pkt_size, fec.get_alloc_policy()),
+      output_char(fec.get_n_outputs(), fec.buf_size, fec.get_alloc_policy()),
+      props(fec.n_outputs)
+{
+}
+
+/**
+ * Feed the next bytes of the object
+ *
+ * @param data bytes of the object
+ * @param len number of bytes, any
+ *
+ * @throw LogicError if the session is flushed
+ */
+template <typename T>
+void EncodeSession<T>::feed(const uint8_t* data, size_t len)
+{
+    if (flushed) {
+        throw LogicError("FEC session: feed after flush");
+    }
+    size += len;
+
+    const size_t buf_size = fec.buf_size;
+    while (len > 0) {
+        // complete stripes of the chunk are encoded in place
+        if (filled == 0 && len >= stripe_size) {
+            std::vector<uint8_t*> data_pkts(fec.n_data);
+            for (unsigned i = 0; i < fec.n_data; i++) {
+                data_pkts[i] = const_cast<uint8_t*>(data + i * buf_size);
+            }
+            encode_stripe(data_pkts);
+            data += stripe_size;
+            len -= stripe_size;
+            continue;
+        }
+        const size_t row = filled / buf_size;
+        const size_t col = filled % buf_size;
+        const size_t n = std::min(len, buf_size - col);
+        std::memcpy(stripe.get(row) + col, data, n);
+        filled += n;
+        data += n;
+        len -= n;
+        if (filled == stripe_size) {
+            encode_stripe(stripe.get_mem());
+            filled = 0;
+        }
+    }
+}
+
+/**
+ * Encode the last stripe, zero-padded
+ *
+ * Fragments are then `ceil(get_size() / (n_data * buf_size))` packets long.
+ */
+template <typename T>
+void EncodeSession<T>::flush()
+{
+    if (flushed) {
+        return;
+    }
+    if (filled > 0) {
+        const size_t buf_size = fec.buf_size;
+        const size_t row = filled / buf_size;
+        const size_t col = filled % buf_size;
+        std::memset(stripe.get(row) + col, 0, buf_size - col);
+        for (unsigned i = row + 1; i < fec.n_data; i++) {
+            std::memset(stripe.get(i), 0, buf_size);
+        }
+        encode_stripe(stripe.get_mem());
+        filled = 0;
+    }
+    flushed = true;
+}
+
+template <typename T>
+void EncodeSession<T>::encode_stripe(const std::vector<uint8_t*>& data_pkts)
+{
+    const unsigned n_data = fec.n_data;
+    const unsigned n_outputs = fec.n_outputs;
+
+    vec::pack<uint8_t, T>(
+        data_pkts, words.get_mem(), n_data, fec.pkt_size, fec.word_size);
+    fec.encode(output, props, offset, words);
+    vec::unpack<T, uint8_t>(
+        output.get_mem(),
+        output_char.get_mem(),
+        output.get_n(),
+        fec.pkt_size,
+        fec.word_size);
+
+    pkts.clear();
+    if (fec.type == FecType::SYSTEMATIC) {
+        pkts.insert(pkts.end(), data_pkts.begin(), data_pkts.end());
+    }
+    for (unsigned i = 0; i < n_outputs; i++) {
+        pkts.push_back(output_char.get(i));
+    }
+    handler(offset, pkts);
+    offset += fec.pkt_size;
+}
+
+/** Incremental decoder of an object from fragments received by chunks
+ *
+ * Fragments used to decode are selected at creation among the available
+ * ones (see FecCode::decode_packet()), chunks of others are ignored. Chunks
+ * of any size are fed per fragment and a stripe is decoded as soon as a
+ * packet of each selected fragment is received. The object is delivered in
+ * order, without the padding of its last stripe.
+ *
+ * @note the code must not decode other fragments during the session as
+ * some codes keep the state of decoding.
+ */
+template <typename T>
+class DecodeSession {
+  public:
+    /** Receive the next bytes of the object, valid until it returns */
+    using DataHandler = std::function<void(const uint8_t* data, size_t len)>;
+
+    DecodeSession(
+        FecCode<T>& fec,
+        const std::vector<bool>& avail,
+        const std::vector<Properties>& props,
+        size_t size,
+        DataHandler handler);
+
+    /** Return the sorted ids of fragments used to decode */
+    const std::vector<unsigned>& get_fragments() const
+    {
+        return fragments;
+    }
+
+    void feed(unsigned frag_id, const uint8_t* data, size_t len);
+    void flush();
+
+  private:
+    FecCode<T>& fec;
+    std::vector<Properties> props;
+    // remaining bytes of the object
+    size_t size;
+    DataHandler handler;
+    std::vector<unsigned> fragments;
+    // position of fragments in `fragments`, -1 if not selected
+    std::vector<int> position;
+    // received bytes not yet decoded, per selected fragment
+    std::vector<std::vector<uint8_t>> pending;
+    std::unique_ptr<vec::Vector<T>> fragments_ids;
+    std::unique_ptr<vec::Buffers<T>> output;
+    std::unique_ptr<DecodeContext<T>> context;
+    vec::Buffers<T> words;
+    vec::Buffers<uint8_t> output_char;
+    off_t offset = 0;
+    bool all_data = false;
+
+    void decode_stripe(const std::vector<uint8_t*>& pkts);
+};
+
+/**
+ * Create a decoding session
+ *
+ * @param fec code of the fragments
+ * @param avail availability of each fragment: code_len for SYSTEMATIC (data
+ * then parities), n_outputs otherwise
+ * @param props properties of outputs, must be exactly n_outputs
+ * @param size size of the object, see EncodeSession::get_size()
+ * @param handler receives the object
+ *
+ * @throw InvalidArgument if too few fragments are available
+ */
+template <typename T>
+DecodeSession<T>::DecodeSession(
+    FecCode<T>& fec,
+    const std::vector<bool>& avail,
+    const std::vector<Properties>& props,
+    size_t size,
+    DataHandler handler)
+    : fec(fec), props(props), size(size), handler(std::move(handler)),
+      words(fec.n_data, fec.pkt_size, fec.get_alloc_policy()),
+      output_char(fec.n_data, fec.buf_size, fec.get_alloc_policy())
+{
+    const unsigned n_data = fec.n_data;
+    const bool systematic = fec.type == FecType::SYSTEMATIC;
+    const unsigned first_output = systematic ? n_data : 0;
+    assert(avail.size() == first_output + fec.n_outputs);
+    assert(props.size() == fec.n_outputs);
+
+    const std::vector<bool> avail_data(
+        avail.begin(), avail.begin() + first_output);
+    const std::vector<bool> avail_parities(
+        avail.begin() + first_output, avail.end());
+    fragments_ids = std::make_unique<vec::Vector<T>>(fec.get_gf(), n_data);
+    std::vector<unsigned> avail_parity_ids;
+    unsigned avail_data_nb = 0;
+
+    if (!fec.select_fragments(
+            avail_data,
+            avail_parities,
+            *fragments_ids,
+            avail_parity_ids,
+            avail_data_nb)) {
+        throw InvalidArgument("FEC session: too few fragments");
+    }
+    all_data = avail_data_nb == n_data;
+    if (!all_data) {
+        // the decoding state of the codec is re-built for these fragments
+        fec.decode_build();
+        fec.reset_context_dec();
+        output = std::make_unique<vec::Buffers<T>>(
+            n_data, fec.pkt_size, fec.get_alloc_policy());
+        context =
+            fec.init_context_dec(*fragments_ids, fec.pkt_size, output.get());
+    }
+
+    position.assign(avail.size(), -1);
+    for (unsigned i = 0; i < n_data; i++) {
+        const unsigned id = fragments_ids->get(i);
+        fragments.push_back(id);
+        position[id] = i;
+    }
+    pending.resize(n_data);
+}
+
+/**
+ * Feed the next bytes of a fragment
+ *
+ * @param frag_id id of the fragment, as in the availability of the session
+ * @param data bytes of the fragment
+ * @param len number of bytes, any
+ */
+template <typename T>
+void DecodeSession<T>::feed(unsigned frag_id, const uint8_t* data, size_t len)
+{
+    assert(frag_id < position.size());
+
+    if (position[frag_id] < 0) {
+        return;
+    }
+    std::vector<uint8_t>& queue = pending[position[frag_id]];
+    queue.insert(queue.end(), data, data + len);
+
+    const size_t buf_size = fec.buf_size;
+    size_t n_pkts = queue.size() / buf_size;
+    for (const std::vector<uint8_t>& other : pending) {
+        n_pkts = std::min(n_pkts, other.size() / buf_size);
+    }
+    if (n_pkts == 0) {
+        return;
+    }
+
+    std::vector<uint8_t*> pkts(fec.n_data);
+    for (size_t p = 0; p < n_pkts; p++) {
+        for (unsigned i = 0; i < fec.n_data; i++) {
+            pkts[i] = pending[i].data() + p * buf_size;
+        }
+        decode_stripe(pkts);
+    }
+    for (std::vector<uint8_t>& other : pending) {
+        other.erase(other.begin(), other.begin() + n_pkts * buf_size);
+    }
+}
+
+/**
+ * Check that the object is complete
+ *
+ * @throw InvalidArgument if fragments are truncated or differ in size
+ */
+template <typename T>
+void DecodeSession<T>::flush()
+{
+    if (size > 0) {
+        throw InvalidArgument("FEC session: fragments are truncated");
+    }
+    for (const std::vector<uint8_t>& queue : pending) {
+        if (!queue.empty()) {
+            throw InvalidArgument("FEC session: fragments differ in size");
+        }
+    }
+}
+
+template <typename T>
+void DecodeSession<T>::decode_stripe(const std::vector<uint8_t*>& pkts)
+{
+    const unsigned n_data = fec.n_data;
+
+    // packets of the padding are not decoded
+    if (size == 0) {
+        return;
+    }
+
+    std::vector<uint8_t*> data_pkts(pkts);
+    if (!all_data) {
+        vec::pack<uint8_t, T>(
+            pkts, words.get_mem(), n_data, fec.pkt_size, fec.word_size);
+        fec.decode(*context, *output, props, offset, words);
+        vec::unpack<T, uint8_t>(
+            output->get_mem(),
+            output_char.get_mem(),
+            n_data,
+            fec.pkt_size,
+            fec.word_size);
+        data_pkts = output_char.get_mem();
+    }
+    for (unsigned i = 0; i < n_data && size > 0; i++) {
+        const size_t len = std::min(size, fec.buf_size);
+        handler(data_pkts[i], len);
+        size -= len;
+    }
+    offset += fec.pkt_size;
+}
+
+} // namespace fec
+} // namespace quadiron
+
+#endif
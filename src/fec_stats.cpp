@@ -0,0 +1,201 @@
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <array>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <set>
+
+#include "fec_stats.h"
+
+namespace quadiron {
+namespace fec {
+
+namespace {
+
+const std::array<const char*, NB_PHASES> phase_names = {
+    "read",
+    "checksum",
+    "pack",
+    "context",
+    "encode",
+    "post_process",
+    "decode",
+    "unpack",
+    "write",
+};
+
+class ThreadStats;
+
+/** Statistics of running threads and of exited ones */
+struct Registry {
+    std::mutex lock;
+    std::set<ThreadStats*> threads;
+    Stats exited;
+};
+
+Registry& registry()
+{
+    static Registry reg;
+    return reg;
+}
+
+/** Statistics of a thread, merged into the registry when it exits */
+class ThreadStats {
+  public:
+    ThreadStats()
+    {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> guard(reg.lock);
+        reg.threads.insert(this);
+    }
+
+    ~ThreadStats()
+    {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> guard(reg.lock);
+        std::lock_guard<std::mutex> self_guard(lock);
+        reg.exited += stats;
+        reg.threads.erase(this);
+    }
+
+    std::mutex lock;
+    Stats stats;
+};
+
+ThreadStats& thread_stats()
+{
+    thread_local ThreadStats stats;
+    return stats;
+}
+
+} // namespace
+
+const char* phase_name(Phase phase)
+{
+    return phase_names.at(static_cast<unsigned>(phase));
+}
+
+double Stats::get_ns(Phase phase) const
+{
+    if (wall_cycles == 0) {
+        return 0;
+    }
+    return static_cast<double>(get(phase).cycles)
+           * static_cast<double>(wall_ns) / static_cast<double>(wall_cycles);
+}
+
+double Stats::get_cycles_per_byte(Phase phase) const
+{
+    const PhaseStats& stats = get(phase);
+    if (stats.bytes == 0) {
+        return 0;
+    }
+    return static_cast<double>(stats.cycles)
+           / static_cast<double>(stats.bytes);
+}
+
+Stats& Stats::operator+=(const Stats& other)
+{
+    for (unsigned i = 0; i < NB_PHASES; ++i) {
+        phases[i].cycles += other.phases[i].cycles;
+        phases[i].bytes += other.phases[i].bytes;
+        phases[i].calls += other.phases[i].calls;
+    }
+    wall_cycles += other.wall_cycles;
+    wall_ns += other.wall_ns;
+    n_ops += other.n_ops;
+    return *this;
+}
+
+std::ostream& operator<<(std::ostream& os, const Stats& stats)
+{
+    os << "operations: " << stats.n_ops << ", wall time (us): "
+       << stats.wall_ns / 1000 << '\n';
+    os << std::left << std::setw(14) << "phase" << std::right
+       << std::setw(12) << "calls" << std::setw(16) << "bytes"
+       << std::setw(16) << "cycles" << std::setw(12) << "cycles/B"
+       << std::setw(12) << "time (us)" << '\n';
+    for (unsigned i = 0; i < NB_PHASES; ++i) {
+        const Phase phase = static_cast<Phase>(i);
+        const PhaseStats& phase_stats = stats.get(phase);
+        if (phase_stats.calls == 0) {
+            continue;
+        }
+        os << std::left << std::setw(14) << phase_name(phase) << std::right
+           << std::setw(12) << phase_stats.calls << std::setw(16)
+           << phase_stats.bytes << std::setw(16) << phase_stats.cycles
+           << std::setw(12) << std::fixed << std::setprecision(3)
+           << stats.get_cycles_per_byte(phase) << std::setw(12)
+           << std::setprecision(1) << stats.get_ns(phase) / 1000 << '\n';
+    }
+    os.unsetf(std::ios_base::floatfield);
+    return os;
+}
+
+void add_thread_stats(const Stats& stats)
+{
+    ThreadStats& thread = thread_stats();
+    std::lock_guard<std::mutex> guard(thread.lock);
+    thread.stats += stats;
+}
+
+Stats get_thread_stats()
+{
+    ThreadStats& thread = thread_stats();
+    std::lock_guard<std::mutex> guard(thread.lock);
+    return thread.stats;
+}
+
+Stats get_all_threads_stats()
+{
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    Stats total = reg.exited;
+    for (ThreadStats* thread : reg.threads) {
+        std::lock_guard<std::mutex> thread_guard(thread->lock);
+        total += thread->stats;
+    }
+    return total;
+}
+
+void reset_all_threads_stats()
+{
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    reg.exited.reset();
+    for (ThreadStats* thread : reg.threads) {
+        std::lock_guard<std::mutex> thread_guard(thread->lock);
+        thread->stats.reset();
+    }
+}
+
+} // namespace fec
+} // namespace quadiron
@@ -0,0 +1,158 @@
+/* -*- mode: c++ -*- */
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __QUAD_FEC_STATS_H__
+#define __QUAD_FEC_STATS_H__
+
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+
+namespace quadiron {
+namespace fec {
+
+/** Phases of the encoding and decoding loops. */
+enum class Phase : unsigned {
+    /** Read packets from input streams */
+    READ = 0,
+    /** Compute checksums of fragments */
+    CHECKSUM,
+    /** Cast bytes of packets to words */
+    PACK,
+    /** Build or fetch a decoding context */
+    CONTEXT,
+    /** Encode a packet (includes `POST_PROCESS`) */
+    ENCODE,
+    /** Mark out-of-range values of encoded packets */
+    POST_PROCESS,
+    /** Decode a packet */
+    DECODE,
+    /** Cast words to bytes of packets */
+    UNPACK,
+    /** Write packets to output streams */
+    WRITE,
+    END,
+};
+
+static constexpr unsigned NB_PHASES = static_cast<unsigned>(Phase::END);
+
+const char* phase_name(Phase phase);
+
+struct PhaseStats {
+    uint64_t cycles = 0;
+    uint64_t bytes = 0;
+    uint64_t calls = 0;
+};
+
+/** Per-phase statistics of encoding and decoding operations.
+ *
+ * Phases are measured in cycles of the hardware timer. The wall-clock time
+ * of whole operations is also recorded, so that the time spent in a phase
+ * can be estimated without reading the clock in the packet loops.
+ */
+class Stats {
+  public:
+    void reset()
+    {
+        phases.fill(PhaseStats());
+        wall_cycles = 0;
+        wall_ns = 0;
+        n_ops = 0;
+    }
+
+    inline void add(Phase phase, uint64_t cycles, uint64_t bytes)
+    {
+        PhaseStats& stats = phases[static_cast<unsigned>(phase)];
+        stats.cycles += cycles;
+        stats.bytes += bytes;
+        stats.calls++;
+    }
+
+    /** Account a whole operation */
+    inline void add_op(uint64_t cycles, uint64_t ns)
+    {
+        wall_cycles += cycles;
+        wall_ns += ns;
+        n_ops++;
+    }
+
+    const PhaseStats& get(Phase phase) const
+    {
+        return phases[static_cast<unsigned>(phase)];
+    }
+
+    uint64_t get_wall_cycles() const
+    {
+        return wall_cycles;
+    }
+
+    uint64_t get_wall_ns() const
+    {
+        return wall_ns;
+    }
+
+    uint64_t get_n_ops() const
+    {
+        return n_ops;
+    }
+
+    /** Estimated time spent in a phase, in nanoseconds */
+    double get_ns(Phase phase) const;
+
+    /** Average number of cycles per byte of a phase */
+    double get_cycles_per_byte(Phase phase) const;
+
+    Stats& operator+=(const Stats& other);
+
+  private:
+    std::array<PhaseStats, NB_PHASES> phases;
+    uint64_t wall_cycles = 0;
+    uint64_t wall_ns = 0;
+    uint64_t n_ops = 0;
+
+    friend std::ostream& operator<<(std::ostream& os, const Stats& stats);
+};
+
+/** Accumulate statistics to those of the calling thread */
+void add_thread_stats(const Stats& stats);
+
+/** Statistics accumulated by the calling thread */
+Stats get_thread_stats();
+
+/** Sum of statistics accumulated by all threads, including exited ones */
+Stats get_all_threads_stats();
+
+/** Reset statistics of all threads */
+void reset_all_threads_stats();
+
+} // namespace fec
+} // namespace quadiron
+
+#endif
@@ -30,6 +30,7 @@
  */
 
 #include "fec_rs_fnt.h"
+#include "fec_rs_nf4.h"
 
 /*
  * The file includes specialized operations used by FEC classes
@@ -93,6 +94,35 @@ void RsFnt<uint32_t>::encode_post_process(
     }
 }
 
+template <>
+void RsNf4<__uint128_t>::planar_split(
+    size_t len,
+    const __uint128_t* src,
+    uint32_t* const* planes)
+{
+    size_t start = 0;
+    if (gf_n == 4) {
+        start = simd::planar_split(len, src, planes);
+    }
+    planar_split_rem(start, len, src, planes);
+}
+
+template <>
+bool RsNf4<__uint128_t>::planar_merge(
+    size_t len,
+    const uint32_t* const* planes,
+    __uint128_t* dest,
+    uint32_t* flags)
+{
+    size_t start = 0;
+    bool marked = false;
+    if (gf_n == 4) {
+        start = simd::planar_merge(len, planes, dest, flags, marked);
+    }
+    const bool rem_marked = planar_merge_rem(start, len, planes, dest, flags);
+    return marked || rem_marked;
+}
+
 } // namespace fec
 } // namespace quadiron
 
@@ -63,6 +63,25 @@ void Radix2<uint16_t>::butterfly_ct_two_layers_step(
     }
 }
 
+template <>
+void Radix2<uint16_t>::butterfly_ct_three_layers_step(
+    vec::Buffers<uint16_t>& buf,
+    unsigned start,
+    unsigned m)
+{
+    uint16_t coefs[7];
+    ct_three_layers_coefs(start, m, coefs);
+
+    // perform vector operations
+    simd::butterfly_ct_three_layers_step(
+        buf, coefs, start, m, simd_vec_len, card);
+
+    // for last elements, perform as non-SIMD method
+    if (simd_trailing_len > 0) {
+        butterfly_ct_three_layers_step_slow(buf, start, m, simd_offset);
+    }
+}
+
 template <>
 void Radix2<uint16_t>::butterfly_ct_step(
     vec::Buffers<uint16_t>& buf,
@@ -114,6 +133,45 @@ void Radix2<uint16_t>::butterfly_gs_step_simple(
     }
 }
 
+template <>
+void Radix2<uint16_t>::butterfly_gs_two_layers_step(
+    vec::Buffers<uint16_t>& buf,
+    unsigned start,
+    unsigned m)
+{
+    const uint16_t r1 = inv_W->get(start * this->n / m / 4);
+    const uint16_t r2 = inv_W->get((start + m) * this->n / m / 4);
+    const uint16_t r3 = inv_W->get(start * this->n / m / 2);
+
+    // perform vector operations
+    simd::butterfly_gs_two_layers_step(
+        buf, r1, r2, r3, start, m, simd_vec_len, card);
+
+    // for last elements, perform as non-SIMD method
+    if (simd_trailing_len > 0) {
+        butterfly_gs_two_layers_step_slow(buf, start, m, simd_offset);
+    }
+}
+
+template <>
+void Radix2<uint16_t>::butterfly_gs_three_layers_step(
+    vec::Buffers<uint16_t>& buf,
+    unsigned start,
+    unsigned m)
+{
+    uint16_t coefs[7];
+    gs_three_layers_coefs(start, m, coefs);
+
+    // perform vector operations
+    simd::butterfly_gs_three_layers_step(
+        buf, coefs, start, m, simd_vec_len, card);
+
+    // for last elements, perform as non-SIMD method
+    if (simd_trailing_len > 0) {
+        butterfly_gs_three_layers_step_slow(buf, start, m, simd_offset);
+    }
+}
+
 template <>
 void Radix2<uint32_t>::butterfly_ct_two_layers_step(
     vec::Buffers<uint32_t>& buf,
@@ -135,6 +193,25 @@ void Radix2<uint32_t>::butterfly_ct_two_layers_step(
     }
 }
 
+template <>
+void Radix2<uint32_t>::butterfly_ct_three_layers_step(
+    vec::Buffers<uint32_t>& buf,
+    unsigned start,
+    unsigned m)
+{
+    uint32_t coefs[7];
+    ct_three_layers_coefs(start, m, coefs);
+
+    // perform vector operations
+    simd::butterfly_ct_three_layers_step(
+        buf, coefs, start, m, simd_vec_len, card);
+
+    // for last elements, perform as non-SIMD method
+    if (simd_trailing_len > 0) {
+        butterfly_ct_three_layers_step_slow(buf, start, m, simd_offset);
+    }
+}
+
 template <>
 void Radix2<uint32_t>::butterfly_ct_step(
     vec::Buffers<uint32_t>& buf,
@@ -186,6 +263,45 @@ void Radix2<uint32_t>::butterfly_gs_step_simple(
     }
 }
 
+template <>
+void Radix2<uint32_t>::butterfly_gs_two_layers_step(
+    vec::Buffers<uint32_t>& buf,
+    unsigned start,
+    unsigned m)
+{
+    const uint32_t r1 = inv_W->get(start * this->n / m / 4);
+    const uint32_t r2 = inv_W->get((start + m) * this->n / m / 4);
+    const uint32_t r3 = inv_W->get(start * this->n / m / 2);
+
+    // perform vector operations
+    simd::butterfly_gs_two_layers_step(
+        buf, r1, r2, r3, start, m, simd_vec_len, card);
+
+    // for last elements, perform as non-SIMD method
+    if (simd_trailing_len > 0) {
+        butterfly_gs_two_layers_step_slow(buf, start, m, simd_offset);
+    }
+}
+
+template <>
+void Radix2<uint32_t>::butterfly_gs_three_layers_step(
+    vec::Buffers<uint32_t>& buf,
+    unsigned start,
+    unsigned m)
+{
+    uint32_t coefs[7];
+    gs_three_layers_coefs(start, m, coefs);
+
+    // perform vector operations
+    simd::butterfly_gs_three_layers_step(
+        buf, coefs, start, m, simd_vec_len, card);
+
+    // for last elements, perform as non-SIMD method
+    if (simd_trailing_len > 0) {
+        butterfly_gs_three_layers_step_slow(buf, start, m, simd_offset);
+    }
+}
+
 } // namespace fft
 } // namespace quadiron
 
@@ -98,6 +98,10 @@ class Radix2 : public FourierTransform<T> {
         vec::Buffers<T>& buf,
         unsigned start,
         unsigned m);
+    void butterfly_ct_three_layers_step(
+        vec::Buffers<T>& buf,
+        unsigned start,
+        unsigned m);
     void butterfly_gs_step(
         vec::Buffers<T>& buf,
         T r,
@@ -110,6 +114,16 @@ class Radix2 : public FourierTransform<T> {
         unsigned start,
         unsigned m,
         unsigned step);
+    void butterfly_gs_two_layers_step(
+        vec::Buffers<T>& buf,
+        unsigned start,
+        unsigned m);
+    void butterfly_gs_three_layers_step(
+        vec::Buffers<T>& buf,
+        unsigned start,
+        unsigned m);
+    void ct_three_layers_coefs(unsigned start, unsigned m, T* coefs);
+    void gs_three_layers_coefs(unsigned start, unsigned m, T* coefs);
 
     // Only used for non-vectorized elements
     void butterfly_ct_two_layers_step_slow(
@@ -117,6 +131,21 @@ class Radix2 : public FourierTransform<T> {
         unsigned start,
         unsigned m,
         size_t offset = 0);
+    void butterfly_ct_three_layers_step_slow(
+        vec::Buffers<T>& buf,
+        unsigned start,
+        unsigned m,
+        size_t offset = 0);
+    void butterfly_gs_two_layers_step_slow(
+        vec::Buffers<T>& buf,
+        unsigned start,
+        unsigned m,
+        size_t offset = 0);
+    void butterfly_gs_three_layers_step_slow(
+        vec::Buffers<T>& buf,
+        unsigned start,
+        unsigned m,
+        size_t offset = 0);
     void butterfly_ct_step_slow(
         vec::Buffers<T>& buf,
         T coef,
@@ -374,15 +403,24 @@ void Radix2<T>::fft(vec::Buffers<T>& output, vec::Buffers<T>& input)
         }
     }
 
+    // ------------------------
+    // Three layers at a time
+    // ------------------------
+    unsigned m = group_len;
+    const unsigned end = len / 2;
+    for (; 8 * m <= len; m <<= 3) {
+        for (unsigned j = 0; j < m; ++j) {
+            butterfly_ct_three_layers_step(output, j, m);
+        }
+    }
     // ----------------------
     // Two layers at a time
     // ----------------------
-    unsigned m = group_len;
-    const unsigned end = len / 2;
-    for (; m < end; m <<= 2) {
+    if (m < end) {
         for (unsigned j = 0; j < m; ++j) {
             butterfly_ct_two_layers_step(output, j, m);
         }
+        m <<= 2;
     }
     if (m < len) {
         assert(m == end);
@@ -467,6 +505,79 @@ void Radix2<T>::butterfly_ct_two_layers_step_slow(
     butterfly_ct_step_slow(buf, r3, start + m, 2 * m, step, offset);
 }
 
+/**
+ * Butterfly CT on three layers at a time
+ *
+ * For each group of eight buffers (X0, ..., X7) where Xk = buf[i + k * m]
+ * First layer: butterfly on (Xk, Xk+1) for even k
+ *      coef W[start * n / (2 * m)]
+ * Second layer: butterfly on (Xk, Xk+2) for k = 0, 1, 4, 5
+ *      coef W[(start + (k % 2) * m) * n / (4 * m)]
+ * Third layer: butterfly on (Xk, Xk+4) for k = 0, ..., 3
+ *      coef W[(start + k * m) * n / (8 * m)]
+ *
+ * @param buf - working buffers
+ * @param start - index of buffer among `m` ones
+ * @param m - current group size
+ */
+template <typename T>
+void Radix2<T>::butterfly_ct_three_layers_step(
+    vec::Buffers<T>& buf,
+    unsigned start,
+    unsigned m)
+{
+    butterfly_ct_three_layers_step_slow(buf, start, m);
+}
+
+/**
+ * Coefficients of the butterflies CT on three layers, in the order of
+ * butterfly_ct_three_layers_step()
+ *
+ * @param start - index of buffer among `m` ones
+ * @param m - current group size
+ * @param coefs - receives the seven coefficients
+ */
+template <typename T>
+void Radix2<T>::ct_three_layers_coefs(unsigned start, unsigned m, T* coefs)
+{
+    coefs[0] = vec_W[start * this->n / m / 2];
+    for (unsigned k = 0; k < 2; ++k) {
+        coefs[1 + k] = vec_W[(start + k * m) * this->n / m / 4];
+    }
+    for (unsigned k = 0; k < 4; ++k) {
+        coefs[3 + k] = vec_W[(start + k * m) * this->n / m / 8];
+    }
+}
+
+template <typename T>
+void Radix2<T>::butterfly_ct_three_layers_step_slow(
+    vec::Buffers<T>& buf,
+    unsigned start,
+    unsigned m,
+    size_t offset)
+{
+    const unsigned step = m << 3;
+    T coefs[7];
+    ct_three_layers_coefs(start, m, coefs);
+
+    // First layer
+    for (unsigned k = 0; k < 8; k += 2) {
+        butterfly_ct_step_slow(buf, coefs[0], start + k * m, m, step, offset);
+    }
+    // Second layer
+    for (unsigned k = 0; k < 2; ++k) {
+        const T r = coefs[1 + k];
+        butterfly_ct_step_slow(buf, r, start + k * m, 2 * m, step, offset);
+        butterfly_ct_step_slow(
+            buf, r, start + (k + 4) * m, 2 * m, step, offset);
+    }
+    // Third layer
+    for (unsigned k = 0; k < 4; ++k) {
+        butterfly_ct_step_slow(
+            buf, coefs[3 + k], start + k * m, 4 * m, step, offset);
+    }
+}
+
 template <typename T>
 void Radix2<T>::butterfly_ct_step_slow(
     vec::Buffers<T>& buf,
@@ -535,14 +646,18 @@ void Radix2<T>::fft_inv(vec::Buffers<T>& output, vec::Buffers<T>& input)
         }
     }
 
-    // Next, normal butterlfy GS is performed
-    for (; m >= 1; m /= 2) {
-        unsigned doubled_m = 2 * m;
-        for (unsigned j = 0; j < m; ++j) {
-            const T r = inv_W->get(j * len / doubled_m);
-            butterfly_gs_step(output, r, j, m, doubled_m);
+    // Next, normal butterlfy GS is performed, three layers at a time
+    for (; m >= 4; m /= 8) {
+        const unsigned low_m = m / 4;
+        for (unsigned j = 0; j < low_m; ++j) {
+            butterfly_gs_three_layers_step(output, j, low_m);
         }
     }
+    if (m == 2) {
+        butterfly_gs_two_layers_step(output, 0, 1);
+    } else if (m == 1) {
+        butterfly_gs_step(output, inv_W->get(0), 0, 1, 2);
+    }
 
     // 2nd reversion of elements of output to return its natural order
     bit_rev_permute(output);
@@ -596,6 +711,122 @@ void Radix2<T>::butterfly_gs_step_slow(
     }
 }
 
+/**
+ * Butterfly GS on two layers at a time
+ *
+ * For each quadruple
+ * (P, Q, R, S) = (buf[i], buf[i + m], buf[i + 2 * m], buf[i + 3 * m])
+ * First layer: butterfly on (P, R) and (Q, S) for step = 4 * m
+ *      coef r1 = inv_W[start * n / (4 * m)]
+ *      coef r2 = inv_W[(start + m) * n / (4 * m)]
+ * Second layer: butterfly on (P, Q) and (R, S) for step = 2 * m
+ *      coef r3 = inv_W[start * n / (2 * m)]
+ *
+ * @param buf - working buffers
+ * @param start - index of buffer among `m` ones
+ * @param m - current group size, i.e. of the last layer
+ */
+template <typename T>
+void Radix2<T>::butterfly_gs_two_layers_step(
+    vec::Buffers<T>& buf,
+    unsigned start,
+    unsigned m)
+{
+    butterfly_gs_two_layers_step_slow(buf, start, m);
+}
+
+template <typename T>
+void Radix2<T>::butterfly_gs_two_layers_step_slow(
+    vec::Buffers<T>& buf,
+    unsigned start,
+    unsigned m,
+    size_t offset)
+{
+    const unsigned step = m << 2;
+    // First layer
+    const T r1 = inv_W->get(start * this->n / m / 4);
+    butterfly_gs_step_slow(buf, r1, start, 2 * m, step, offset);
+    const T r2 = inv_W->get((start + m) * this->n / m / 4);
+    butterfly_gs_step_slow(buf, r2, start + m, 2 * m, step, offset);
+    // Second layer
+    const T r3 = inv_W->get(start * this->n / m / 2);
+    butterfly_gs_step_slow(buf, r3, start, m, step, offset);
+    butterfly_gs_step_slow(buf, r3, start + 2 * m, m, step, offset);
+}
+
+/**
+ * Butterfly GS on three layers at a time
+ *
+ * For each group of eight buffers (X0, ..., X7) where Xk = buf[i + k * m]
+ * First layer: butterfly on (Xk, Xk+4) for k = 0, ..., 3
+ *      coef inv_W[(start + k * m) * n / (8 * m)]
+ * Second layer: butterfly on (Xk, Xk+2) for k = 0, 1, 4, 5
+ *      coef inv_W[(start + (k % 2) * m) * n / (4 * m)]
+ * Third layer: butterfly on (Xk, Xk+1) for even k
+ *      coef inv_W[start * n / (2 * m)]
+ *
+ * @param buf - working buffers
+ * @param start - index of buffer among `m` ones
+ * @param m - current group size, i.e. of the last layer
+ */
+template <typename T>
+void Radix2<T>::butterfly_gs_three_layers_step(
+    vec::Buffers<T>& buf,
+    unsigned start,
+    unsigned m)
+{
+    butterfly_gs_three_layers_step_slow(buf, start, m);
+}
+
+/**
+ * Coefficients of the butterflies GS on three layers, in the order of
+ * butterfly_gs_three_layers_step()
+ *
+ * @param start - index of buffer among `m` ones
+ * @param m - current group size, i.e. of the last layer
+ * @param coefs - receives the seven coefficients
+ */
+template <typename T>
+void Radix2<T>::gs_three_layers_coefs(unsigned start, unsigned m, T* coefs)
+{
+    for (unsigned k = 0; k < 4; ++k) {
+        coefs[k] = inv_W->get((start + k * m) * this->n / m / 8);
+    }
+    for (unsigned k = 0; k < 2; ++k) {
+        coefs[4 + k] = inv_W->get((start + k * m) * this->n / m / 4);
+    }
+    coefs[6] = inv_W->get(start * this->n / m / 2);
+}
+
+template <typename T>
+void Radix2<T>::butterfly_gs_three_layers_step_slow(
+    vec::Buffers<T>& buf,
+    unsigned start,
+    unsigned m,
+    size_t offset)
+{
+    const unsigned step = m << 3;
+    T coefs[7];
+    gs_three_layers_coefs(start, m, coefs);
+
+    // First layer
+    for (unsigned k = 0; k < 4; ++k) {
+        butterfly_gs_step_slow(
+            buf, coefs[k], start + k * m, 4 * m, step, offset);
+    }
+    // Second layer
+    for (unsigned k = 0; k < 2; ++k) {
+        const T r = coefs[4 + k];
+        butterfly_gs_step_slow(buf, r, start + k * m, 2 * m, step, offset);
+        butterfly_gs_step_slow(
+            buf, r, start + (k + 4) * m, 2 * m, step, offset);
+    }
+    // Third layer
+    for (unsigned k = 0; k < 8; k += 2) {
+        butterfly_gs_step_slow(buf, coefs[6], start + k * m, m, step, offset);
+    }
+}
+
 template <typename T>
 void Radix2<T>::butterfly_gs_step_simple_slow(
     vec::Buffers<T>& buf,
@@ -635,6 +866,11 @@ void Radix2<uint16_t>::butterfly_ct_two_layers_step(
     unsigned start,
     unsigned m);
 template <>
+void Radix2<uint16_t>::butterfly_ct_three_layers_step(
+    vec::Buffers<uint16_t>& buf,
+    unsigned start,
+    unsigned m);
+template <>
 void Radix2<uint16_t>::butterfly_ct_step(
     vec::Buffers<uint16_t>& buf,
     uint16_t r,
@@ -655,6 +891,16 @@ void Radix2<uint16_t>::butterfly_gs_step_simple(
     unsigned start,
     unsigned m,
     unsigned step);
+template <>
+void Radix2<uint16_t>::butterfly_gs_two_layers_step(
+    vec::Buffers<uint16_t>& buf,
+    unsigned start,
+    unsigned m);
+template <>
+void Radix2<uint16_t>::butterfly_gs_three_layers_step(
+    vec::Buffers<uint16_t>& buf,
+    unsigned start,
+    unsigned m);
 
 template <>
 void Radix2<uint32_t>::butterfly_ct_two_layers_step(
@@ -662,6 +908,11 @@ void Radix2<uint32_t>::butterfly_ct_two_layers_step(
     unsigned start,
     unsigned m);
 template <>
+void Radix2<uint32_t>::butterfly_ct_three_layers_step(
+    vec::Buffers<uint32_t>& buf,
+    unsigned start,
+    unsigned m);
+template <>
 void Radix2<uint32_t>::butterfly_ct_step(
     vec::Buffers<uint32_t>& buf,
     uint32_t r,
@@ -682,6 +933,16 @@ void Radix2<uint32_t>::butterfly_gs_step_simple(
     unsigned start,
     unsigned m,
     unsigned step);
+template <>
+void Radix2<uint32_t>::butterfly_gs_two_layers_step(
+    vec::Buffers<uint32_t>& buf,
+    unsigned start,
+    unsigned m);
+template <>
+void Radix2<uint32_t>::butterfly_gs_three_layers_step(
+    vec::Buffers<uint32_t>& buf,
+    unsigned start,
+    unsigned m);
 
 #endif // #ifdef QUADIRON_USE_SIMD
 
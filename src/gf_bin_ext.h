@@ -31,14 +31,42 @@
 #ifndef __QUAD_GF_BIN_EXT_H__
 #define __QUAD_GF_BIN_EXT_H__
 
+#include <climits>
 #include <limits>
 
+#ifdef __PCLMUL__
+#include <x86intrin.h>
+#endif
+
 #include "exceptions.h"
 #include "gf_base.h"
 
 namespace quadiron {
 namespace gf {
 
+#ifdef __PCLMUL__
+
+/** Carry-less product of two polynomials of degree less than 64 */
+inline __m128i clmul_64(uint64_t a, uint64_t b)
+{
+    return _mm_clmulepi64_si128(
+        _mm_cvtsi64_si128(static_cast<long long>(a)),
+        _mm_cvtsi64_si128(static_cast<long long>(b)),
+        0x00);
+}
+
+inline uint64_t clmul_64_lo(__m128i x)
+{
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(x));
+}
+
+inline uint64_t clmul_64_hi(__m128i x)
+{
+    return static_cast<uint64_t>(_mm_extract_epi64(x, 1));
+}
+
+#endif // #ifdef __PCLMUL__
+
 /// An extension Galois Field extended from GF(2).
 template <typename T>
 class BinExtension : public gf::Field<T> {
@@ -55,6 +83,7 @@ class BinExtension : public gf::Field<T> {
     T inv(T a) const override;
     T exp(T a, T b) const override;
     T log(T a, T b) const override;
+    void mul_coef_to_buf(T a, T* src, T* dest, size_t len) const override;
     void hadamard_mul(int n, T* x, T* y) const override;
 
     BinExtension(BinExtension&&) = default;
@@ -71,8 +100,16 @@ class BinExtension : public gf::Field<T> {
     T*** gfsplit = nullptr; // (n/4-1)*256*256 elements
     T* mask = nullptr;
     bool restricted = false;
+    // exponents of the low terms of the irreducible polynomial
+    unsigned reduce_exps[4];
+    unsigned reduce_nb = 0;
     T _mul_log(T a, T b) const;
     T _mul_split(T a, T b) const;
+#ifdef __PCLMUL__
+    T _mul_clmul(T a, T b) const;
+    template <typename W>
+    W _clmul_reduce(W hi, W lo) const;
+#endif
     T _mul_by_two(T x) const;
     T _shift_left(T x, T shift) const;
     T _deg_of(T x, T max_deg) const;
@@ -80,6 +117,7 @@ class BinExtension : public gf::Field<T> {
     T _div_by_inv(T a, T b) const;
     T _inv_by_div(T a) const;
     T _inv_ext_gcd(T a) const;
+    T _inv_itoh_tsujii(T a) const;
     int mul_type;
     int div_type;
     int inv_type;
@@ -89,6 +127,7 @@ class BinExtension : public gf::Field<T> {
     void init_mask();
     void setup_tables();
     void setup_split_tables();
+    void setup_reduction();
 
     template <typename Class, typename... Args>
     friend Class create(Args... args);
@@ -97,9 +136,9 @@ class BinExtension : public gf::Field<T> {
     friend std::unique_ptr<Base> alloc(Args... args);
 };
 
-enum MulType { MUL_LOG_TAB, SPLIT_8_8 };
+enum MulType { MUL_LOG_TAB, SPLIT_8_8, CLMUL };
 enum DivType { DIV_LOG_TAB, DIV_BY_INV };
-enum InvType { INV_BY_DIV, INV_EXT_GCD };
+enum InvType { INV_BY_DIV, INV_EXT_GCD, INV_ITOH_TSUJII };
 
 template <typename T>
 BinExtension<T>::BinExtension(T n) : gf::Field<T>(2, n)
@@ -163,12 +202,19 @@ BinExtension<T>::BinExtension(T n) : gf::Field<T>(2, n)
         this->div_type = DIV_LOG_TAB;
         this->inv_type = INV_BY_DIV;
     } else {
+        this->div_type = DIV_BY_INV;
+#ifdef __PCLMUL__
+        // carry-less multiplication, no table is needed
+        this->mul_type = CLMUL;
+        this->inv_type = INV_ITOH_TSUJII;
+        setup_reduction();
+#else
         // currently only for (8, 8) split
         this->mul_type = SPLIT_8_8;
-        this->div_type = DIV_BY_INV;
         this->inv_type = INV_EXT_GCD;
         this->sgroup_nb = n / 8;
         setup_split_tables();
+#endif
     }
 }
 
@@ -346,6 +392,25 @@ void BinExtension<T>::setup_split_tables(void)
     }
 }
 
+/**
+ * Setup the reduction of carry-less products
+ *
+ * The irreducible polynomials of GF(2^32), GF(2^64) and GF(2^128) are
+ * pentanomials x^n + r(x) where r(x) has a low degree. As x^n = r(x), the
+ * high half of a product is folded by shifting it by the exponents of r(x).
+ */
+template <typename T>
+void BinExtension<T>::setup_reduction(void)
+{
+    reduce_nb = 0;
+    for (unsigned e = 0; e < 8; e++) {
+        if ((primitive_poly >> e) & 1) {
+            assert(reduce_nb < 4);
+            reduce_exps[reduce_nb++] = e;
+        }
+    }
+}
+
 template <typename T>
 inline T BinExtension<T>::card(void) const
 {
@@ -394,6 +459,10 @@ inline T BinExtension<T>::mul(T a, T b) const
     assert(check(b));
 
     switch (mul_type) {
+#ifdef __PCLMUL__
+    case CLMUL:
+        return _mul_clmul(a, b);
+#endif
     case SPLIT_8_8:
         return _mul_split(a, b);
     case MUL_LOG_TAB:
@@ -442,6 +511,79 @@ inline T BinExtension<T>::_mul_split(T a, T b) const
     return product;
 }
 
+#ifdef __PCLMUL__
+
+/**
+ * Reduce a product `hi * x^n + lo` modulo the irreducible polynomial
+ *
+ * @param hi high half of the product
+ * @param lo low half of the product
+ * @return product modulo the irreducible polynomial
+ */
+template <typename T>
+template <typename W>
+inline W BinExtension<T>::_clmul_reduce(W hi, W lo) const
+{
+    const unsigned bits = sizeof(W) * CHAR_BIT;
+    W fold = 0;
+    W carry = 0;
+
+    // hi * r(x), whose terms of degree n or more are carried
+    for (unsigned i = 0; i < reduce_nb; i++) {
+        const unsigned e = reduce_exps[i];
+        fold ^= hi << e;
+        if (e > 0) {
+            carry ^= hi >> (bits - e);
+        }
+    }
+    // carry * r(x) is of degree less than n
+    for (unsigned i = 0; i < reduce_nb; i++) {
+        fold ^= carry << reduce_exps[i];
+    }
+    return lo ^ fold;
+}
+
+template <typename T>
+inline T BinExtension<T>::_mul_clmul(T a, T b) const
+{
+    assert(check(a));
+    assert(check(b));
+
+    if (n == 32) {
+        const uint64_t p = clmul_64_lo(
+            clmul_64(static_cast<uint64_t>(a), static_cast<uint64_t>(b)));
+        return static_cast<T>(_clmul_reduce<uint32_t>(
+            static_cast<uint32_t>(p >> 32), static_cast<uint32_t>(p)));
+    }
+    if (n == 64) {
+        const __m128i p =
+            clmul_64(static_cast<uint64_t>(a), static_cast<uint64_t>(b));
+        return static_cast<T>(
+            _clmul_reduce<uint64_t>(clmul_64_hi(p), clmul_64_lo(p)));
+    }
+
+    // n == 128: schoolbook product of 64-bit halves
+    const __uint128_t _a = a;
+    const __uint128_t _b = b;
+    const uint64_t a0 = static_cast<uint64_t>(_a);
+    const uint64_t a1 = static_cast<uint64_t>(_a >> 64);
+    const uint64_t b0 = static_cast<uint64_t>(_b);
+    const uint64_t b1 = static_cast<uint64_t>(_b >> 64);
+
+    const __m128i p00 = clmul_64(a0, b0);
+    const __m128i p11 = clmul_64(a1, b1);
+    const __m128i pm = _mm_xor_si128(clmul_64(a0, b1), clmul_64(a1, b0));
+
+    const __uint128_t lo = (__uint128_t(clmul_64_hi(p00) ^ clmul_64_lo(pm))
+                            << 64)
+                           | clmul_64_lo(p00);
+    const __uint128_t hi = (__uint128_t(clmul_64_hi(p11)) << 64)
+                           | (clmul_64_lo(p11) ^ clmul_64_hi(pm));
+    return static_cast<T>(_clmul_reduce<__uint128_t>(hi, lo));
+}
+
+#endif // #ifdef __PCLMUL__
+
 template <typename T>
 inline T BinExtension<T>::div(T a, T b) const
 {
@@ -463,8 +605,7 @@ inline T BinExtension<T>::_div_by_inv(T a, T b) const
     assert(check(a));
     assert(check(b));
 
-    T inv = _inv_ext_gcd(b);
-    return mul(a, inv);
+    return mul(a, inv(b));
 }
 
 template <typename T>
@@ -492,6 +633,8 @@ inline T BinExtension<T>::inv(T a) const
     assert(check(a));
 
     switch (inv_type) {
+    case INV_ITOH_TSUJII:
+        return _inv_itoh_tsujii(a);
     case INV_EXT_GCD:
         return _inv_ext_gcd(a);
     case INV_BY_DIV:
@@ -581,10 +724,71 @@ inline T BinExtension<T>::_inv_ext_gcd(T x) const
     return g[a];
 }
 
+/**
+ * Itoh-Tsujii inversion
+ *
+ * a^-1 = a^(2^n - 2) = b(n - 1)^2 where b(k) = a^(2^k - 1) is computed by
+ * following the binary expansion of n - 1 with
+ *  b(2k) = b(k)^(2^k) * b(k)
+ *  b(k + 1) = b(k)^2 * a
+ * i.e. n squarings and about 2 * log2(n) multiplications.
+ */
+template <typename T>
+inline T BinExtension<T>::_inv_itoh_tsujii(T a) const
+{
+    assert(check(a));
+
+    const T m = n - 1;
+    int top = 0;
+    while ((m >> (top + 1)) != 0) {
+        top++;
+    }
+
+    T b = a;
+    T k = 1;
+    for (int i = top - 1; i >= 0; i--) {
+        T t = b;
+        for (T j = 0; j < k; j++) {
+            t = mul(t, t);
+        }
+        b = mul(t, b);
+        k *= 2;
+        if ((m >> i) & 1) {
+            b = mul(mul(b, b), a);
+            k++;
+        }
+    }
+    return mul(b, b);
+}
+
+template <typename T>
+inline void
+BinExtension<T>::mul_coef_to_buf(T a, T* src, T* dest, size_t len) const
+{
+#ifdef __PCLMUL__
+    if (mul_type == CLMUL) {
+        for (size_t i = 0; i < len; i++) {
+            dest[i] = _mul_clmul(a, src[i]);
+        }
+        return;
+    }
+#endif
+    for (size_t i = 0; i < len; i++) {
+        dest[i] = mul(a, src[i]);
+    }
+}
+
 template <typename T>
 inline void BinExtension<T>::hadamard_mul(int n, T* x, T* y) const
 {
-    // this->hadamard_mul(n, x, y);
+#ifdef __PCLMUL__
+    if (mul_type == CLMUL) {
+        for (int i = 0; i < n; i++) {
+            x[i] = _mul_clmul(x[i], y[i]);
+        }
+        return;
+    }
+#endif
     for (int i = 0; i < n; i++) {
         x[i] = mul(x[i], y[i]);
     }
@@ -0,0 +1,162 @@
+/* -*- mode: c++ -*- */
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __QUAD_MEMBUF_H__
+#define __QUAD_MEMBUF_H__
+
+#include <climits>
+#include <cstddef>
+#include <ios>
+#include <streambuf>
+#include <vector>
+
+namespace quadiron {
+
+/** Stream buffer whose bytes are contiguous in memory, e.g. a file mapping
+ *
+ * Packets of streams using such a buffer are packed from and unpacked to
+ * memory in place by `FecCode::encode_packet` and `FecCode::decode_packet`,
+ * instead of being copied to intermediate buffers.
+ *
+ * The get area can be seeked (e.g. by `FecCode::decode_range`), the position
+ * in the put area can only be told.
+ */
+class MemoryStreambuf : public std::streambuf {
+  public:
+    /** Get the next `len` bytes of the get area and skip them
+     *
+     * @param len number of bytes
+     * @return a pointer to the bytes, nullptr if less than `len` bytes are
+     * available
+     */
+    char* get_bytes(size_t len)
+    {
+        if (static_cast<size_t>(egptr() - gptr()) < len) {
+            return nullptr;
+        }
+        char* bytes = gptr();
+        gbump(static_cast<int>(len));
+        return bytes;
+    }
+
+    /** Reserve the next `len` bytes of the put area and commit them
+     *
+     * @param len number of bytes
+     * @return a pointer to the bytes to write, nullptr if there is no room
+     * for `len` bytes
+     */
+    char* put_bytes(size_t len)
+    {
+        if (static_cast<size_t>(epptr() - pptr()) < len && !reserve(len)) {
+            return nullptr;
+        }
+        char* bytes = pptr();
+        pbump(static_cast<int>(len));
+        return bytes;
+    }
+
+  protected:
+    pos_type seekoff(
+        off_type off,
+        std::ios_base::seekdir dir,
+        std::ios_base::openmode which) override
+    {
+        const pos_type error(off_type(-1));
+
+        if (which == std::ios_base::out) {
+            if (off != 0 || dir != std::ios_base::cur) {
+                return error;
+            }
+            return pos_type(pptr() - pbase());
+        }
+        if (which != std::ios_base::in) {
+            return error;
+        }
+        off_type pos = off;
+        if (dir == std::ios_base::cur) {
+            pos += gptr() - eback();
+        } else if (dir == std::ios_base::end) {
+            pos += egptr() - eback();
+        }
+        if (pos < 0 || pos > egptr() - eback()) {
+            return error;
+        }
+        setg(eback(), eback() + pos, egptr());
+        return pos_type(pos);
+    }
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override
+    {
+        return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+
+    /** Make room for at least `len` more bytes in the put area
+     *
+     * @param len number of bytes
+     * @return false if the put area can not be extended
+     */
+    virtual bool reserve(size_t len)
+    {
+        (void)len;
+        return false;
+    }
+
+    /** Set the put area to [`begin`, `end`) with `used` bytes already put */
+    void set_put_area(char* begin, char* end, size_t used)
+    {
+        setp(begin, end);
+        // pbump() only takes an int
+        for (; used > INT_MAX; used -= INT_MAX) {
+            pbump(INT_MAX);
+        }
+        pbump(static_cast<int>(used));
+    }
+};
+
+/** Memory buffers of streams, nullptr for streams not backed by memory
+ *
+ * @param streams input or output streams, possibly nullptr
+ */
+template <typename Stream>
+std::vector<MemoryStreambuf*>
+get_memory_bufs(const std::vector<Stream*>& streams)
+{
+    std::vector<MemoryStreambuf*> bufs(streams.size(), nullptr);
+    for (size_t i = 0; i < streams.size(); ++i) {
+        if (streams[i] != nullptr) {
+            bufs[i] = dynamic_cast<MemoryStreambuf*>(streams[i]->rdbuf());
+        }
+    }
+    return bufs;
+}
+
+} // namespace quadiron
+
+#endif
@@ -33,8 +33,8 @@
 
 #include <cstdint>
 #include <iosfwd>
+#include <map>
 #include <string>
-#include <unordered_map>
 
 #include <sys/types.h>
 
@@ -46,7 +46,7 @@ static constexpr unsigned OOR_MARK = 1;
  *
  * A property carries extra-information (whose interpretation is left to the
  * reader) related to a specific value (identified by its location).
- * It wraps a map whose each element is a key/value where
+ * It wraps a map, ordered by location, whose each element is a key/value where
  *  - key indicates the location of symbol whose value should be adjusted
  *  - value indicates value that could be used to adjust the symbol value
  * For prime fields, value is always 1.
@@ -65,18 +65,23 @@ class Properties {
         return it != props.end() ? it->second : 0;
     }
 
+    inline void remove(const off_t loc)
+    {
+        props.erase(loc);
+    }
+
     inline void clear()
     {
         props.clear();
     }
 
-    std::unordered_map<off_t, uint32_t> const get_map() const
+    const std::map<off_t, uint32_t>& get_map() const
     {
         return props;
     }
 
   private:
-    std::unordered_map<off_t, uint32_t> props;
+    std::map<off_t, uint32_t> props;
 
     friend std::istream& operator>>(std::istream& is, Properties& props);
     friend std::ostream& operator<<(std::ostream& os, const Properties& props);
@@ -38,12 +38,15 @@
 
 #include "build_info.h"
 #include "fec_base.h"
+#include "fec_lrc.h"
 #include "fec_rs_fnt.h"
 #include "fec_rs_gf2n.h"
 #include "fec_rs_gf2n_fft.h"
 #include "fec_rs_gf2n_fft_add.h"
 #include "fec_rs_gfp_fft.h"
 #include "fec_rs_nf4.h"
+#include "fec_rs_piggyback.h"
+#include "fec_session.h"
 
 /** Return the version string of QuadIron.
  *
@@ -0,0 +1,203 @@
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#include <climits>
+#include <vector>
+
+#include "simd/allocator.h"
+
+namespace quadiron {
+namespace simd {
+
+namespace {
+
+// From <linux/mempolicy.h>, not always installed.
+constexpr int MPOL_BIND_MODE = 2;
+
+std::size_t get_page_size()
+{
+    static const std::size_t page_size = sysconf(_SC_PAGESIZE);
+    return page_size;
+}
+
+inline std::size_t round_up(std::size_t size, std::size_t align)
+{
+    return (size + align - 1) / align * align;
+}
+
+inline bool uses_huge_pages(std::size_t size, const AllocPolicy& policy)
+{
+    return policy.huge_pages != HugePages::NONE && size >= HUGE_PAGE_SIZE;
+}
+
+/// Length of the mapping backing an allocation of `size` bytes.
+inline std::size_t get_map_size(std::size_t size, const AllocPolicy& policy)
+{
+    if (uses_huge_pages(size, policy)) {
+        return round_up(size, HUGE_PAGE_SIZE);
+    }
+    return round_up(size, get_page_size());
+}
+
+void* map_anonymous(std::size_t size, int extra_flags = 0)
+{
+    void* addr = mmap(
+        nullptr,
+        size,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | extra_flags,
+        -1,
+        0);
+    return addr == MAP_FAILED ? nullptr : addr;
+}
+
+/// Map `size` bytes at an address aligned on `align` bytes.
+void* map_aligned(std::size_t size, std::size_t align)
+{
+    uint8_t* raw = static_cast<uint8_t*>(map_anonymous(size + align));
+    if (raw == nullptr) {
+        return nullptr;
+    }
+    const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(raw);
+    uint8_t* aligned = raw + (round_up(address, align) - address);
+
+    // Give back the unused head and tail of the mapping.
+    if (aligned != raw) {
+        munmap(raw, aligned - raw);
+    }
+    const std::size_t tail = (raw + size + align) - (aligned + size);
+    if (tail != 0) {
+        munmap(aligned + size, tail);
+    }
+    return aligned;
+}
+
+/// Bind `[addr, addr + size)` to the node of the calling thread.
+bool bind_to_local_node(void* addr, std::size_t size)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+    constexpr unsigned BITS = sizeof(unsigned long) * CHAR_BIT;
+    const unsigned node = current_numa_node();
+    std::vector<unsigned long> mask(node / BITS + 1, 0);
+    mask[node / BITS] = 1UL << (node % BITS);
+    // The kernel reads `maxnode - 1` bits of the mask.
+    const unsigned long maxnode = mask.size() * BITS + 1;
+    return syscall(
+               SYS_mbind, addr, size, MPOL_BIND_MODE, mask.data(), maxnode, 0)
+           == 0;
+#else
+    (void)addr;
+    (void)size;
+    return false;
+#endif
+}
+
+/// Fault every page in from the calling thread.
+void touch_pages(void* addr, std::size_t size)
+{
+    const std::size_t page_size = get_page_size();
+    volatile uint8_t* bytes = static_cast<uint8_t*>(addr);
+    for (std::size_t i = 0; i < size; i += page_size) {
+        bytes[i] = 0;
+    }
+}
+
+} // namespace
+
+unsigned current_numa_node()
+{
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+        return node;
+    }
+#endif
+    return 0;
+}
+
+void* map_memory(std::size_t size, const AllocPolicy& policy)
+{
+    const std::size_t map_size = get_map_size(size, policy);
+    void* addr = nullptr;
+
+    if (uses_huge_pages(size, policy)) {
+#ifdef MAP_HUGETLB
+        if (policy.huge_pages == HugePages::EXPLICIT) {
+            addr = map_anonymous(map_size, MAP_HUGETLB);
+        }
+#endif
+        // Either transparent huge pages were requested or the hugetlbfs
+        // pool is exhausted.
+        if (addr == nullptr) {
+            addr = map_aligned(map_size, HUGE_PAGE_SIZE);
+#ifdef MADV_HUGEPAGE
+            if (addr != nullptr) {
+                madvise(addr, map_size, MADV_HUGEPAGE);
+            }
+#endif
+        }
+    } else {
+        addr = map_anonymous(map_size);
+    }
+    if (addr == nullptr) {
+        return nullptr;
+    }
+
+    switch (policy.numa) {
+    case NumaPlacement::NONE:
+        break;
+    case NumaPlacement::BIND_LOCAL:
+        if (bind_to_local_node(addr, map_size)) {
+            break;
+        }
+        // No NUMA support: first touch is the best we can do.
+        touch_pages(addr, map_size);
+        break;
+    case NumaPlacement::FIRST_TOUCH:
+        touch_pages(addr, map_size);
+        break;
+    }
+    return addr;
+}
+
+void unmap_memory(void* addr, std::size_t size, const AllocPolicy& policy)
+{
+    munmap(addr, get_map_size(size, policy));
+}
+
+} // namespace simd
+} // namespace quadiron
@@ -34,6 +34,9 @@
  *
  * This allocator always returns memory that is suitably aligned to be loaded
  * efficiently by a Register object.
+ *
+ * An optional allocation policy lets large buffers be backed by huge pages
+ * and/or placed on the NUMA node of the allocating thread.
  */
 
 #ifndef __QUAD_SIMD_SIMD_ALLOCATOR_H__
@@ -42,6 +45,8 @@
 #include <cassert>
 #include <cstdint>
 #include <limits>
+#include <new>
+#include <type_traits>
 
 #include "simd/definitions.h"
 
@@ -60,11 +65,96 @@ inline bool addr_is_aligned(const T* addr)
     return (address & (ALIGNMENT - 1)) == 0;
 }
 
+/// Huge page backing of the allocated memory.
+enum class HugePages {
+    /// Regular pages (default).
+    NONE = 0,
+
+    /// Transparent huge pages: 2 MiB-aligned mapping advised with
+    /// `MADV_HUGEPAGE`.
+    TRANSPARENT,
+
+    /// Explicit huge pages from the hugetlbfs pool (`MAP_HUGETLB`), falling
+    /// back on transparent huge pages when the pool is empty.
+    EXPLICIT,
+};
+
+/// NUMA placement of the allocated memory.
+enum class NumaPlacement {
+    /// Let the kernel decide (default).
+    NONE = 0,
+
+    /// Fault every page in from the allocating thread, so that the default
+    /// local policy places it on the node of that thread.
+    FIRST_TOUCH,
+
+    /// Bind the memory (`mbind`) to the node of the allocating thread.
+    BIND_LOCAL,
+};
+
+/** Allocation policy of an AlignedAllocator.
+ *
+ * With the default policy, memory comes from the regular heap. Otherwise
+ * memory is mapped directly from the kernel: huge pages are only used for
+ * allocations of at least `HUGE_PAGE_SIZE` bytes (smaller ones would waste
+ * most of the page), while the NUMA placement applies to any size.
+ */
+struct AllocPolicy {
+    HugePages huge_pages = HugePages::NONE;
+    NumaPlacement numa = NumaPlacement::NONE;
+
+    AllocPolicy() = default;
+    AllocPolicy(HugePages huge_pages, NumaPlacement numa = NumaPlacement::NONE)
+        : huge_pages(huge_pages), numa(numa)
+    {
+    }
+
+    bool is_default() const
+    {
+        return huge_pages == HugePages::NONE && numa == NumaPlacement::NONE;
+    }
+};
+
+inline bool operator==(const AllocPolicy& lhs, const AllocPolicy& rhs)
+{
+    return lhs.huge_pages == rhs.huge_pages && lhs.numa == rhs.numa;
+}
+
+inline bool operator!=(const AllocPolicy& lhs, const AllocPolicy& rhs)
+{
+    return !(lhs == rhs);
+}
+
+/// Size of a (transparent or explicit) huge page.
+static constexpr std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+/** Map `size` bytes from the kernel according to `policy`.
+ *
+ * @param size - number of bytes to map
+ * @param policy - a non-default allocation policy
+ * @return a page-aligned address, or `nullptr` on failure
+ */
+void* map_memory(std::size_t size, const AllocPolicy& policy);
+
+/** Unmap memory returned by `map_memory`.
+ *
+ * @param addr - address returned by `map_memory`
+ * @param size - size given to `map_memory`
+ * @param policy - policy given to `map_memory`
+ */
+void unmap_memory(void* addr, std::size_t size, const AllocPolicy& policy);
+
+/// NUMA node of the calling thread (0 if unknown).
+unsigned current_numa_node();
+
 /** Custom allocator to take advantage of SIMD processing.
  *
  * This allocator always return memory that is suitably aligned for the current
  * SIMD instruction set. Thanks to this property, you can safely use the aligned
  * load from the Register class in order to increase performance.
+ *
+ * The only state of the allocator is its AllocPolicy: memory must be released
+ * by an allocator comparing equal to the one that allocated it.
  */
 template <typename T>
 class AlignedAllocator {
@@ -72,12 +162,21 @@ class AlignedAllocator {
     using value_type = T;
 
     AlignedAllocator() noexcept {}
-    // No state, => nothing to copy.
+    explicit AlignedAllocator(const AllocPolicy& policy) noexcept
+        : policy(policy)
+    {
+    }
     template <class U>
-    AlignedAllocator(AlignedAllocator<U> const& /* other */) noexcept
+    AlignedAllocator(AlignedAllocator<U> const& other) noexcept
+        : policy(other.get_policy())
     {
     }
 
+    const AllocPolicy& get_policy() const noexcept
+    {
+        return policy;
+    }
+
     value_type* allocate(std::size_t count)
     {
         // Guard against overflow!
@@ -85,6 +184,15 @@ class AlignedAllocator {
             throw std::bad_alloc();
         }
 
+        // Mapped memory is page-aligned, hence SIMD-aligned.
+        if (!policy.is_default()) {
+            void* ptr = map_memory(count * sizeof(value_type), policy);
+            if (ptr == nullptr) {
+                throw std::bad_alloc();
+            }
+            return static_cast<value_type*>(ptr);
+        }
+
         // No SIMD: default allocator is good enough!
         if (INSTRUCTION_SET == InstructionSet::NONE) {
             return static_cast<value_type*>(
@@ -113,8 +221,15 @@ class AlignedAllocator {
         return reinterpret_cast<value_type*>(aligned_ptr);
     }
 
-    void deallocate(value_type* ptr, std::size_t /* count */) noexcept
+    void deallocate(value_type* ptr, std::size_t count) noexcept
     {
+        if (!policy.is_default()) {
+            if (ptr != nullptr) {
+                unmap_memory(ptr, count * sizeof(value_type), policy);
+            }
+            return;
+        }
+
         // No SIMD: default allocator is good enough!
         if (INSTRUCTION_SET == InstructionSet::NONE) {
             ::operator delete(ptr);
@@ -137,18 +252,23 @@ class AlignedAllocator {
         return (max_size - ALIGNMENT) / sizeof(value_type);
     }
 
-    // Our allocator is stateless.
+    // The policy follows the memory it allocated.
     using propagate_on_container_copy_assignment = std::true_type;
     using propagate_on_container_move_assignment = std::true_type;
     using propagate_on_container_swap = std::true_type;
+
+  private:
+    AllocPolicy policy;
 };
 
 template <class T, class U>
-bool operator==(AlignedAllocator<T> const&, AlignedAllocator<U> const&) noexcept
+bool operator==(
+    AlignedAllocator<T> const& x,
+    AlignedAllocator<U> const& y) noexcept
 {
-    // Our allocator is stateless: Any instance of our allocator can deallocate
-    // the memory from another instance.
-    return true;
+    // Instances sharing the same policy can deallocate the memory from each
+    // other.
+    return x.get_policy() == y.get_policy();
 }
 
 template <class T, class U>
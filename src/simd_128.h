@@ -67,6 +67,11 @@ const VecType ONE_U32 = _mm_set1_epi32(1);
 // NOLINTNEXTLINE(cert-err58-cpp)
 const VecType MASK8_LO = _mm_set1_epi16(0x80);
 
+/** Bit of each 16-bit lane, used to expand lane masks stored as bit masks */
+// NOLINTNEXTLINE(cert-err58-cpp)
+const VecType LANE_BITS_U16 = _mm_setr_epi16(
+    0x0001, 0x0002, 0x0004, 0x0008, 0x0010, 0x0020, 0x0040, 0x0080);
+
 /* ============= Essential Operations for SSE w/ both u16 & u32 ============ */
 
 inline VecType load_to_reg(VecType* address)
@@ -86,6 +91,15 @@ inline VecType bit_xor(VecType x, VecType y)
 {
     return _mm_xor_si128(x, y);
 }
+inline VecType bit_or(VecType x, VecType y)
+{
+    return _mm_or_si128(x, y);
+}
+/** @return (NOT x) AND y */
+inline VecType bit_andnot(VecType x, VecType y)
+{
+    return _mm_andnot_si128(x, y);
+}
 inline uint16_t msb8_mask(VecType x)
 {
     return _mm_movemask_epi8(x);
@@ -183,6 +197,41 @@ inline VecType min<uint16_t>(VecType x, VecType y)
     return _mm_min_epu16(x, y);
 }
 
+/* ============= Operations on 16-bit lanes for SSE ============= */
+
+inline VecType mulhi_u16(VecType x, VecType y)
+{
+    return _mm_mulhi_epu16(x, y);
+}
+inline VecType sub_sat_u16(VecType x, VecType y)
+{
+    return _mm_subs_epu16(x, y);
+}
+
+inline VecType expand_mask_u16(uint32_t bits)
+{
+    const VecType b = _mm_set1_epi16(static_cast<int16_t>(bits));
+    return _mm_cmpeq_epi16(_mm_and_si128(b, LANE_BITS_U16), LANE_BITS_U16);
+}
+inline uint32_t compress_mask_u16(VecType mask)
+{
+    const VecType bytes = _mm_packs_epi16(mask, ZERO);
+    return static_cast<uint32_t>(_mm_movemask_epi8(bytes)) & 0xFF;
+}
+
+inline VecType pack_u32_to_u16(VecType lo, VecType hi)
+{
+    return _mm_packus_epi32(lo, hi);
+}
+inline VecType unpack_lo_u16_to_u32(VecType x)
+{
+    return _mm_cvtepu16_epi32(x);
+}
+inline VecType unpack_hi_u16_to_u32(VecType x)
+{
+    return _mm_unpackhi_epi16(x, ZERO);
+}
+
 } // namespace simd
 } // namespace quadiron
 
@@ -80,6 +80,12 @@ const VecType ONE_U32 = _mm256_set1_epi32(1);
 // NOLINTNEXTLINE(cert-err58-cpp)
 const VecType MASK8_LO = _mm256_set1_epi16(0x80);
 
+/** Bit of each 16-bit lane, used to expand lane masks stored as bit masks */
+// NOLINTNEXTLINE(cert-err58-cpp)
+const VecType LANE_BITS_U16 = _mm256_setr_epi16(
+    0x0001, 0x0002, 0x0004, 0x0008, 0x0010, 0x0020, 0x0040, 0x0080,
+    0x0100, 0x0200, 0x0400, 0x0800, 0x1000, 0x2000, 0x4000, -0x8000);
+
 /* ============= Essential Operations for AVX2 w/ both u16 & u32 ============ */
 
 inline VecType load_to_reg(VecType* address)
@@ -99,6 +105,15 @@ inline VecType bit_xor(VecType x, VecType y)
 {
     return _mm256_xor_si256(x, y);
 }
+inline VecType bit_or(VecType x, VecType y)
+{
+    return _mm256_or_si256(x, y);
+}
+/** @return (NOT x) AND y */
+inline VecType bit_andnot(VecType x, VecType y)
+{
+    return _mm256_andnot_si256(x, y);
+}
 inline uint32_t msb8_mask(VecType x)
 {
     return _mm256_movemask_epi8(x);
@@ -196,6 +211,43 @@ inline VecType min<uint16_t>(VecType x, VecType y)
     return _mm256_min_epu16(x, y);
 }
 
+/* ============= Operations on 16-bit lanes for AVX2 ============= */
+
+inline VecType mulhi_u16(VecType x, VecType y)
+{
+    return _mm256_mulhi_epu16(x, y);
+}
+inline VecType sub_sat_u16(VecType x, VecType y)
+{
+    return _mm256_subs_epu16(x, y);
+}
+
+inline VecType expand_mask_u16(uint32_t bits)
+{
+    const VecType b = _mm256_set1_epi16(static_cast<int16_t>(bits));
+    return _mm256_cmpeq_epi16(
+        _mm256_and_si256(b, LANE_BITS_U16), LANE_BITS_U16);
+}
+inline uint32_t compress_mask_u16(VecType mask)
+{
+    const VecType bytes = _mm256_permute4x64_epi64(
+        _mm256_packs_epi16(mask, ZERO), 0xD8);
+    return static_cast<uint32_t>(_mm256_movemask_epi8(bytes)) & 0xFFFF;
+}
+
+inline VecType pack_u32_to_u16(VecType lo, VecType hi)
+{
+    return _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), 0xD8);
+}
+inline VecType unpack_lo_u16_to_u32(VecType x)
+{
+    return _mm256_cvtepu16_epi32(_mm256_castsi256_si128(x));
+}
+inline VecType unpack_hi_u16_to_u32(VecType x)
+{
+    return _mm256_cvtepu16_epi32(_mm256_extracti128_si256(x, 1));
+}
+
 } // namespace simd
 } // namespace quadiron
 
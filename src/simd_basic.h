@@ -198,6 +198,229 @@ inline void add_props(
     }
 }
 
+/* ============= Operations on packed GF(65537) ============= */
+
+/**
+ * Elements of GF(65537) packed on 16-bit lanes
+ *
+ * Each lane stores its element modulo 2^16. The only element that does not
+ * fit, i.e. 65536, is stored as 0 with its lane set in the out-of-range mask
+ * `oor`. As 65536 = -1 mod 65537, a lane always holds `val - oor`.
+ *
+ * Compared to 32-bit lanes, a register holds twice as many elements and a
+ * product needs only 16-bit multiplications.
+ */
+struct PackedF4 {
+    VecType val;
+    VecType oor;
+};
+
+/**
+ * Broadcast an element of GF(65537) to packed lanes
+ *
+ * @param a element in [0, 65536]
+ * @return packed `a`
+ */
+inline PackedF4 packed_set_one(uint32_t a)
+{
+    const VecType oor = (a == F4 - 1) ? compare_eq<uint16_t>(ZERO, ZERO) : ZERO;
+    return {set_one(static_cast<uint16_t>(a)), oor};
+}
+
+/**
+ * Load packed elements whose out-of-range lanes are stored as a bit mask
+ *
+ * @param address location of the values
+ * @param oor bit mask of out-of-range lanes
+ * @return packed elements
+ */
+inline PackedF4 packed_load(VecType* address, uint32_t oor)
+{
+    return {load_to_reg(address), oor ? expand_mask_u16(oor) : ZERO};
+}
+
+/**
+ * Store packed elements
+ *
+ * @param address location of the values
+ * @param x packed elements
+ * @return bit mask of out-of-range lanes
+ */
+inline uint32_t packed_store(VecType* address, const PackedF4& x)
+{
+    store_to_mem(address, x.val);
+    return is_zero(x.oor) ? 0 : compress_mask_u16(x.oor);
+}
+
+/**
+ * Reduce `s - k` to packed elements
+ *
+ * @param s input register
+ * @param t register of `s - k` computed modulo 2^16, for `0 <= k < 2^16`
+ * @return (s - k) mod 65537
+ */
+inline PackedF4 packed_reduce(VecType s, VecType t)
+{
+    // lanes without borrow, i.e. t <= s
+    const VecType no_borrow = compare_eq<uint16_t>(min<uint16_t>(t, s), t);
+    // s - k + 65537 = t + 1 for lanes with borrow
+    const VecType val = add<uint16_t>(add<uint16_t>(t, ONE_U16), no_borrow);
+    return {val, bit_andnot(no_borrow, compare_eq<uint16_t>(val, ZERO))};
+}
+
+/**
+ * Modular addition of packed elements
+ *
+ * @param x input elements
+ * @param y input elements
+ * @return (x + y) mod 65537
+ */
+inline PackedF4 mod_add(const PackedF4& x, const PackedF4& y)
+{
+    const VecType s = add<uint16_t>(x.val, y.val);
+    // lanes without carry, i.e. s >= x
+    const VecType no_carry =
+        compare_eq<uint16_t>(min<uint16_t>(s, x.val), x.val);
+
+    if (is_zero(bit_or(x.oor, y.oor))) {
+        // as 2^16 = -1, a carry subtracts one, where s = 0 gives 65536
+        const VecType carry = bit_andnot(no_carry, ONE_U16);
+        return {sub_sat_u16(s, carry),
+                bit_andnot(no_carry, compare_eq<uint16_t>(s, ZERO))};
+    }
+    // a carry and each out-of-range input subtract one
+    const VecType t = sub<uint16_t>(
+        add<uint16_t>(add<uint16_t>(s, x.oor), y.oor),
+        add<uint16_t>(no_carry, ONE_U16));
+    return packed_reduce(s, t);
+}
+
+/**
+ * Modular negation of packed elements
+ *
+ * @param x input elements
+ * @return (-x) mod 65537
+ */
+inline PackedF4 mod_neg(const PackedF4& x)
+{
+    // -x = 65537 - x = 1 - x mod 2^16, except for zero
+    const VecType zero =
+        bit_andnot(x.oor, compare_eq<uint16_t>(x.val, ZERO));
+    const VecType val = bit_andnot(zero, sub<uint16_t>(ONE_U16, x.val));
+    return {val, compare_eq<uint16_t>(x.val, ONE_U16)};
+}
+
+/**
+ * Modular subtraction of packed elements
+ *
+ * @param x input elements
+ * @param y input elements
+ * @return (x - y) mod 65537
+ */
+inline PackedF4 mod_sub(const PackedF4& x, const PackedF4& y)
+{
+    if (is_zero(bit_or(x.oor, y.oor))) {
+        return packed_reduce(x.val, sub<uint16_t>(x.val, y.val));
+    }
+    return mod_add(x, mod_neg(y));
+}
+
+/**
+ * Modular multiplication of packed elements
+ *
+ * @param x input elements
+ * @param y input elements
+ * @return (x * y) mod 65537
+ */
+inline PackedF4 mod_mul(const PackedF4& x, const PackedF4& y)
+{
+    const VecType lo = mul<uint16_t>(x.val, y.val);
+    const VecType hi = mulhi_u16(x.val, y.val);
+    // x * y = hi * 2^16 + lo = lo - hi
+    PackedF4 res = packed_reduce(lo, sub<uint16_t>(lo, hi));
+
+    if (is_zero(bit_or(x.oor, y.oor))) {
+        return res;
+    }
+    // 65536 * a = -a
+    const PackedF4 neg_x = mod_neg(x);
+    const PackedF4 neg_y = mod_neg(y);
+    res.val = BLEND8(res.val, neg_y.val, x.oor);
+    res.oor = BLEND8(res.oor, neg_y.oor, x.oor);
+    res.val = BLEND8(res.val, neg_x.val, y.oor);
+    res.oor = BLEND8(res.oor, neg_x.oor, y.oor);
+    return res;
+}
+
+/**
+ * Pack a buffer of elements of GF(65537) on 16-bit lanes
+ *
+ * @param src elements stored on 32-bit words
+ * @param val receives the values of packed elements
+ * @param oor receives bit masks of out-of-range lanes, one per register
+ * @param len number of registers of packed elements
+ */
+inline void pack_f4_buf(uint32_t* src, uint16_t* val, uint32_t* oor, size_t len)
+{
+    VecType* _src = reinterpret_cast<VecType*>(src);
+    VecType* _val = reinterpret_cast<VecType*>(val);
+
+    for (size_t i = 0; i < len; ++i) {
+        VecType lo = load_to_reg(_src + 2 * i);
+        VecType hi = load_to_reg(_src + 2 * i + 1);
+        const VecType lo_oor = compare_eq<uint32_t>(lo, F4_MINUS_ONE_U32);
+        const VecType hi_oor = compare_eq<uint32_t>(hi, F4_MINUS_ONE_U32);
+
+        if (is_zero(bit_or(lo_oor, hi_oor))) {
+            store_to_mem(_val + i, pack_u32_to_u16(lo, hi));
+            oor[i] = 0;
+            continue;
+        }
+        lo = bit_andnot(lo_oor, lo);
+        hi = bit_andnot(hi_oor, hi);
+        const VecType flags = pack_u32_to_u16(
+            bit_and(lo_oor, ONE_U32), bit_and(hi_oor, ONE_U32));
+        store_to_mem(_val + i, pack_u32_to_u16(lo, hi));
+        oor[i] = compress_mask_u16(compare_eq<uint16_t>(flags, ONE_U16));
+    }
+}
+
+/**
+ * Unpack a buffer of elements of GF(65537) to 32-bit words
+ *
+ * @param val values of packed elements
+ * @param oor bit masks of out-of-range lanes, one per register
+ * @param dest receives the elements
+ * @param len number of registers of packed elements
+ */
+inline void
+unpack_f4_buf(uint16_t* val, uint32_t* oor, uint32_t* dest, size_t len)
+{
+    VecType* _val = reinterpret_cast<VecType*>(val);
+    VecType* _dest = reinterpret_cast<VecType*>(dest);
+
+    for (size_t i = 0; i < len; ++i) {
+        VecType x = load_to_reg(_val + i);
+
+        if (oor[i] == 0) {
+            store_to_mem(_dest + 2 * i, unpack_lo_u16_to_u32(x));
+            store_to_mem(_dest + 2 * i + 1, unpack_hi_u16_to_u32(x));
+            continue;
+        }
+        // out-of-range lanes become 1 + 0xFFFF once unpacked
+        const VecType mask = expand_mask_u16(oor[i]);
+        x = sub<uint16_t>(x, mask);
+        store_to_mem(
+            _dest + 2 * i,
+            add<uint32_t>(
+                unpack_lo_u16_to_u32(x), unpack_lo_u16_to_u32(mask)));
+        store_to_mem(
+            _dest + 2 * i + 1,
+            add<uint32_t>(
+                unpack_hi_u16_to_u32(x), unpack_hi_u16_to_u32(mask)));
+    }
+}
+
 /* ==================== Operations for RingModN =================== */
 /** Perform a multiplication of a coefficient `a` to each element of `src` and
  *  add result to correspondent element of `dest`
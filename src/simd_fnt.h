@@ -211,20 +211,20 @@ inline static void do_butterfly_ct_2_layers(
 
     size_t j = 0;
     const size_t end = (len > 1) ? len - 1 : 0;
-    while (j < end) {
+    for (; j < end; j += 2) {
         // First layer (c1, x, y) & (c1, u, v)
-        VecType x1 = load_to_reg(p);
-        VecType x2 = load_to_reg(p + 1);
-        VecType y1 = load_to_reg(q);
-        VecType y2 = load_to_reg(q + 1);
+        VecType x1 = load_to_reg(p + j);
+        VecType x2 = load_to_reg(p + j + 1);
+        VecType y1 = load_to_reg(q + j);
+        VecType y2 = load_to_reg(q + j + 1);
 
         butterfly_ct(r1p1, c1, &x1, &y1, card);
         butterfly_ct(r1p1, c1, &x2, &y2, card);
 
-        VecType u1 = load_to_reg(r);
-        VecType u2 = load_to_reg(r + 1);
-        VecType v1 = load_to_reg(s);
-        VecType v2 = load_to_reg(s + 1);
+        VecType u1 = load_to_reg(r + j);
+        VecType u2 = load_to_reg(r + j + 1);
+        VecType v1 = load_to_reg(s + j);
+        VecType v2 = load_to_reg(s + j + 1);
 
         butterfly_ct(r1p1, c1, &u1, &v1, card);
         butterfly_ct(r1p1, c1, &u2, &v2, card);
@@ -237,21 +237,16 @@ inline static void do_butterfly_ct_2_layers(
         butterfly_ct(r3p1, c3, &y2, &v2, card);
 
         // Store back to memory
-        store_to_mem(p, x1);
-        store_to_mem(p + 1, x2);
-        store_to_mem(q, y1);
-        store_to_mem(q + 1, y2);
-
-        store_to_mem(r, u1);
-        store_to_mem(r + 1, u2);
-        store_to_mem(s, v1);
-        store_to_mem(s + 1, v2);
-        p = p + 2;
-        q = q + 2;
-        r = r + 2;
-        s = s + 2;
-        j = j + 2;
-    };
+        store_to_mem(p + j, x1);
+        store_to_mem(p + j + 1, x2);
+        store_to_mem(q + j, y1);
+        store_to_mem(q + j + 1, y2);
+
+        store_to_mem(r + j, u1);
+        store_to_mem(r + j + 1, u2);
+        store_to_mem(s + j, v1);
+        store_to_mem(s + j + 1, v2);
+    }
 
     for (; j < len; ++j) {
         // First layer (c1, x, y) & (c1, u, v)
@@ -325,6 +320,122 @@ inline void butterfly_ct_two_layers_step(
     }
 }
 
+template <typename T>
+inline static void do_butterfly_ct_3_layers(
+    const std::vector<T*>& mem,
+    const T* r,
+    unsigned start,
+    unsigned m,
+    size_t len,
+    T card)
+{
+    const T r1p1 = r[0] + 1;
+    const T r2p1 = r[1] + 1;
+    const T r3p1 = r[2] + 1;
+    const T r4p1 = r[3] + 1;
+    const T r5p1 = r[4] + 1;
+    const T r6p1 = r[5] + 1;
+    const T r7p1 = r[6] + 1;
+
+    const VecType c1 = set_one(r[0]);
+    const VecType c2 = set_one(r[1]);
+    const VecType c3 = set_one(r[2]);
+    const VecType c4 = set_one(r[3]);
+    const VecType c5 = set_one(r[4]);
+    const VecType c6 = set_one(r[5]);
+    const VecType c7 = set_one(r[6]);
+
+    VecType* p0 = reinterpret_cast<VecType*>(mem[start]);
+    VecType* p1 = reinterpret_cast<VecType*>(mem[start + m]);
+    VecType* p2 = reinterpret_cast<VecType*>(mem[start + 2 * m]);
+    VecType* p3 = reinterpret_cast<VecType*>(mem[start + 3 * m]);
+    VecType* p4 = reinterpret_cast<VecType*>(mem[start + 4 * m]);
+    VecType* p5 = reinterpret_cast<VecType*>(mem[start + 5 * m]);
+    VecType* p6 = reinterpret_cast<VecType*>(mem[start + 6 * m]);
+    VecType* p7 = reinterpret_cast<VecType*>(mem[start + 7 * m]);
+
+    for (size_t j = 0; j < len; ++j) {
+        VecType x0 = load_to_reg(p0 + j);
+        VecType x1 = load_to_reg(p1 + j);
+        VecType x2 = load_to_reg(p2 + j);
+        VecType x3 = load_to_reg(p3 + j);
+        VecType x4 = load_to_reg(p4 + j);
+        VecType x5 = load_to_reg(p5 + j);
+        VecType x6 = load_to_reg(p6 + j);
+        VecType x7 = load_to_reg(p7 + j);
+
+        // First layer (c1, x0, x1), (c1, x2, x3), (c1, x4, x5), (c1, x6, x7)
+        butterfly_ct(r1p1, c1, &x0, &x1, card);
+        butterfly_ct(r1p1, c1, &x2, &x3, card);
+        butterfly_ct(r1p1, c1, &x4, &x5, card);
+        butterfly_ct(r1p1, c1, &x6, &x7, card);
+
+        // Second layer (c2, x0, x2), (c3, x1, x3), (c2, x4, x6), (c3, x5, x7)
+        butterfly_ct(r2p1, c2, &x0, &x2, card);
+        butterfly_ct(r3p1, c3, &x1, &x3, card);
+        butterfly_ct(r2p1, c2, &x4, &x6, card);
+        butterfly_ct(r3p1, c3, &x5, &x7, card);
+
+        // Third layer (c4, x0, x4), (c5, x1, x5), (c6, x2, x6), (c7, x3, x7)
+        butterfly_ct(r4p1, c4, &x0, &x4, card);
+        butterfly_ct(r5p1, c5, &x1, &x5, card);
+        butterfly_ct(r6p1, c6, &x2, &x6, card);
+        butterfly_ct(r7p1, c7, &x3, &x7, card);
+
+        // Store back to memory
+        store_to_mem(p0 + j, x0);
+        store_to_mem(p1 + j, x1);
+        store_to_mem(p2 + j, x2);
+        store_to_mem(p3 + j, x3);
+        store_to_mem(p4 + j, x4);
+        store_to_mem(p5 + j, x5);
+        store_to_mem(p6 + j, x6);
+        store_to_mem(p7 + j, x7);
+    }
+}
+
+/**
+ * Vectorized butterfly CT on three layers at a time
+ *
+ * For each group of eight buffers (X0, ..., X7) where Xk = buf[i + k * m]
+ * First layer: butterfly on (Xk, Xk+1) for even k
+ *      coef r[0] = W[start * n / (2 * m)]
+ * Second layer: butterfly on (Xk, Xk+2) for k = 0, 1, 4, 5
+ *      coef r[1] = W[start * n / (4 * m)] for even k
+ *      coef r[2] = W[(start + m) * n / (4 * m)] for odd k
+ * Third layer: butterfly on (Xk, Xk+4) for k = 0, ..., 3
+ *      coef r[3 + k] = W[(start + k * m) * n / (8 * m)]
+ *
+ * Each vector of the eight buffers is loaded once for the three layers.
+ *
+ * @param buf - working buffers
+ * @param r - the seven coefficients
+ * @param start - index of buffer among `m` ones
+ * @param m - current group size
+ * @param len - number of vectors per buffer
+ * @param card - modulo cardinal
+ */
+template <typename T>
+inline void butterfly_ct_three_layers_step(
+    vec::Buffers<T>& buf,
+    const T* r,
+    unsigned start,
+    unsigned m,
+    size_t len,
+    T card)
+{
+    if (len == 0) {
+        return;
+    }
+    const unsigned step = m << 3;
+    const unsigned bufs_nb = buf.get_n();
+
+    const std::vector<T*>& mem = buf.get_mem();
+    for (unsigned i = start; i < bufs_nb; i += step) {
+        do_butterfly_ct_3_layers(mem, r, i, m, len, card);
+    }
+}
+
 /**
  * Vectorized butterfly GS step
  *
@@ -464,6 +575,413 @@ inline void butterfly_gs_step_simple(
     }
 }
 
+/**
+ * Vectorized butterfly GS on two layers at a time
+ *
+ * For each quadruple
+ * (P, Q, R, S) = (buf[i], buf[i + m], buf[i + 2 * m], buf[i + 3 * m])
+ * First layer: butterfly on (P, R) and (Q, S) for step = 4 * m
+ *      coef r1 = inv_W[start * n / (4 * m)]
+ *      coef r2 = inv_W[(start + m) * n / (4 * m)]
+ *      P = P + R
+ *      R = r1 * (P - R)
+ *      Q = Q + S
+ *      S = r2 * (Q - S)
+ * Second layer: butterfly on (P, Q) and (R, S) for step = 2 * m
+ *      coef r3 = inv_W[start * n / (2 * m)]
+ *      P = P + Q
+ *      Q = r3 * (P - Q)
+ *      R = R + S
+ *      S = r3 * (R - S)
+ *
+ * @param buf - working buffers
+ * @param r1 - 1st coefficient for the 1st layer
+ * @param r2 - 2nd coefficient for the 1st layer
+ * @param r3 - coefficient for the 2nd layer
+ * @param start - index of buffer among `m` ones
+ * @param m - current group size
+ * @param len - number of vectors per buffer
+ * @param card - modulo cardinal
+ */
+template <typename T>
+inline void butterfly_gs_two_layers_step(
+    vec::Buffers<T>& buf,
+    T r1,
+    T r2,
+    T r3,
+    unsigned start,
+    unsigned m,
+    size_t len,
+    T card)
+{
+    if (len == 0) {
+        return;
+    }
+    const unsigned step = m << 2;
+    const T r1p1 = r1 + 1;
+    const T r2p1 = r2 + 1;
+    const T r3p1 = r3 + 1;
+    const VecType c1 = set_one(r1);
+    const VecType c2 = set_one(r2);
+    const VecType c3 = set_one(r3);
+
+    const unsigned bufs_nb = buf.get_n();
+    const std::vector<T*>& mem = buf.get_mem();
+    for (unsigned i = start; i < bufs_nb; i += step) {
+        VecType* p = reinterpret_cast<VecType*>(mem[i]);
+        VecType* q = reinterpret_cast<VecType*>(mem[i + m]);
+        VecType* r = reinterpret_cast<VecType*>(mem[i + 2 * m]);
+        VecType* s = reinterpret_cast<VecType*>(mem[i + 3 * m]);
+
+        for (size_t j = 0; j < len; ++j) {
+            VecType x = load_to_reg(p + j);
+            VecType y = load_to_reg(q + j);
+            VecType u = load_to_reg(r + j);
+            VecType v = load_to_reg(s + j);
+
+            // First layer (c1, x, u) & (c2, y, v)
+            butterfly_gs(r1p1, c1, &x, &u, card);
+            butterfly_gs(r2p1, c2, &y, &v, card);
+
+            // Second layer (c3, x, y) & (c3, u, v)
+            butterfly_gs(r3p1, c3, &x, &y, card);
+            butterfly_gs(r3p1, c3, &u, &v, card);
+
+            // Store back to memory
+            store_to_mem(p + j, x);
+            store_to_mem(q + j, y);
+            store_to_mem(r + j, u);
+            store_to_mem(s + j, v);
+        }
+    }
+}
+
+template <typename T>
+inline static void do_butterfly_gs_3_layers(
+    const std::vector<T*>& mem,
+    const T* r,
+    unsigned start,
+    unsigned m,
+    size_t len,
+    T card)
+{
+    const T r1p1 = r[0] + 1;
+    const T r2p1 = r[1] + 1;
+    const T r3p1 = r[2] + 1;
+    const T r4p1 = r[3] + 1;
+    const T r5p1 = r[4] + 1;
+    const T r6p1 = r[5] + 1;
+    const T r7p1 = r[6] + 1;
+
+    const VecType c1 = set_one(r[0]);
+    const VecType c2 = set_one(r[1]);
+    const VecType c3 = set_one(r[2]);
+    const VecType c4 = set_one(r[3]);
+    const VecType c5 = set_one(r[4]);
+    const VecType c6 = set_one(r[5]);
+    const VecType c7 = set_one(r[6]);
+
+    VecType* p0 = reinterpret_cast<VecType*>(mem[start]);
+    VecType* p1 = reinterpret_cast<VecType*>(mem[start + m]);
+    VecType* p2 = reinterpret_cast<VecType*>(mem[start + 2 * m]);
+    VecType* p3 = reinterpret_cast<VecType*>(mem[start + 3 * m]);
+    VecType* p4 = reinterpret_cast<VecType*>(mem[start + 4 * m]);
+    VecType* p5 = reinterpret_cast<VecType*>(mem[start + 5 * m]);
+    VecType* p6 = reinterpret_cast<VecType*>(mem[start + 6 * m]);
+    VecType* p7 = reinterpret_cast<VecType*>(mem[start + 7 * m]);
+
+    for (size_t j = 0; j < len; ++j) {
+        VecType x0 = load_to_reg(p0 + j);
+        VecType x1 = load_to_reg(p1 + j);
+        VecType x2 = load_to_reg(p2 + j);
+        VecType x3 = load_to_reg(p3 + j);
+        VecType x4 = load_to_reg(p4 + j);
+        VecType x5 = load_to_reg(p5 + j);
+        VecType x6 = load_to_reg(p6 + j);
+        VecType x7 = load_to_reg(p7 + j);
+
+        // First layer (c1, x0, x4), (c2, x1, x5), (c3, x2, x6), (c4, x3, x7)
+        butterfly_gs(r1p1, c1, &x0, &x4, card);
+        butterfly_gs(r2p1, c2, &x1, &x5, card);
+        butterfly_gs(r3p1, c3, &x2, &x6, card);
+        butterfly_gs(r4p1, c4, &x3, &x7, card);
+
+        // Second layer (c5, x0, x2), (c6, x1, x3), (c5, x4, x6), (c6, x5, x7)
+        butterfly_gs(r5p1, c5, &x0, &x2, card);
+        butterfly_gs(r6p1, c6, &x1, &x3, card);
+        butterfly_gs(r5p1, c5, &x4, &x6, card);
+        butterfly_gs(r6p1, c6, &x5, &x7, card);
+
+        // Third layer (c7, x0, x1), (c7, x2, x3), (c7, x4, x5), (c7, x6, x7)
+        butterfly_gs(r7p1, c7, &x0, &x1, card);
+        butterfly_gs(r7p1, c7, &x2, &x3, card);
+        butterfly_gs(r7p1, c7, &x4, &x5, card);
+        butterfly_gs(r7p1, c7, &x6, &x7, card);
+
+        // Store back to memory
+        store_to_mem(p0 + j, x0);
+        store_to_mem(p1 + j, x1);
+        store_to_mem(p2 + j, x2);
+        store_to_mem(p3 + j, x3);
+        store_to_mem(p4 + j, x4);
+        store_to_mem(p5 + j, x5);
+        store_to_mem(p6 + j, x6);
+        store_to_mem(p7 + j, x7);
+    }
+}
+
+/**
+ * Vectorized butterfly GS on three layers at a time
+ *
+ * For each group of eight buffers (X0, ..., X7) where Xk = buf[i + k * m]
+ * First layer: butterfly on (Xk, Xk+4) for k = 0, ..., 3
+ *      coef r[k] = inv_W[(start + k * m) * n / (8 * m)]
+ * Second layer: butterfly on (Xk, Xk+2) for k = 0, 1, 4, 5
+ *      coef r[4] = inv_W[start * n / (4 * m)] for even k
+ *      coef r[5] = inv_W[(start + m) * n / (4 * m)] for odd k
+ * Third layer: butterfly on (Xk, Xk+1) for even k
+ *      coef r[6] = inv_W[start * n / (2 * m)]
+ *
+ * Each vector of the eight buffers is loaded once for the three layers.
+ *
+ * @param buf - working buffers
+ * @param r - the seven coefficients
+ * @param start - index of buffer among `m` ones
+ * @param m - current group size, i.e. of the last layer
+ * @param len - number of vectors per buffer
+ * @param card - modulo cardinal
+ */
+template <typename T>
+inline void butterfly_gs_three_layers_step(
+    vec::Buffers<T>& buf,
+    const T* r,
+    unsigned start,
+    unsigned m,
+    size_t len,
+    T card)
+{
+    if (len == 0) {
+        return;
+    }
+    const unsigned step = m << 3;
+    const unsigned bufs_nb = buf.get_n();
+
+    const std::vector<T*>& mem = buf.get_mem();
+    for (unsigned i = start; i < bufs_nb; i += step) {
+        do_butterfly_gs_3_layers(mem, r, i, m, len, card);
+    }
+}
+
+/* ============ Vectorized Operations on packed GF(65537) ============ */
+
+/**
+ * Butterfly Cooley-Tukey operation on packed elements
+ *
+ * x <- x + r * y
+ * y <- x - r * y
+ *
+ * @param r coefficient
+ * @param c packed coefficient `r`
+ * @param x working elements
+ * @param y working elements
+ */
+inline void
+butterfly_ct(uint32_t r, const PackedF4& c, PackedF4* x, PackedF4* y)
+{
+    PackedF4 z;
+    if (r == 1) {
+        z = *y;
+    } else if (r < F4 - 1) {
+        z = mod_mul(c, *y);
+    } else {
+        z = mod_neg(*y);
+    }
+    *y = mod_sub(*x, z);
+    *x = mod_add(*x, z);
+}
+
+/**
+ * Butterfly Genteleman-Sande operation on packed elements
+ *
+ * x <- x + y
+ * y <- r * (x - y)
+ *
+ * @param r coefficient
+ * @param c packed coefficient `r`
+ * @param x working elements
+ * @param y working elements
+ */
+inline void
+butterfly_gs(uint32_t r, const PackedF4& c, PackedF4* x, PackedF4* y)
+{
+    const PackedF4 add = mod_add(*x, *y);
+    if (r == 1) {
+        *y = mod_sub(*x, *y);
+    } else if (r < F4 - 1) {
+        *y = mod_mul(c, mod_sub(*x, *y));
+    } else {
+        *y = mod_sub(*y, *x);
+    }
+    *x = add;
+}
+
+/**
+ * Butterfly Genteleman-Sande simple operation on packed elements, y = 0
+ *
+ * @param r coefficient
+ * @param c packed coefficient `r`
+ * @param x working elements
+ * @return r * x
+ */
+inline PackedF4 butterfly_simple_gs(uint32_t r, const PackedF4& c, PackedF4 x)
+{
+    if (r == 1) {
+        return x;
+    } else if (r < F4 - 1) {
+        return mod_mul(c, x);
+    } else {
+        return mod_neg(x);
+    }
+}
+
+/**
+ * Vectorized butterfly CT step on packed elements
+ *
+ * For each pair (P, Q) = (buf[i], buf[i + m]) for step = 2 * m and coef `r`
+ *      P = P + r * Q
+ *      Q = P - r * Q
+ *
+ * @param buf - values of packed elements, see pack_f4_buf()
+ * @param oor - bit masks of out-of-range lanes of `buf`
+ * @param r - coefficient
+ * @param start - index of buffer among `m` ones
+ * @param m - current group size
+ * @param len - number of vectors per buffer
+ */
+inline void butterfly_ct_step_packed(
+    vec::Buffers<uint16_t>& buf,
+    vec::Buffers<uint32_t>& oor,
+    uint32_t r,
+    unsigned start,
+    unsigned m,
+    size_t len)
+{
+    const unsigned step = m << 1;
+    const PackedF4 c = packed_set_one(r);
+
+    const unsigned bufs_nb = buf.get_n();
+    const std::vector<uint16_t*>& mem = buf.get_mem();
+    const std::vector<uint32_t*>& oor_mem = oor.get_mem();
+    for (unsigned i = start; i < bufs_nb; i += step) {
+        VecType* p = reinterpret_cast<VecType*>(mem[i]);
+        VecType* q = reinterpret_cast<VecType*>(mem[i + m]);
+        uint32_t* p_oor = oor_mem[i];
+        uint32_t* q_oor = oor_mem[i + m];
+
+        for (size_t j = 0; j < len; ++j) {
+            PackedF4 x = packed_load(p + j, p_oor[j]);
+            PackedF4 y = packed_load(q + j, q_oor[j]);
+
+            butterfly_ct(r, c, &x, &y);
+
+            // Store back to memory
+            p_oor[j] = packed_store(p + j, x);
+            q_oor[j] = packed_store(q + j, y);
+        }
+    }
+}
+
+/**
+ * Vectorized butterfly GS step on packed elements
+ *
+ * For each pair (P, Q) = (buf[i], buf[i + m]) for step = 2 * m and coef `r`
+ *      P = P + Q
+ *      Q = r * (P - Q)
+ *
+ * @param buf - values of packed elements, see pack_f4_buf()
+ * @param oor - bit masks of out-of-range lanes of `buf`
+ * @param r - coefficient
+ * @param start - index of buffer among `m` ones
+ * @param m - current group size
+ * @param len - number of vectors per buffer
+ */
+inline void butterfly_gs_step_packed(
+    vec::Buffers<uint16_t>& buf,
+    vec::Buffers<uint32_t>& oor,
+    uint32_t r,
+    unsigned start,
+    unsigned m,
+    size_t len)
+{
+    const unsigned step = m << 1;
+    const PackedF4 c = packed_set_one(r);
+
+    const unsigned bufs_nb = buf.get_n();
+    const std::vector<uint16_t*>& mem = buf.get_mem();
+    const std::vector<uint32_t*>& oor_mem = oor.get_mem();
+    for (unsigned i = start; i < bufs_nb; i += step) {
+        VecType* p = reinterpret_cast<VecType*>(mem[i]);
+        VecType* q = reinterpret_cast<VecType*>(mem[i + m]);
+        uint32_t* p_oor = oor_mem[i];
+        uint32_t* q_oor = oor_mem[i + m];
+
+        for (size_t j = 0; j < len; ++j) {
+            PackedF4 x = packed_load(p + j, p_oor[j]);
+            PackedF4 y = packed_load(q + j, q_oor[j]);
+
+            butterfly_gs(r, c, &x, &y);
+
+            // Store back to memory
+            p_oor[j] = packed_store(p + j, x);
+            q_oor[j] = packed_store(q + j, y);
+        }
+    }
+}
+
+/**
+ * Vectorized butterfly GS step on packed elements
+ *
+ * For each pair (P, Q) = (buf[i], buf[i + m]) for step = 2 * m and coef `r`
+ *      Q = r * P
+ *
+ * @param buf - values of packed elements, see pack_f4_buf()
+ * @param oor - bit masks of out-of-range lanes of `buf`
+ * @param r - coefficient
+ * @param start - index of buffer among `m` ones
+ * @param m - current group size
+ * @param len - number of vectors per buffer
+ */
+inline void butterfly_gs_step_simple_packed(
+    vec::Buffers<uint16_t>& buf,
+    vec::Buffers<uint32_t>& oor,
+    uint32_t r,
+    unsigned start,
+    unsigned m,
+    size_t len)
+{
+    const unsigned step = m << 1;
+    const PackedF4 c = packed_set_one(r);
+
+    const unsigned bufs_nb = buf.get_n();
+    const std::vector<uint16_t*>& mem = buf.get_mem();
+    const std::vector<uint32_t*>& oor_mem = oor.get_mem();
+    for (unsigned i = start; i < bufs_nb; i += step) {
+        VecType* p = reinterpret_cast<VecType*>(mem[i]);
+        VecType* q = reinterpret_cast<VecType*>(mem[i + m]);
+        uint32_t* p_oor = oor_mem[i];
+        uint32_t* q_oor = oor_mem[i + m];
+
+        for (size_t j = 0; j < len; ++j) {
+            const PackedF4 x = packed_load(p + j, p_oor[j]);
+
+            const PackedF4 y = butterfly_simple_gs(r, c, x);
+
+            // Store back to memory
+            q_oor[j] = packed_store(q + j, y);
+        }
+    }
+}
+
 template <typename T>
 inline void encode_post_process(
     vec::Buffers<T>& output,
@@ -363,6 +363,103 @@ inline void hadamard_mul(unsigned n, __uint128_t* _x, __uint128_t* _y)
     }
 }
 
+/** Transpose a 4x4 matrix of 32-bit elements stored in four registers */
+inline void transpose4x4(__m128i& r0, __m128i& r1, __m128i& r2, __m128i& r3)
+{
+    const __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+    const __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+    const __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+    const __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+
+    r0 = _mm_unpacklo_epi64(t0, t1);
+    r1 = _mm_unpackhi_epi64(t0, t1);
+    r2 = _mm_unpacklo_epi64(t2, t3);
+    r3 = _mm_unpackhi_epi64(t2, t3);
+}
+
+/** Move four 16-bit lanes of `n` words into four planes of 32-bit symbols
+ *
+ * Only a multiple of 4 words are processed.
+ *
+ * @return number of processed words
+ */
+inline size_t
+planar_split(size_t n, const __uint128_t* src, uint32_t* const* planes)
+{
+    const size_t vec_len = n - n % 4;
+
+    for (size_t j = 0; j < vec_len; j += 4) {
+        const __m128i* x = reinterpret_cast<const __m128i*>(src + j);
+        __m128i r0 = _mm_cvtepu16_epi32(_mm_loadl_epi64(x));
+        __m128i r1 = _mm_cvtepu16_epi32(_mm_loadl_epi64(x + 1));
+        __m128i r2 = _mm_cvtepu16_epi32(_mm_loadl_epi64(x + 2));
+        __m128i r3 = _mm_cvtepu16_epi32(_mm_loadl_epi64(x + 3));
+
+        transpose4x4(r0, r1, r2, r3);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(planes[0] + j), r0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(planes[1] + j), r1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(planes[2] + j), r2);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(planes[3] + j), r3);
+    }
+    return vec_len;
+}
+
+/** Merge one row of four symbols into a word and return its flag */
+inline uint32_t merge_row(__m128i row, __uint128_t* dest)
+{
+    const __m128i oor = _mm_set1_epi32(65536);
+    const __m128i mask = _mm_set1_epi32(0xFFFF);
+
+    const uint32_t flag = _mm_movemask_ps(
+        _mm_castsi128_ps(_mm_cmpeq_epi32(row, oor)));
+    const __m128i values =
+        _mm_packus_epi32(_mm_and_si128(row, mask), _mm_setzero_si128());
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), values);
+
+    return flag;
+}
+
+/** Merge four planes of `n` 32-bit symbols into words of four 16-bit lanes
+ *
+ * Symbols equal to 65536 are set to zero and marked in `flags`. Only a
+ * multiple of 4 words are processed.
+ *
+ * @param marked set to true if at least one symbol is marked
+ * @return number of processed words
+ */
+inline size_t planar_merge(
+    size_t n,
+    const uint32_t* const* planes,
+    __uint128_t* dest,
+    uint32_t* flags,
+    bool& marked)
+{
+    const size_t vec_len = n - n % 4;
+    uint32_t any = 0;
+
+    for (size_t j = 0; j < vec_len; j += 4) {
+        __m128i r0 = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(planes[0] + j));
+        __m128i r1 = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(planes[1] + j));
+        __m128i r2 = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(planes[2] + j));
+        __m128i r3 = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(planes[3] + j));
+
+        transpose4x4(r0, r1, r2, r3);
+
+        flags[j] = merge_row(r0, dest + j);
+        flags[j + 1] = merge_row(r1, dest + j + 1);
+        flags[j + 2] = merge_row(r2, dest + j + 2);
+        flags[j + 3] = merge_row(r3, dest + j + 3);
+        any |= flags[j] | flags[j + 1] | flags[j + 2] | flags[j + 3];
+    }
+    marked = (any != 0);
+    return vec_len;
+}
+
 } // namespace simd
 } // namespace quadiron
 
@@ -0,0 +1,685 @@
+/* -*- mode: c++ -*- */
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __QUAD_VEC_BITSLICE_H__
+#define __QUAD_VEC_BITSLICE_H__
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <queue>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "gf_base.h"
+#include "simd/simd.h"
+#include "vec_buffers.h"
+#include "vec_matrix.h"
+
+namespace quadiron {
+namespace vec {
+
+/// Number of symbols held by a word of a bit-plane
+static constexpr size_t BITSLICE_WORD_LEN = 64;
+
+/// Largest degree of binary extension fields stored as bit-planes
+static constexpr unsigned BITSLICE_MAX_BITS = 16;
+
+/** Transpose a 8x8 matrix of bits held in a 64-bit word
+ *
+ * Bit `j` of byte `i` is swapped with bit `i` of byte `j`.
+ */
+inline uint64_t transpose_8x8(uint64_t x)
+{
+    uint64_t t;
+
+    t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+    x = x ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+    x = x ^ t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+    x = x ^ t ^ (t << 28);
+
+    return x;
+}
+
+/** Bit matrix of the multiplication by a constant of GF(2<sup>n</sup>)
+ *
+ * The product \f$c \cdot x\f$ is linear over GF(2) in \f$x\f$: bit `i` of
+ * the product is the XOR of the bits `j` of \f$x\f$ for which bit `j` of
+ * `rows[i]` is set, i.e. for which bit `i` of \f$c \cdot 2^j\f$ is set.
+ *
+ * @param gf binary extension field
+ * @param n_bits degree of the field
+ * @param c constant
+ * @param rows receives the `n_bits` rows of the matrix
+ */
+template <typename T>
+void bit_matrix(const gf::Field<T>& gf, unsigned n_bits, T c, uint16_t* rows)
+{
+    assert(n_bits <= BITSLICE_MAX_BITS);
+
+    std::fill_n(rows, n_bits, 0);
+    for (unsigned j = 0; j < n_bits; j++) {
+        const T col = gf.mul(c, static_cast<T>(1) << j);
+        for (unsigned i = 0; i < n_bits; i++) {
+            if ((col >> i) & 1) {
+                rows[i] |= 1U << j;
+            }
+        }
+    }
+}
+
+/** A vector of `n` buffers of symbols of GF(2<sup>n_bits</sup>) stored as
+ *  bit-planes.
+ *
+ * Each buffer of `size` symbols is transposed into `n_bits` planes: bit `i`
+ * of the j-th symbol is bit `j % 64` of the word `j / 64` of the i-th plane.
+ *
+ * In this form, adding buffers or multiplying a buffer by a constant of the
+ * field are fixed networks of XORs of whole planes (see bit_matrix()). They
+ * involve no table lookup, and the loops over the words of planes are
+ * vectorized to the widest registers available.
+ *
+ * Symbols are moved from and to regular Buffers by slice() and unslice().
+ */
+template <typename T>
+class BitSlicedBuffers final {
+  public:
+    BitSlicedBuffers(
+        unsigned n_bits,
+        int n,
+        size_t size,
+        const simd::AllocPolicy& policy = simd::AllocPolicy());
+    unsigned get_n_bits() const;
+    int get_n() const;
+    size_t get_size() const;
+    size_t get_n_words() const;
+    uint64_t* get_plane(int i, unsigned bit);
+    const uint64_t* get_plane(int i, unsigned bit) const;
+    void zero_fill();
+    void slice(const Buffers<T>& bufs);
+    void unslice(Buffers<T>& bufs) const;
+    void add(int i, const BitSlicedBuffers<T>& src, int j);
+    void mul_add(
+        int i,
+        const BitSlicedBuffers<T>& src,
+        int j,
+        const uint16_t* rows);
+
+  private:
+    unsigned n_bits;
+    int n;
+    size_t size;
+    // number of words of a plane
+    size_t n_words;
+    std::vector<uint64_t, simd::AlignedAllocator<uint64_t>> mem;
+
+    void xor_plane(uint64_t* dst, const uint64_t* src);
+};
+
+template <typename T>
+BitSlicedBuffers<T>::BitSlicedBuffers(
+    unsigned n_bits,
+    int n,
+    size_t size,
+    const simd::AllocPolicy& policy)
+    : n_bits(n_bits), n(n), size(size),
+      n_words((size + BITSLICE_WORD_LEN - 1) / BITSLICE_WORD_LEN),
+      mem(n * n_bits * n_words,
+          0,
+          simd::AlignedAllocator<uint64_t>(policy))
+{
+    assert(n_bits > 0 && n_bits <= BITSLICE_MAX_BITS);
+    assert(n_bits <= 8 * sizeof(T));
+}
+
+template <typename T>
+inline unsigned BitSlicedBuffers<T>::get_n_bits() const
+{
+    return n_bits;
+}
+
+template <typename T>
+inline int BitSlicedBuffers<T>::get_n() const
+{
+    return n;
+}
+
+template <typename T>
+inline size_t BitSlicedBuffers<T>::get_size() const
+{
+    return size;
+}
+
+template <typename T>
+inline size_t BitSlicedBuffers<T>::get_n_words() const
+{
+    return n_words;
+}
+
+template <typename T>
+inline uint64_t* BitSlicedBuffers<T>::get_plane(int i, unsigned bit)
+{
+    return mem.data() + (i * n_bits + bit) * n_words;
+}
+
+template <typename T>
+inline const uint64_t* BitSlicedBuffers<T>::get_plane(int i, unsigned bit)
+    const
+{
+    return mem.data() + (i * n_bits + bit) * n_words;
+}
+
+template <typename T>
+void BitSlicedBuffers<T>::zero_fill()
+{
+    std::fill(mem.begin(), mem.end(), 0);
+}
+
+/** Transpose buffers of symbols into bit-planes
+ *
+ * Groups of 8 symbols are transposed byte by byte: byte `k` of 8 symbols
+ * forms a 8x8 matrix of bits whose transpose holds 8 bits of 8 planes.
+ * Trailing symbols of the last word of planes are zero.
+ *
+ * @param bufs `n` buffers of `size` symbols lower than 2<sup>n_bits</sup>
+ */
+template <typename T>
+void BitSlicedBuffers<T>::slice(const Buffers<T>& bufs)
+{
+    assert(bufs.get_n() == n);
+    assert(bufs.get_size() == size);
+
+    const unsigned n_bytes = (n_bits + 7) / 8;
+
+    for (int i = 0; i < n; i++) {
+        const T* buf = bufs.get(i);
+        for (size_t w = 0; w < n_words; w++) {
+            const size_t begin = w * BITSLICE_WORD_LEN;
+            const size_t len = std::min(BITSLICE_WORD_LEN, size - begin);
+            for (unsigned k = 0; k < n_bytes; k++) {
+                uint64_t planes[8] = {0};
+                for (size_t g = 0; g * 8 < len; g++) {
+                    uint64_t x = 0;
+                    for (size_t s = 0; s < 8 && g * 8 + s < len; s++) {
+                        const T symb = buf[begin + g * 8 + s];
+                        x |= static_cast<uint64_t>((symb >> (8 * k)) & 0xFF)
+                             << (8 * s);
+                    }
+                    x = transpose_8x8(x);
+                    for (unsigned b = 0; b < 8; b++) {
+                        planes[b] |= ((x >> (8 * b)) & 0xFF) << (8 * g);
+                    }
+                }
+                for (unsigned b = 0; b < 8 && 8 * k + b < n_bits; b++) {
+                    get_plane(i, 8 * k + b)[w] = planes[b];
+                }
+            }
+        }
+    }
+}
+
+/** Transpose bit-planes back into buffers of symbols
+ *
+ * @param bufs receives the `n` buffers of `size` symbols
+ */
+template <typename T>
+void BitSlicedBuffers<T>::unslice(Buffers<T>& bufs) const
+{
+    assert(bufs.get_n() == n);
+    assert(bufs.get_size() == size);
+
+    const unsigned n_bytes = (n_bits + 7) / 8;
+
+    for (int i = 0; i < n; i++) {
+        T* buf = bufs.get(i);
+        std::fill_n(buf, size, 0);
+        for (size_t w = 0; w < n_words; w++) {
+            const size_t begin = w * BITSLICE_WORD_LEN;
+            const size_t len = std::min(BITSLICE_WORD_LEN, size - begin);
+            for (unsigned k = 0; k < n_bytes; k++) {
+                uint64_t planes[8] = {0};
+                for (unsigned b = 0; b < 8 && 8 * k + b < n_bits; b++) {
+                    planes[b] = get_plane(i, 8 * k + b)[w];
+                }
+                for (size_t g = 0; g * 8 < len; g++) {
+                    uint64_t x = 0;
+                    for (unsigned b = 0; b < 8; b++) {
+                        x |= ((planes[b] >> (8 * g)) & 0xFF) << (8 * b);
+                    }
+                    x = transpose_8x8(x);
+                    for (size_t s = 0; s < 8 && g * 8 + s < len; s++) {
+                        buf[begin + g * 8 + s] |=
+                            static_cast<T>((x >> (8 * s)) & 0xFF) << (8 * k);
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <typename T>
+inline void BitSlicedBuffers<T>::xor_plane(uint64_t* dst, const uint64_t* src)
+{
+    for (size_t w = 0; w < n_words; w++) {
+        dst[w] ^= src[w];
+    }
+}
+
+/** Add the j-th buffer of `src` to the i-th buffer */
+template <typename T>
+void BitSlicedBuffers<T>::add(int i, const BitSlicedBuffers<T>& src, int j)
+{
+    assert(src.n_bits == n_bits && src.n_words == n_words);
+
+    for (unsigned bit = 0; bit < n_bits; bit++) {
+        xor_plane(get_plane(i, bit), src.get_plane(j, bit));
+    }
+}
+
+/** Add the product of the j-th buffer of `src` by a constant to the i-th
+ *  buffer
+ *
+ * @param rows bit matrix of the constant, see bit_matrix()
+ */
+template <typename T>
+void BitSlicedBuffers<T>::mul_add(
+    int i,
+    const BitSlicedBuffers<T>& src,
+    int j,
+    const uint16_t* rows)
+{
+    assert(src.n_bits == n_bits && src.n_words == n_words);
+
+    for (unsigned bit = 0; bit < n_bits; bit++) {
+        uint64_t* dst = get_plane(i, bit);
+        for (unsigned m = rows[bit]; m != 0; m &= m - 1) {
+            xor_plane(dst, src.get_plane(j, __builtin_ctz(m)));
+        }
+    }
+}
+
+/** A matrix over GF(2<sup>n_bits</sup>) applied to bit-sliced buffers
+ *
+ * The bit matrices of all coefficients are computed once, so that a product
+ * only runs the XOR networks.
+ */
+template <typename T>
+class BitSlicedMatrix final {
+  public:
+    BitSlicedMatrix(const gf::Field<T>& gf, unsigned n_bits, Matrix<T>& mat);
+    int get_n_rows() const;
+    int get_n_cols() const;
+    unsigned get_n_bits() const;
+    const uint16_t* get_bit_matrix(int i, int j) const;
+    void
+    mul(BitSlicedBuffers<T>& output, const BitSlicedBuffers<T>& input) const;
+
+  private:
+    unsigned n_bits;
+    int n_rows;
+    int n_cols;
+    // `n_bits` rows of bit matrix of each coefficient, row-major
+    std::vector<uint16_t> rows;
+};
+
+template <typename T>
+BitSlicedMatrix<T>::BitSlicedMatrix(
+    const gf::Field<T>& gf,
+    unsigned n_bits,
+    Matrix<T>& mat)
+    : n_bits(n_bits), n_rows(mat.get_n_rows()), n_cols(mat.get_n_cols()),
+      rows(n_rows * n_cols * n_bits)
+{
+    for (int i = 0; i < n_rows; i++) {
+        for (int j = 0; j < n_cols; j++) {
+            bit_matrix(
+                gf, n_bits, mat.get(i, j), &rows[(i * n_cols + j) * n_bits]);
+        }
+    }
+}
+
+template <typename T>
+inline int BitSlicedMatrix<T>::get_n_rows() const
+{
+    return n_rows;
+}
+
+template <typename T>
+inline int BitSlicedMatrix<T>::get_n_cols() const
+{
+    return n_cols;
+}
+
+template <typename T>
+inline unsigned BitSlicedMatrix<T>::get_n_bits() const
+{
+    return n_bits;
+}
+
+/** Return the bit matrix of the coefficient at row `i` and column `j` */
+template <typename T>
+inline const uint16_t* BitSlicedMatrix<T>::get_bit_matrix(int i, int j) const
+{
+    return &rows[(i * n_cols + j) * n_bits];
+}
+
+/** Multiply bit-sliced buffers by the matrix
+ *
+ * @param output receives `n_rows` buffers
+ * @param input `n_cols` buffers
+ */
+template <typename T>
+void BitSlicedMatrix<T>::mul(
+    BitSlicedBuffers<T>& output,
+    const BitSlicedBuffers<T>& input) const
+{
+    assert(output.get_n() == n_rows && input.get_n() == n_cols);
+    assert(output.get_n_bits() == n_bits && input.get_n_bits() == n_bits);
+
+    output.zero_fill();
+    for (int i = 0; i < n_rows; i++) {
+        for (int j = 0; j < n_cols; j++) {
+            output.mul_add(i, input, j, &rows[(i * n_cols + j) * n_bits]);
+        }
+    }
+}
+
+/// Number of words of planes processed at once by a XorSchedule
+static constexpr size_t XOR_SCHEDULE_STRIP_LEN = 32;
+
+/// Largest number of pairs of terms searched for common subexpressions
+static constexpr size_t XOR_SCHEDULE_MAX_PAIRS = 1 << 20;
+
+/** A schedule of XORs of planes applying a BitSlicedMatrix
+ *
+ * Expanding the coefficients of the matrix into their bit matrices, each
+ * output plane is the XOR of a set of input planes. Pairs of planes shared by
+ * several outputs are computed once into temporary planes: the pair shared by
+ * most outputs is repeatedly replaced by a new temporary (greedy common
+ * subexpression elimination), until no pair is shared anymore. The search
+ * is skipped for matrices having more than XOR_SCHEDULE_MAX_PAIRS pairs.
+ *
+ * The schedule is computed once for a matrix, e.g. for the encoding matrix or
+ * for the decoding matrix of a pattern of erasures, and replayed on each
+ * packet.
+ */
+template <typename T>
+class XorSchedule final {
+  public:
+    XorSchedule(const BitSlicedMatrix<T>& mat, size_t size);
+    size_t get_n_xors() const;
+    size_t get_n_tmp() const;
+    void apply(BitSlicedBuffers<T>& output, const BitSlicedBuffers<T>& input);
+
+  private:
+    // `dst = src1 ^ src2`, `dst = src1` if `src2` is NONE, or zero if `src1`
+    // is NONE. Planes are numbered inputs first, then temporaries and outputs
+    struct Op {
+        uint32_t dst;
+        uint32_t src1;
+        uint32_t src2;
+    };
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    unsigned n_bits;
+    int n_rows;
+    int n_cols;
+    size_t size;
+    size_t n_words;
+    uint32_t n_in;
+    uint32_t n_tmp;
+    size_t n_xors;
+    std::vector<Op> ops;
+    std::vector<uint64_t, simd::AlignedAllocator<uint64_t>> tmp;
+    std::vector<const uint64_t*> src_planes;
+    std::vector<uint64_t*> dst_planes;
+
+    void eliminate_pairs(
+        std::vector<std::vector<uint32_t>>& terms,
+        std::vector<std::pair<uint32_t, uint32_t>>& pairs);
+};
+
+/**
+ * Build the schedule of a matrix
+ *
+ * @param mat matrix applied by the schedule
+ * @param size number of symbols of buffers the schedule is applied to
+ */
+template <typename T>
+XorSchedule<T>::XorSchedule(const BitSlicedMatrix<T>& mat, size_t size)
+    : n_bits(mat.get_n_bits()), n_rows(mat.get_n_rows()),
+      n_cols(mat.get_n_cols()), size(size),
+      n_words((size + BITSLICE_WORD_LEN - 1) / BITSLICE_WORD_LEN),
+      n_in(n_cols * n_bits)
+{
+    // input planes XORed into each output plane
+    std::vector<std::vector<uint32_t>> terms(n_rows * n_bits);
+    for (int i = 0; i < n_rows; i++) {
+        for (unsigned bit = 0; bit < n_bits; bit++) {
+            std::vector<uint32_t>& row = terms[i * n_bits + bit];
+            for (int j = 0; j < n_cols; j++) {
+                const unsigned m = mat.get_bit_matrix(i, j)[bit];
+                for (unsigned jj = 0; jj < n_bits; jj++) {
+                    if ((m >> jj) & 1) {
+                        row.push_back(j * n_bits + jj);
+                    }
+                }
+            }
+        }
+    }
+
+    size_t n_pairs = 0;
+    for (const std::vector<uint32_t>& row : terms) {
+        n_pairs += row.size() * (row.size() - 1) / 2;
+    }
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    if (n_pairs <= XOR_SCHEDULE_MAX_PAIRS) {
+        eliminate_pairs(terms, pairs);
+    }
+    n_tmp = pairs.size();
+    n_xors = n_tmp;
+
+    for (uint32_t t = 0; t < n_tmp; t++) {
+        ops.push_back({n_in + t, pairs[t].first, pairs[t].second});
+    }
+    for (size_t r = 0; r < terms.size(); r++) {
+        const std::vector<uint32_t>& row = terms[r];
+        const uint32_t dst = n_in + n_tmp + r;
+        if (row.empty()) {
+            ops.push_back({dst, NONE, NONE});
+        } else if (row.size() == 1) {
+            ops.push_back({dst, row[0], NONE});
+        } else {
+            ops.push_back({dst, row[0], row[1]});
+            for (size_t u = 2; u < row.size(); u++) {
+                ops.push_back({dst, dst, row[u]});
+            }
+            n_xors += row.size() - 1;
+        }
+    }
+
+    tmp.resize(n_tmp * n_words);
+    src_planes.resize(n_in + n_tmp + terms.size());
+    dst_planes.resize(n_tmp + terms.size());
+    for (uint32_t t = 0; t < n_tmp; t++) {
+        dst_planes[t] = tmp.data() + t * n_words;
+        src_planes[n_in + t] = dst_planes[t];
+    }
+}
+
+/**
+ * Replace pairs of terms shared by several rows by new terms
+ *
+ * @param terms sorted terms of each row, updated
+ * @param pairs receives the pair of terms of each new term, new terms are
+ * numbered from the number of inputs
+ */
+template <typename T>
+void XorSchedule<T>::eliminate_pairs(
+    std::vector<std::vector<uint32_t>>& terms,
+    std::vector<std::pair<uint32_t, uint32_t>>& pairs)
+{
+    // number of rows sharing each pair, along with a heap of the counts
+    // where outdated entries are skipped
+    std::unordered_map<uint64_t, uint32_t> counts;
+    std::priority_queue<std::tuple<uint32_t, uint64_t>> heap;
+
+    const auto key = [](uint32_t a, uint32_t b) {
+        return (a < b) ? (static_cast<uint64_t>(a) << 32) | b
+                       : (static_cast<uint64_t>(b) << 32) | a;
+    };
+    const auto update = [&](uint64_t k, int delta) {
+        const uint32_t count = counts[k] += delta;
+        if (count >= 2) {
+            heap.emplace(count, k);
+        }
+    };
+
+    for (const std::vector<uint32_t>& row : terms) {
+        for (size_t u = 0; u < row.size(); u++) {
+            for (size_t v = u + 1; v < row.size(); v++) {
+                counts[key(row[u], row[v])]++;
+            }
+        }
+    }
+    for (const auto& count : counts) {
+        if (count.second >= 2) {
+            heap.emplace(count.second, count.first);
+        }
+    }
+
+    while (!heap.empty()) {
+        uint32_t count;
+        uint64_t k;
+        std::tie(count, k) = heap.top();
+        heap.pop();
+        if (counts[k] != count) {
+            continue;
+        }
+        const uint32_t a = k >> 32;
+        const uint32_t b = k & 0xFFFFFFFF;
+        const uint32_t t = n_in + pairs.size();
+        pairs.emplace_back(a, b);
+
+        for (std::vector<uint32_t>& row : terms) {
+            const auto it_a = std::lower_bound(row.begin(), row.end(), a);
+            const auto it_b = std::lower_bound(row.begin(), row.end(), b);
+            if (it_a == row.end() || *it_a != a || it_b == row.end()
+                || *it_b != b) {
+                continue;
+            }
+            row.erase(it_b);
+            row.erase(std::lower_bound(row.begin(), row.end(), a));
+            for (const uint32_t x : row) {
+                update(key(a, x), -1);
+                update(key(b, x), -1);
+                update(key(t, x), 1);
+            }
+            // `t` is the largest term so far
+            row.push_back(t);
+        }
+        counts[k] = 0;
+    }
+}
+
+/** Return the number of XORs of planes of the schedule */
+template <typename T>
+inline size_t XorSchedule<T>::get_n_xors() const
+{
+    return n_xors;
+}
+
+/** Return the number of temporary planes of the schedule */
+template <typename T>
+inline size_t XorSchedule<T>::get_n_tmp() const
+{
+    return n_tmp;
+}
+
+/** Apply the schedule
+ *
+ * Planes are processed by strips of XOR_SCHEDULE_STRIP_LEN words, so that
+ * temporaries of a strip remain in cache.
+ *
+ * @param output receives `n_rows` buffers
+ * @param input `n_cols` buffers
+ */
+template <typename T>
+void XorSchedule<T>::apply(
+    BitSlicedBuffers<T>& output,
+    const BitSlicedBuffers<T>& input)
+{
+    assert(output.get_n() == n_rows && input.get_n() == n_cols);
+    assert(output.get_n_bits() == n_bits && input.get_n_bits() == n_bits);
+    assert(output.get_size() == size && input.get_size() == size);
+
+    for (int i = 0; i < n_cols; i++) {
+        for (unsigned bit = 0; bit < n_bits; bit++) {
+            src_planes[i * n_bits + bit] = input.get_plane(i, bit);
+        }
+    }
+    for (int i = 0; i < n_rows; i++) {
+        for (unsigned bit = 0; bit < n_bits; bit++) {
+            const uint32_t r = i * n_bits + bit;
+            dst_planes[n_tmp + r] = output.get_plane(i, bit);
+            src_planes[n_in + n_tmp + r] = dst_planes[n_tmp + r];
+        }
+    }
+
+    for (size_t begin = 0; begin < n_words;
+         begin += XOR_SCHEDULE_STRIP_LEN) {
+        const size_t end = std::min(begin + XOR_SCHEDULE_STRIP_LEN, n_words);
+        for (const Op& op : ops) {
+            uint64_t* dst = dst_planes[op.dst - n_in];
+            if (op.src1 == NONE) {
+                std::fill(dst + begin, dst + end, 0);
+            } else if (op.src2 == NONE) {
+                std::copy(
+                    src_planes[op.src1] + begin,
+                    src_planes[op.src1] + end,
+                    dst + begin);
+            } else {
+                const uint64_t* src1 = src_planes[op.src1];
+                const uint64_t* src2 = src_planes[op.src2];
+                for (size_t w = begin; w < end; w++) {
+                    dst[w] = src1[w] ^ src2[w];
+                }
+            }
+        }
+    }
+}
+
+} // namespace vec
+} // namespace quadiron
+
+#endif
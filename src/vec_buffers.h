@@ -96,11 +96,17 @@ enum class BufMemAlloc {
  * - owns all the memory (the vector of buffers and the buffers themselve).
  * - own the vector and use existing buffers (only the vector is allocated).
  * - nothing (a shallow copy of another Buffers).
+ *
+ * Owned memory is allocated according to an allocation policy (huge pages,
+ * NUMA placement). With a non-default policy, the buffers are carved out of a
+ * single contiguous block, as a buffer alone is usually much smaller than a
+ * huge page.
  */
 template <typename T>
 class Buffers final {
   public:
     Buffers(int n, size_t size);
+    Buffers(int n, size_t size, const simd::AllocPolicy& policy);
     Buffers(int n, size_t size, const std::vector<T*>& mem);
     Buffers(const Buffers<T>& vec, int n = 0);
     Buffers(const Buffers<T>& vec, int begin, int end);
@@ -109,6 +115,7 @@ class Buffers final {
     ~Buffers();
     int get_n(void) const;
     size_t get_size(void) const;
+    const simd::AllocPolicy& get_alloc_policy(void) const;
     int get_mem_len(void);
     void zero_fill(void);
     void fill(int i, T value);
@@ -135,6 +142,11 @@ class Buffers final {
     simd::AlignedAllocator<T> allocator;
     BufMemAlloc mem_alloc_case = BufMemAlloc::FULL;
     T* zeros = nullptr;
+    // Contiguous block holding all the buffers (non-default policy only)
+    T* slab = nullptr;
+    size_t slab_len = 0;
+
+    void allocate_mem(void);
 };
 
 /**
@@ -151,10 +163,26 @@ Buffers<T>::Buffers(int n, size_t size)
     this->mem_len = n * size;
 
     this->mem_alloc_case = BufMemAlloc::FULL;
-    mem.reserve(n);
-    for (int i = 0; i < n; i++) {
-        mem.push_back(this->allocator.allocate(size));
-    }
+    allocate_mem();
+}
+
+/**
+ * Constructor of Buffers with a given allocation policy
+ *
+ * @param n - size of vector of pointers, stored in `mem`
+ * @param size - number of elements of each memory pointed by a pointer of `mem`
+ * @param policy - allocation policy of the memory
+ */
+template <typename T>
+Buffers<T>::Buffers(int n, size_t size, const simd::AllocPolicy& policy)
+    : allocator(policy)
+{
+    this->n = n;
+    this->size = size;
+    this->mem_len = n * size;
+
+    this->mem_alloc_case = BufMemAlloc::FULL;
+    allocate_mem();
 }
 
 /**
@@ -182,6 +210,7 @@ Buffers<T>::Buffers(int n, size_t size, const std::vector<T*>& mem)
  */
 template <typename T>
 Buffers<T>::Buffers(const Buffers<T>& vec, int n)
+    : allocator(vec.get_alloc_policy())
 {
     assert(n >= 0);
     int i;
@@ -192,11 +221,7 @@ Buffers<T>::Buffers(const Buffers<T>& vec, int n)
     this->mem_len = n * size;
 
     this->mem_alloc_case = BufMemAlloc::FULL;
-
-    mem.reserve(n);
-    for (i = 0; i < this->n; i++) {
-        mem.push_back(this->allocator.allocate(size));
-    }
+    allocate_mem();
 
     int copy_len = (this->n <= vec_n) ? this->n : vec_n;
     for (i = 0; i < copy_len; i++) {
@@ -223,6 +248,7 @@ Buffers<T>::Buffers(const Buffers<T>& vec, int n)
  */
 template <typename T>
 Buffers<T>::Buffers(const Buffers<T>& vec, int begin, int end)
+    : allocator(vec.get_alloc_policy())
 {
     assert(begin >= 0 && begin < end);
 
@@ -297,6 +323,7 @@ Buffers<T>::Buffers(
     const Buffers<T>& vec,
     const vec::Vector<T>& map,
     unsigned n)
+    : allocator(vec.get_alloc_policy())
 {
     const unsigned map_len = map.get_n();
     const unsigned vec_n = vec.get_n();
@@ -330,7 +357,9 @@ template <typename T>
 Buffers<T>::~Buffers()
 {
     if (this->mem_alloc_case != BufMemAlloc::NONE && mem.size() > 0) {
-        if (this->mem_alloc_case == BufMemAlloc::FULL) {
+        if (this->slab != nullptr) {
+            this->allocator.deallocate(this->slab, slab_len);
+        } else if (this->mem_alloc_case == BufMemAlloc::FULL) {
             for (int i = 0; i < n; i++) {
                 this->allocator.deallocate(mem[i], size);
             }
@@ -352,6 +381,37 @@ inline size_t Buffers<T>::get_size(void) const
     return size;
 }
 
+template <typename T>
+inline const simd::AllocPolicy& Buffers<T>::get_alloc_policy(void) const
+{
+    return allocator.get_policy();
+}
+
+/// Allocate the `n` buffers of a fully allocated Buffers.
+template <typename T>
+void Buffers<T>::allocate_mem(void)
+{
+    mem.reserve(n);
+    if (allocator.get_policy().is_default()) {
+        for (int i = 0; i < n; i++) {
+            mem.push_back(this->allocator.allocate(size));
+        }
+        return;
+    }
+    // Keep every buffer aligned within the block.
+    const size_t align = std::max<size_t>(simd::ALIGNMENT / sizeof(T), 1);
+    const size_t stride = (size + align - 1) / align * align;
+    if (n == 0 || stride == 0) {
+        mem.insert(mem.end(), n, nullptr);
+        return;
+    }
+    slab_len = n * stride;
+    slab = this->allocator.allocate(slab_len);
+    for (int i = 0; i < n; i++) {
+        mem.push_back(slab + i * stride);
+    }
+}
+
 template <typename T>
 inline int Buffers<T>::get_mem_len(void)
 {
@@ -244,6 +244,49 @@ TYPED_TEST(BuffersTest, TestZeroExtented) // NOLINT
     ASSERT_EQ(vec3, vec1);
 }
 
+TYPED_TEST(BuffersTest, TestAllocPolicy) // NOLINT
+{
+    using quadiron::simd::AllocPolicy;
+    using quadiron::simd::HugePages;
+    using quadiron::simd::NumaPlacement;
+
+    const int n = 4;
+    const std::vector<AllocPolicy> policies = {
+        AllocPolicy(),
+        AllocPolicy(HugePages::TRANSPARENT),
+        AllocPolicy(HugePages::EXPLICIT),
+        AllocPolicy(HugePages::NONE, NumaPlacement::FIRST_TOUCH),
+        AllocPolicy(HugePages::TRANSPARENT, NumaPlacement::BIND_LOCAL),
+    };
+    // Small buffers and buffers whose block spans several huge pages.
+    const std::vector<size_t> sizes = {
+        33, quadiron::simd::HUGE_PAGE_SIZE / sizeof(TypeParam) + 1};
+
+    for (const AllocPolicy& policy : policies) {
+        for (size_t size : sizes) {
+            vec::Buffers<TypeParam> vec1(n, size, policy);
+            ASSERT_EQ(vec1.get_alloc_policy(), policy);
+
+            for (int i = 0; i < n; i++) {
+                ASSERT_TRUE(quadiron::simd::addr_is_aligned(vec1.get(i)));
+                vec1.fill(i, static_cast<TypeParam>(i + 1));
+            }
+            // Buffers must not overlap.
+            for (int i = 0; i < n; i++) {
+                ASSERT_EQ(vec1.get(i)[0], i + 1);
+                ASSERT_EQ(vec1.get(i)[size - 1], i + 1);
+            }
+
+            // Derived buffers inherit the policy.
+            vec::Buffers<TypeParam> vec2(vec1, n + 2);
+            ASSERT_EQ(vec2.get_alloc_policy(), policy);
+            vec::Buffers<TypeParam> vec3(vec2, 0, n);
+            ASSERT_EQ(vec1, vec3);
+            ASSERT_TRUE(this->check_all_zeros(vec2.get(n + 1), size));
+        }
+    }
+}
+
 TYPED_TEST(BuffersTest, TestPackUnpack) // NOLINT
 {
     const int iter_count = quadiron::arith::log2<TypeParam>(sizeof(TypeParam));
@@ -292,3 +335,83 @@ TYPED_TEST(BuffersTest, TestPackUnpack) // NOLINT
         ASSERT_EQ(vec_char_tmp, vec_char);
     }
 }
+
+TYPED_TEST(BuffersTest, TestBitSlice) // NOLINT
+{
+    const int n = 4;
+
+    // sizes that do not fill the last word of planes
+    for (const int size : {1, 13, 64, 200}) {
+        for (unsigned n_bits = 8; n_bits <= 16; n_bits += 8) {
+            auto gf(gf::create<gf::BinExtension<TypeParam>>(n_bits));
+            auto words = this->gen_buffers_rand_data(n, size, 1 << n_bits);
+            vec::BitSlicedBuffers<TypeParam> sliced(n_bits, n, size);
+            vec::Buffers<TypeParam> unsliced(n, size);
+
+            sliced.slice(*words);
+            sliced.unslice(unsliced);
+            ASSERT_EQ(unsliced, *words);
+
+            // c * words[0] + words[1]
+            const TypeParam c = gf.rand();
+            uint16_t rows[vec::BITSLICE_MAX_BITS];
+            vec::bit_matrix<TypeParam>(gf, n_bits, c, rows);
+
+            vec::BitSlicedBuffers<TypeParam> sliced_res(n_bits, 1, size);
+            vec::Buffers<TypeParam> res(1, size);
+            sliced_res.mul_add(0, sliced, 0, rows);
+            sliced_res.add(0, sliced, 1);
+            sliced_res.unslice(res);
+
+            for (int j = 0; j < size; j++) {
+                const TypeParam expected =
+                    gf.add(gf.mul(c, words->get(0)[j]), words->get(1)[j]);
+                ASSERT_EQ(res.get(0)[j], expected);
+            }
+        }
+    }
+}
+
+TYPED_TEST(BuffersTest, TestXorSchedule) // NOLINT
+{
+    const int n_rows = 4;
+    const int n_cols = 6;
+    const int size = 300;
+
+    for (unsigned n_bits = 8; n_bits <= 16; n_bits += 8) {
+        auto gf(gf::create<gf::BinExtension<TypeParam>>(n_bits));
+        vec::Matrix<TypeParam> mat(gf, n_rows, n_cols);
+        mat.cauchy();
+        const vec::BitSlicedMatrix<TypeParam> bit_mat(gf, n_bits, mat);
+        vec::XorSchedule<TypeParam> schedule(bit_mat, size);
+
+        auto words = this->gen_buffers_rand_data(n_cols, size, 1 << n_bits);
+        vec::BitSlicedBuffers<TypeParam> sliced(n_bits, n_cols, size);
+        vec::BitSlicedBuffers<TypeParam> expected(n_bits, n_rows, size);
+        vec::BitSlicedBuffers<TypeParam> res(n_bits, n_rows, size);
+        vec::Buffers<TypeParam> expected_words(n_rows, size);
+        vec::Buffers<TypeParam> res_words(n_rows, size);
+
+        sliced.slice(*words);
+        bit_mat.mul(expected, sliced);
+        schedule.apply(res, sliced);
+        expected.unslice(expected_words);
+        res.unslice(res_words);
+        ASSERT_EQ(res_words, expected_words);
+
+        // shared pairs are computed once
+        size_t n_xors = 0;
+        for (int i = 0; i < n_rows; i++) {
+            for (unsigned bit = 0; bit < n_bits; bit++) {
+                int n_terms = 0;
+                for (int j = 0; j < n_cols; j++) {
+                    n_terms +=
+                        __builtin_popcount(bit_mat.get_bit_matrix(i, j)[bit]);
+                }
+                n_xors += std::max(n_terms - 1, 0);
+            }
+        }
+        ASSERT_GT(schedule.get_n_tmp(), 0);
+        ASSERT_LT(schedule.get_n_xors(), n_xors);
+    }
+}
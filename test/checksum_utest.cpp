@@ -0,0 +1,66 @@
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "checksum.h"
+
+namespace {
+
+uint32_t crc32c(const std::string& data, uint32_t crc = 0)
+{
+    return quadiron::crc32c(
+        crc, reinterpret_cast<const uint8_t*>(data.data()), data.size());
+}
+
+} // namespace
+
+TEST(ChecksumTest, TestCrc32cKnownValues) // NOLINT
+{
+    ASSERT_EQ(crc32c(""), 0u);
+    ASSERT_EQ(crc32c("123456789"), 0xE3069283u);
+    ASSERT_EQ(crc32c(std::string(32, '\0')), 0x8A9136AAu);
+    ASSERT_EQ(crc32c(std::string(32, '\xFF')), 0x62A8AB43u);
+}
+
+TEST(ChecksumTest, TestCrc32cChaining) // NOLINT
+{
+    std::string data;
+    for (int i = 0; i < 1000; i++) {
+        data.push_back(static_cast<char>(i * 7));
+    }
+
+    const uint32_t expected = crc32c(data);
+    for (size_t split : {0, 1, 7, 8, 9, 500, 1000}) {
+        const uint32_t crc = crc32c(data.substr(0, split));
+        ASSERT_EQ(crc32c(data.substr(split), crc), expected);
+    }
+}
@@ -35,11 +35,14 @@
 
 #include "quadiron.h"
 
+#include "fragment_io.h"
+
 int vflag = 0;
 int tflag = 0;
 int data_zpad = -1;
 int coding_zpad = -1;
 char* prefix = nullptr;
+fragment_io::Backend backend = fragment_io::Backend::STREAM;
 
 [[noreturn]]
 static void xusage()
@@ -47,6 +50,7 @@ static void xusage()
     std::cerr << std::string("Usage: ") +
     "ec [-e rs-gf2n-v|rs-gf2n-c|rs-gf2n-fft|rs-gf2n-fft-add|rs-gfp-fft|rs-fnt|rs-fnt-sys|rs-nf4]" +
     "[-w word_size][-n n_data][-m n_parities][-p prefix][-v (verbose)]" +
+    "[-b stream|uring|mmap (fragment I/O)]" +
     " -c (encode) | -r (repair)\n";
     std::exit(EXIT_FAILURE);
 }
@@ -90,6 +94,29 @@ static inline std::string get_filename(
     return oss.str();
 }
 
+/**
+ * size of the first existing data or coding file, 0 if none
+ *
+ */
+template <typename T>
+size_t get_fragment_size(quadiron::fec::FecCode<T>* fec)
+{
+    struct stat st;
+    for (unsigned i = 0; i < fec->n_data; i++) {
+        const std::string filename = get_filename(prefix, 'd', data_zpad, i);
+        if (stat(filename.c_str(), &st) == 0) {
+            return static_cast<size_t>(st.st_size);
+        }
+    }
+    for (unsigned i = 0; i < fec->n_outputs; i++) {
+        const std::string filename = get_filename(prefix, 'c', coding_zpad, i);
+        if (stat(filename.c_str(), &st) == 0) {
+            return static_cast<size_t>(st.st_size);
+        }
+    }
+    return 0;
+}
+
 /**
  * (re-)create missing prefix.c1 ... cm files
  *
@@ -104,12 +131,14 @@ void create_coding_files(
     std::vector<std::ostream*> c_files(fec->n_outputs, nullptr);
     std::vector<std::ostream*> c_props_files(fec->n_outputs, nullptr);
     std::vector<quadiron::Properties> c_props(fec->n_outputs);
+    fragment_io::Io io(backend, fec->n_data + fec->n_outputs);
+    const size_t fragment_size = get_fragment_size(fec);
 
     for (unsigned i = 0; i < fec->n_data; i++) {
         filename = get_filename(prefix, 'd', data_zpad, i);
         if (vflag)
             std::cerr << "create: opening data " << filename << "\n";
-        d_files[i] = new std::ifstream(filename);
+        d_files[i] = io.open_source(filename);
         if (d_files[i]->fail()) {
           std::cerr << "l." << __LINE__ <<
             ": Exception opening data file (RO) for generation: " <<
@@ -123,7 +152,7 @@ void create_coding_files(
         if (vflag)
             std::cerr << "create: opening coding for writing " <<
               filename << "\n";
-        c_files[i] = new std::ofstream(filename);
+        c_files[i] = io.open_sink(filename, fragment_size);
         if (c_files[i]->fail()) {
           std::cerr << "l." << __LINE__ <<
            ": Exception creating coding file (RW) for generation: " <<
@@ -150,7 +179,7 @@ void create_coding_files(
     }
 
     for (unsigned i = 0; i < fec->n_data; i++) {
-        (static_cast<std::ifstream*>(d_files[i]))->close();
+        (static_cast<fragment_io::Source*>(d_files[i]))->close();
         delete d_files[i];
     }
 
@@ -160,7 +189,11 @@ void create_coding_files(
         (static_cast<std::ofstream*>(c_props_files[i]))->close();
         delete c_props_files[i];
 
-        (static_cast<std::ofstream*>(c_files[i]))->close();
+        if (!(static_cast<fragment_io::Sink*>(c_files[i]))->close()) {
+            std::cerr << "l." << __LINE__ << ": Exception writing coding file "
+                      << i << "\n";
+            std::exit(EXIT_FAILURE);
+        }
         delete c_files[i];
     }
 }
@@ -180,6 +213,8 @@ bool repair_data_files(
     std::vector<std::istream*> c_props_files(fec->n_outputs, nullptr);
     std::vector<quadiron::Properties> c_props(fec->n_outputs);
     std::vector<std::ostream*> r_files(fec->n_data, nullptr);
+    fragment_io::Io io(backend, fec->n_data + fec->n_outputs);
+    const size_t fragment_size = get_fragment_size(fec);
 
     // re-read data
     for (unsigned i = 0; i < fec->n_data; i++) {
@@ -190,7 +225,7 @@ bool repair_data_files(
             if (vflag)
                 std::cerr << filename << " is missing\n";
             d_files[i] = nullptr;
-            r_files[i] = new std::ofstream(filename);
+            r_files[i] = io.open_sink(filename, fragment_size);
             if (r_files[i]->fail()) {
               std::cerr << "l." << __LINE__ <<
                 ": Exception creating data file (RW) for repair: " <<
@@ -199,7 +234,7 @@ bool repair_data_files(
             }
         } else {
             r_files[i] = nullptr;
-            d_files[i] = new std::ifstream(filename);
+            d_files[i] = io.open_source(filename);
             if (d_files[i]->fail()) {
               std::cerr << "l." << __LINE__ <<
                 ": Exception opening data file (RO) for repair: " <<
@@ -218,7 +253,7 @@ bool repair_data_files(
                 std::cerr << filename << " is missing\n";
             c_files[i] = nullptr;
         } else {
-            c_files[i] = new std::ifstream(filename);
+            c_files[i] = io.open_source(filename);
             if (c_files[i]->fail()) {
               std::cerr << "l." << __LINE__ <<
                 ": Exception opening coding file (RO) for repair: " <<
@@ -251,7 +286,7 @@ bool repair_data_files(
 
     for (unsigned i = 0; i < fec->n_data; i++) {
         if (nullptr != d_files[i]) {
-            (static_cast<std::ifstream*>(d_files[i]))->close();
+            (static_cast<fragment_io::Source*>(d_files[i]))->close();
             delete d_files[i];
         }
     }
@@ -263,14 +298,19 @@ bool repair_data_files(
         }
 
         if (nullptr != c_files[i]) {
-            (static_cast<std::ifstream*>(c_files[i]))->close();
+            (static_cast<fragment_io::Source*>(c_files[i]))->close();
             delete c_files[i];
         }
     }
 
     for (unsigned i = 0; i < fec->n_data; i++) {
         if (nullptr != r_files[i]) {
-            (static_cast<std::ofstream*>(r_files[i]))->close();
+            if (!(static_cast<fragment_io::Sink*>(r_files[i]))->close()) {
+                std::cerr << "l." << __LINE__
+                          << ": Exception writing repaired data file " << i
+                          << "\n";
+                std::exit(EXIT_FAILURE);
+            }
             delete r_files[i];
         }
     }
@@ -278,18 +318,25 @@ bool repair_data_files(
     return 0;
 }
 
-template <typename T>
-void print_stats(quadiron::fec::FecCode<T>* fec)
+/** Average number of cycles of a call to a phase, over all operations */
+static uint64_t get_cycles_per_call(
+    const quadiron::fec::Stats& stats,
+    quadiron::fec::Phase phase)
 {
+    const quadiron::fec::PhaseStats& phase_stats = stats.get(phase);
+    return phase_stats.calls != 0 ? phase_stats.cycles / phase_stats.calls
+                                  : 0;
+}
+
+static void print_stats()
+{
+    // operations of a run (repair and encoding) are accumulated by the thread
+    const quadiron::fec::Stats stats = quadiron::fec::get_all_threads_stats();
     std::cerr << "enc,"
-              << (fec->n_encode_ops != 0
-                      ? fec->total_encode_cycles / fec->n_encode_ops
-                      : 0)
+              << get_cycles_per_call(stats, quadiron::fec::Phase::ENCODE)
               << ",";
     std::cerr << "dec,"
-              << (fec->n_decode_ops != 0
-                      ? fec->total_decode_cycles / fec->n_decode_ops
-                      : 0)
+              << get_cycles_per_call(stats, quadiron::fec::Phase::DECODE)
               << ",";
 }
 
@@ -340,7 +387,7 @@ void run_fec_rs_gf2n(
         }
     }
     create_coding_files<T>(fec);
-    print_stats<T>(fec);
+    print_stats();
     delete fec;
 }
 
@@ -362,7 +409,7 @@ void run_fec_rs_gf2n_fft(int word_size, int n_data, int n_parities, int rflag)
         }
     }
     create_coding_files<T>(fec);
-    print_stats<T>(fec);
+    print_stats();
     delete fec;
 }
 
@@ -388,7 +435,7 @@ void run_fec_rs_gf2n_fft_add(
         }
     }
     create_coding_files<T>(fec);
-    print_stats<T>(fec);
+    print_stats();
     delete fec;
 }
 
@@ -416,7 +463,7 @@ void run_fec_rs_gfp_fft(
         }
     }
     create_coding_files<T>(fec);
-    print_stats<T>(fec);
+    print_stats();
     delete fec;
 }
 
@@ -445,7 +492,7 @@ void run_fec_rs_fnt(
         }
     }
     create_coding_files<T>(fec, true);
-    print_stats<T>(fec);
+    print_stats();
     delete fec;
 }
 
@@ -468,7 +515,7 @@ void run_fec_rs_nf4(int word_size, int n_data, int n_parities, int rflag)
         }
     }
     create_coding_files<T>(fec);
-    print_stats<T>(fec);
+    print_stats();
     delete fec;
 }
 
@@ -507,7 +554,7 @@ int main(int argc, char** argv)
     unsigned word_size = 0;
 
     n_data = n_parities = -1;
-    while ((opt = getopt(argc, argv, "n:m:p:cruve:w:t")) != -1) {
+    while ((opt = getopt(argc, argv, "n:m:p:cruve:w:tb:")) != -1) {
         switch (opt) {
         case 'e':
             if (!strcmp(optarg, "rs-gf2n-v")) {
@@ -559,6 +606,11 @@ int main(int argc, char** argv)
         case 't':
             tflag = 1;
             break;
+        case 'b':
+            if (!fragment_io::parse_backend(optarg, &backend)) {
+                xusage();
+            }
+            break;
         default: /* '?' */
             xusage();
         }
@@ -27,18 +27,74 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  */
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include "quadiron.h"
 
 namespace fec = quadiron::fec;
 
+/** Stream buffer over a memory area, packets are accessed in place */
+class ArrayStreambuf : public quadiron::MemoryStreambuf {
+  public:
+    explicit ArrayStreambuf(std::string& area)
+    {
+        char* begin = &area[0];
+        setg(begin, begin, begin + area.size());
+        set_put_area(begin, begin + area.size(), 0);
+    }
+};
+
 template <typename T>
 class FecTestCommon : public ::testing::Test {
   public:
     const unsigned n_data = 3;
     const unsigned n_parities = 3;
 
+    const unsigned n_packets = 8;
+
+    std::vector<std::string> encode_packets(
+        fec::FecCode<T>& fec,
+        const std::vector<std::string>& data,
+        std::vector<quadiron::Properties>& props,
+        std::vector<uint32_t>* data_checksums = nullptr,
+        std::vector<uint32_t>* parities_checksums = nullptr)
+    {
+        const unsigned n_outputs = fec.n_outputs;
+        std::vector<std::istringstream> data_streams;
+        std::vector<std::ostringstream> output_streams(n_outputs);
+        std::vector<std::istream*> input_bufs;
+        std::vector<std::ostream*> output_bufs;
+
+        data_streams.reserve(this->n_data);
+        for (unsigned i = 0; i < this->n_data; i++) {
+            data_streams.emplace_back(data[i]);
+            input_bufs.push_back(&data_streams[i]);
+        }
+        for (unsigned i = 0; i < n_outputs; i++) {
+            output_bufs.push_back(&output_streams[i]);
+        }
+
+        fec.encode_packet(
+            input_bufs,
+            output_bufs,
+            props,
+            data_checksums,
+            parities_checksums);
+
+        std::vector<std::string> outputs;
+        for (unsigned i = 0; i < n_outputs; i++) {
+            outputs.push_back(output_streams[i].str());
+        }
+        return outputs;
+    }
+
     void
     run_test(fec::FecCode<T>& fec, bool props_flag = false, bool is_nf4 = false)
     {
@@ -91,6 +147,335 @@ class FecTestCommon : public ::testing::Test {
             ASSERT_EQ(copied_data_frags, decoded_frags);
         }
     }
+
+    void run_test_planar(
+        fec::FecCode<T>& packed_fec,
+        fec::FecCode<T>& planar_fec)
+    {
+        const unsigned n_outputs = planar_fec.n_outputs;
+        const size_t frag_size = n_packets * planar_fec.buf_size;
+
+        // lanes of data are 16-bit
+        std::vector<std::string> data(this->n_data);
+        for (unsigned i = 0; i < this->n_data; i++) {
+            for (size_t j = 0; j < frag_size; j++) {
+                data[i].push_back(static_cast<char>(std::rand()));
+            }
+        }
+        std::vector<quadiron::Properties> packed_props(n_outputs);
+        std::vector<quadiron::Properties> props(n_outputs);
+        std::vector<std::string> packed_outputs =
+            encode_packets(packed_fec, data, packed_props);
+        std::vector<std::string> outputs =
+            encode_packets(planar_fec, data, props);
+
+        ASSERT_EQ(outputs, packed_outputs);
+        for (unsigned i = 0; i < n_outputs; i++) {
+            ASSERT_EQ(props[i].get_map(), packed_props[i].get_map());
+        }
+
+        std::vector<std::istringstream> parity_streams;
+        std::vector<std::ostringstream> output_streams(this->n_data);
+        std::vector<std::istream*> input_data_bufs(this->n_data, nullptr);
+        std::vector<std::istream*> input_parities_bufs(n_outputs, nullptr);
+        std::vector<std::ostream*> output_data_bufs(this->n_data, nullptr);
+
+        for (unsigned i = 0; i < this->n_data; i++) {
+            output_data_bufs[i] = &output_streams[i];
+        }
+        // use the last outputs
+        parity_streams.reserve(n_outputs);
+        for (unsigned i = 0; i < n_outputs; i++) {
+            parity_streams.emplace_back(outputs[i]);
+            if (i >= n_outputs - this->n_data) {
+                input_parities_bufs[i] = &parity_streams[i];
+            }
+        }
+
+        ASSERT_TRUE(planar_fec.decode_packet(
+            input_data_bufs, input_parities_bufs, props, output_data_bufs));
+
+        for (unsigned i = 0; i < this->n_data; i++) {
+            ASSERT_EQ(output_streams[i].str(), data[i]);
+        }
+    }
+
+    /** Decode packets after a decoding session on other fragments
+     *
+     * The decoding context of the codec is built for fragments that a
+     * session does not receive: it must be kept apart from the session.
+     *
+     * @param fec code with at least 3 parities
+     */
+    void run_test_patterns(fec::FecCode<T>& fec)
+    {
+        const unsigned n_outputs = fec.n_outputs;
+        const bool systematic = fec.type == fec::FecType::SYSTEMATIC;
+        const unsigned n_frags = (systematic ? this->n_data : 0) + n_outputs;
+        const size_t frag_size = n_packets * fec.buf_size;
+
+        std::vector<std::string> data(this->n_data);
+        for (unsigned i = 0; i < this->n_data; i++) {
+            for (size_t j = 0; j < frag_size; j++) {
+                data[i].push_back(static_cast<char>(std::rand()));
+            }
+        }
+        std::vector<quadiron::Properties> props(n_outputs);
+        std::vector<std::string> frags = encode_packets(fec, data, props);
+        if (systematic) {
+            frags.insert(frags.begin(), data.begin(), data.end());
+        }
+        // the object decoded by sessions is striped by packets
+        std::string object;
+        for (size_t p = 0; p < n_packets; p++) {
+            for (unsigned i = 0; i < this->n_data; i++) {
+                object.append(data[i], p * fec.buf_size, fec.buf_size);
+            }
+        }
+
+        const auto check_packets = [&](const std::vector<unsigned>& lost) {
+            std::vector<std::istringstream> streams;
+            std::vector<std::ostringstream> decoded(this->n_data);
+            std::vector<std::istream*> data_bufs(this->n_data, nullptr);
+            std::vector<std::istream*> parities_bufs(n_outputs, nullptr);
+            std::vector<std::ostream*> decoded_bufs;
+
+            streams.reserve(n_frags);
+            for (unsigned i = 0; i < n_frags; i++) {
+                streams.emplace_back(frags[i]);
+                if (std::find(lost.begin(), lost.end(), i) != lost.end()) {
+                    continue;
+                }
+                if (i < n_frags - n_outputs) {
+                    data_bufs[i] = &streams[i];
+                } else {
+                    parities_bufs[i - (n_frags - n_outputs)] = &streams[i];
+                }
+            }
+            for (unsigned i = 0; i < this->n_data; i++) {
+                decoded_bufs.push_back(&decoded[i]);
+            }
+            ASSERT_TRUE(fec.decode_packet(
+                data_bufs, parities_bufs, props, decoded_bufs));
+            for (unsigned i = 0; i < this->n_data; i++) {
+                if (systematic && data_bufs[i] != nullptr) {
+                    continue;
+                }
+                ASSERT_EQ(decoded[i].str(), data[i]);
+            }
+        };
+        const auto check_session = [&](const std::vector<unsigned>& lost) {
+            std::vector<bool> avail(n_frags, true);
+            for (const unsigned i : lost) {
+                avail[i] = false;
+            }
+            std::string decoded;
+            fec::DecodeSession<T> decoder(
+                fec,
+                avail,
+                props,
+                object.size(),
+                [&](const uint8_t* bytes, size_t len) {
+                    decoded.append(reinterpret_cast<const char*>(bytes), len);
+                });
+            for (unsigned i = 0; i < n_frags; i++) {
+                decoder.feed(
+                    i,
+                    reinterpret_cast<const uint8_t*>(frags[i].data()),
+                    frags[i].size());
+            }
+            decoder.flush();
+            ASSERT_EQ(decoded, object);
+        };
+
+        check_packets({0});
+        check_session({1, 2});
+        check_packets({0});
+        check_session({0});
+        check_packets({1, 2});
+    }
+
+    /** Check a batch encoding against encodings of each object alone, then
+     * decode the batch
+     *
+     * @param fec code encoding the batch
+     * @param ref_fec code of same parameters whose packets divide fragments
+     * of the objects
+     */
+    void run_test_batch(fec::FecCode<T>& fec, fec::FecCode<T>& ref_fec)
+    {
+        const unsigned n_outputs = fec.n_outputs;
+        const size_t ref_buf_size = ref_fec.buf_size;
+        // objects smaller than a packet, spanning packets and empty
+        const std::vector<size_t> n_ref_pkts = {1, 3, 15, 16, 25, 1, 34, 0};
+        const size_t n_objects = n_ref_pkts.size();
+
+        std::vector<std::vector<std::string>> data(n_objects);
+        std::vector<std::vector<std::istringstream>> data_streams(n_objects);
+        std::vector<std::vector<std::ostringstream>> output_streams(n_objects);
+        std::vector<std::vector<std::istream*>> input_bufs(n_objects);
+        std::vector<std::vector<std::ostream*>> output_bufs(n_objects);
+        std::vector<std::vector<quadiron::Properties>> props(
+            n_objects, std::vector<quadiron::Properties>(n_outputs));
+
+        for (size_t obj = 0; obj < n_objects; obj++) {
+            const size_t frag_size = n_ref_pkts[obj] * ref_buf_size;
+            data[obj].resize(this->n_data);
+            data_streams[obj].reserve(this->n_data);
+            output_streams[obj].resize(n_outputs);
+            for (unsigned i = 0; i < this->n_data; i++) {
+                for (size_t j = 0; j < frag_size; j++) {
+                    data[obj][i].push_back(static_cast<char>(std::rand()));
+                }
+                data_streams[obj].emplace_back(data[obj][i]);
+                input_bufs[obj].push_back(&data_streams[obj][i]);
+            }
+            for (unsigned i = 0; i < n_outputs; i++) {
+                output_bufs[obj].push_back(&output_streams[obj][i]);
+            }
+        }
+
+        fec.encode_packet_batch(input_bufs, output_bufs, props);
+
+        for (size_t obj = 0; obj < n_objects; obj++) {
+            std::vector<quadiron::Properties> ref_props(n_outputs);
+            const std::vector<std::string> ref_outputs =
+                encode_packets(ref_fec, data[obj], ref_props);
+            for (unsigned i = 0; i < n_outputs; i++) {
+                ASSERT_EQ(output_streams[obj][i].str(), ref_outputs[i]);
+                ASSERT_EQ(props[obj][i].get_map(), ref_props[i].get_map());
+            }
+        }
+
+        // lose the first data fragments, or use the last outputs
+        const bool systematic = fec.type == fec::FecType::SYSTEMATIC;
+        const unsigned n_lost = std::min(this->n_data, this->n_parities) - 1;
+        std::vector<std::vector<std::istringstream>> parity_streams(n_objects);
+        std::vector<std::vector<std::ostringstream>> decoded_streams(
+            n_objects);
+        std::vector<std::vector<std::istream*>> data_bufs(n_objects);
+        std::vector<std::vector<std::istream*>> parities_bufs(n_objects);
+        std::vector<std::vector<std::ostream*>> decoded_bufs(n_objects);
+
+        for (size_t obj = 0; obj < n_objects; obj++) {
+            data_streams[obj].clear();
+            data_streams[obj].reserve(this->n_data);
+            parity_streams[obj].reserve(n_outputs);
+            decoded_streams[obj].resize(this->n_data);
+            for (unsigned i = 0; i < this->n_data; i++) {
+                data_streams[obj].emplace_back(data[obj][i]);
+                data_bufs[obj].push_back(
+                    i < n_lost ? nullptr : &data_streams[obj][i]);
+                decoded_bufs[obj].push_back(&decoded_streams[obj][i]);
+            }
+            for (unsigned i = 0; i < n_outputs; i++) {
+                parity_streams[obj].emplace_back(output_streams[obj][i].str());
+                const bool avail = systematic
+                                       ? i < n_lost
+                                       : i >= n_outputs - this->n_data;
+                parities_bufs[obj].push_back(
+                    avail ? &parity_streams[obj][i] : nullptr);
+            }
+        }
+        if (!systematic) {
+            data_bufs.clear();
+        }
+
+        ASSERT_TRUE(fec.decode_packet_batch(
+            data_bufs, parities_bufs, props, decoded_bufs));
+        for (size_t obj = 0; obj < n_objects; obj++) {
+            for (unsigned i = 0; i < this->n_data; i++) {
+                ASSERT_EQ(decoded_streams[obj][i].str(), data[obj][i]);
+            }
+        }
+
+        // all the stripes must share the same erasure pattern
+        parities_bufs.back().assign(n_outputs, nullptr);
+        ASSERT_THROW(
+            fec.decode_packet_batch(
+                data_bufs, parities_bufs, props, decoded_bufs),
+            quadiron::InvalidArgument);
+    }
+
+    void run_test_inline_props(fec::FecCode<T>& fec)
+    {
+        const unsigned n_outputs = fec.n_outputs;
+        const size_t frag_size = n_packets * fec.buf_size;
+
+        std::vector<std::string> data(this->n_data);
+        for (unsigned i = 0; i < this->n_data; i++) {
+            for (size_t j = 0; j < frag_size; j++) {
+                data[i].push_back(static_cast<char>(std::rand()));
+            }
+        }
+        std::vector<quadiron::Properties> props(n_outputs);
+        const std::vector<std::string> outputs =
+            encode_packets(fec, data, props);
+
+        fec.set_inline_props(true);
+        std::vector<quadiron::Properties> inline_props(n_outputs);
+        std::vector<std::string> inline_outputs =
+            encode_packets(fec, data, inline_props);
+
+        // packets are followed by their marks
+        for (unsigned i = 0; i < n_outputs; i++) {
+            ASSERT_EQ(inline_props[i].get_map(), props[i].get_map());
+            ASSERT_GE(inline_outputs[i].size(), frag_size + n_packets);
+            ASSERT_EQ(
+                inline_outputs[i].compare(
+                    0, fec.buf_size, outputs[i], 0, fec.buf_size),
+                0);
+        }
+
+        // decode from the last outputs without their properties, in place
+        std::vector<std::unique_ptr<ArrayStreambuf>> bufs;
+        std::vector<std::unique_ptr<std::istream>> parity_streams;
+        std::vector<std::ostringstream> output_streams(this->n_data);
+        std::vector<std::istream*> input_data_bufs(this->n_data, nullptr);
+        std::vector<std::istream*> input_parities_bufs(n_outputs, nullptr);
+        std::vector<std::ostream*> output_data_bufs;
+        const std::vector<quadiron::Properties> no_props(n_outputs);
+        for (unsigned i = n_outputs - this->n_data; i < n_outputs; i++) {
+            bufs.emplace_back(new ArrayStreambuf(inline_outputs[i]));
+            parity_streams.emplace_back(new std::istream(bufs.back().get()));
+            input_parities_bufs[i] = parity_streams.back().get();
+        }
+        for (unsigned i = 0; i < this->n_data; i++) {
+            output_data_bufs.push_back(&output_streams[i]);
+        }
+        ASSERT_TRUE(fec.decode_packet(
+            input_data_bufs, input_parities_bufs, no_props, output_data_bufs));
+        for (unsigned i = 0; i < this->n_data; i++) {
+            ASSERT_EQ(output_streams[i].str(), data[i]);
+        }
+
+        // truncated marks are detected
+        std::istringstream truncated(inline_outputs[n_outputs - 1].substr(
+            0, inline_outputs[n_outputs - 1].size() - 1));
+        std::istringstream last(inline_outputs[n_outputs - 1]);
+        for (unsigned i = n_outputs - this->n_data; i < n_outputs; i++) {
+            bufs.emplace_back(new ArrayStreambuf(inline_outputs[i]));
+            parity_streams.emplace_back(new std::istream(bufs.back().get()));
+            input_parities_bufs[i] = parity_streams.back().get();
+        }
+        input_parities_bufs[n_outputs - 1] = &truncated;
+        ASSERT_THROW(
+            fec.decode_packet(
+                input_data_bufs,
+                input_parities_bufs,
+                no_props,
+                output_data_bufs),
+            quadiron::InvalidArgument);
+
+        // packets of fixed size are required by other operations
+        std::vector<off_t> bad_offsets;
+        input_parities_bufs[n_outputs - 1] = &last;
+        ASSERT_THROW(
+            fec.verify_packet(
+                input_data_bufs, input_parities_bufs, props, bad_offsets),
+            quadiron::LogicError);
+        fec.set_inline_props(false);
+    }
 };
 
 using AllTypes = ::testing::Types<uint32_t, uint64_t, __uint128_t>;
@@ -108,6 +493,55 @@ TYPED_TEST(FecTestCommon, TestNf4) // NOLINT
     }
 }
 
+TYPED_TEST(FecTestCommon, TestNf4Planar) // NOLINT
+{
+    const size_t pkt_size = 64;
+    const int iter_count = quadiron::arith::log2<TypeParam>(sizeof(TypeParam));
+
+    for (int i = 1; i < iter_count; i++) {
+        const unsigned word_size = 1 << i;
+        fec::RsNf4<TypeParam> packed_fec(
+            word_size, this->n_data, this->n_parities, pkt_size);
+        fec::RsNf4<TypeParam> planar_fec(
+            word_size, this->n_data, this->n_parities, pkt_size, true);
+        // planes are re-allocated with the policy
+        planar_fec.set_alloc_policy(quadiron::simd::AllocPolicy(
+            quadiron::simd::HugePages::NONE,
+            quadiron::simd::NumaPlacement::FIRST_TOUCH));
+
+        this->run_test_planar(packed_fec, planar_fec);
+        this->run_test_patterns(planar_fec);
+    }
+}
+
+TYPED_TEST(FecTestCommon, TestNf4InlineProps) // NOLINT
+{
+    const size_t pkt_size = 64;
+    const int iter_count = quadiron::arith::log2<TypeParam>(sizeof(TypeParam));
+
+    for (int i = 1; i < iter_count; i++) {
+        const unsigned word_size = 1 << i;
+        fec::RsNf4<TypeParam> fec(
+            word_size, this->n_data, this->n_parities, pkt_size);
+        this->run_test_inline_props(fec);
+    }
+}
+
+TYPED_TEST(FecTestCommon, TestNf4Batch) // NOLINT
+{
+    const int iter_count = quadiron::arith::log2<TypeParam>(sizeof(TypeParam));
+
+    for (int i = 1; i < iter_count; i++) {
+        const unsigned word_size = 1 << i;
+        fec::RsNf4<TypeParam> fec(
+            word_size, this->n_data, this->n_parities, 64);
+        fec::RsNf4<TypeParam> ref_fec(
+            word_size, this->n_data, this->n_parities, 4);
+
+        this->run_test_batch(fec, ref_fec);
+    }
+}
+
 TYPED_TEST(FecTestCommon, TestGf2nFft) // NOLINT
 {
     for (size_t wordsize = 1; wordsize <= sizeof(TypeParam); wordsize *= 2) {
@@ -127,8 +561,612 @@ TYPED_TEST(FecTestCommon, TestGf2nFftAdd) // NOLINT
     }
 }
 
+TYPED_TEST(FecTestCommon, TestGf2nPacket) // NOLINT
+{
+    // packets do not fill the last word of bit-planes
+    const size_t pkt_size = 100;
+
+    // from 4 bytes, fields are too wide to be bit-sliced
+    for (size_t wordsize = 1; wordsize <= sizeof(TypeParam); wordsize *= 2) {
+        for (const fec::RsMatrixType mat_type :
+             {fec::RsMatrixType::VANDERMONDE, fec::RsMatrixType::CAUCHY}) {
+            fec::RsGf2n<TypeParam> fec(
+                wordsize, this->n_data, this->n_parities, mat_type, pkt_size);
+            const size_t frag_size = this->n_packets * fec.buf_size;
+
+            std::vector<std::string> data(this->n_data);
+            for (unsigned i = 0; i < this->n_data; i++) {
+                for (size_t j = 0; j < frag_size; j++) {
+                    data[i].push_back(static_cast<char>(std::rand()));
+                }
+            }
+            std::vector<quadiron::Properties> props(fec.n_outputs);
+            const std::vector<std::string> outputs =
+                this->encode_packets(fec, data, props);
+
+            // packets and words are encoded alike
+            std::vector<std::istringstream> data_streams;
+            std::vector<std::ostringstream> ref_streams(fec.n_outputs);
+            std::vector<std::istream*> input_bufs;
+            std::vector<std::ostream*> ref_bufs;
+            data_streams.reserve(this->n_data);
+            for (unsigned i = 0; i < this->n_data; i++) {
+                data_streams.emplace_back(data[i]);
+                input_bufs.push_back(&data_streams[i]);
+            }
+            for (unsigned i = 0; i < fec.n_outputs; i++) {
+                ref_bufs.push_back(&ref_streams[i]);
+            }
+            std::vector<quadiron::Properties> ref_props(fec.n_outputs);
+            fec.encode_bufs(input_bufs, ref_bufs, ref_props);
+
+            for (unsigned i = 0; i < fec.n_outputs; i++) {
+                ASSERT_EQ(outputs[i], ref_streams[i].str());
+            }
+
+            // lose data fragments, twice to reuse the decoding schedule
+            for (unsigned n_lost = 1; n_lost <= this->n_parities; n_lost++) {
+                for (int iter = 0; iter < 2; iter++) {
+                    std::vector<std::istringstream> streams;
+                    std::vector<std::ostringstream> decoded(this->n_data);
+                    std::vector<std::istream*> data_bufs(this->n_data);
+                    std::vector<std::istream*> parities_bufs(fec.n_outputs);
+                    std::vector<std::ostream*> decoded_bufs;
+                    streams.reserve(this->n_data + fec.n_outputs);
+                    for (unsigned i = 0; i < this->n_data; i++) {
+                        streams.emplace_back(data[i]);
+                        data_bufs[i] = i < n_lost ? nullptr : &streams.back();
+                        decoded_bufs.push_back(&decoded[i]);
+                    }
+                    for (unsigned i = 0; i < fec.n_outputs; i++) {
+                        streams.emplace_back(outputs[i]);
+                        parities_bufs[i] = &streams.back();
+                    }
+                    ASSERT_TRUE(fec.decode_packet(
+                        data_bufs, parities_bufs, props, decoded_bufs));
+                    for (unsigned i = 0; i < n_lost; i++) {
+                        ASSERT_EQ(decoded[i].str(), data[i]);
+                    }
+                }
+            }
+            this->run_test_patterns(fec);
+        }
+    }
+}
+
 template <typename T>
 class FecTestNo128 : public FecTestCommon<T> {
+  public:
+    using FecTestCommon<T>::n_packets;
+    using FecTestCommon<T>::encode_packets;
+
+    /** Check that sessions encode and decode an object striped by packets
+     *
+     * @param fec code with at least 3 parities
+     */
+    void run_test_session(fec::FecCode<T>& fec)
+    {
+        const bool systematic = fec.type == fec::FecType::SYSTEMATIC;
+        const unsigned n_outputs = fec.n_outputs;
+        const unsigned n_frags = (systematic ? this->n_data : 0) + n_outputs;
+        const size_t stripe_size = this->n_data * fec.buf_size;
+        const size_t size = 5 * stripe_size / 2 + 3;
+
+        std::string object;
+        for (size_t j = 0; j < size; j++) {
+            object.push_back(static_cast<char>(std::rand()));
+        }
+
+        // feed chunks of random sizes
+        std::vector<std::string> frags(n_frags);
+        off_t next_offset = 0;
+        fec::EncodeSession<T> encoder(
+            fec,
+            [&](off_t offset, const std::vector<const uint8_t*>& pkts) {
+                ASSERT_EQ(offset, next_offset);
+                ASSERT_EQ(pkts.size(), n_frags);
+                for (unsigned i = 0; i < n_frags; i++) {
+                    frags[i].append(
+                        reinterpret_cast<const char*>(pkts[i]), fec.buf_size);
+                }
+                next_offset += fec.pkt_size;
+            });
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&object[0]);
+        for (size_t pos = 0; pos < size;) {
+            const size_t len = std::min<size_t>(
+                size - pos, 1 + std::rand() % (2 * stripe_size));
+            encoder.feed(bytes + pos, len);
+            pos += len;
+        }
+        encoder.flush();
+        ASSERT_EQ(encoder.get_size(), size);
+        ASSERT_THROW(encoder.feed(bytes, 1), quadiron::LogicError);
+
+        // same fragments as encoding the striped object
+        const size_t n_stripes = (size + stripe_size - 1) / stripe_size;
+        std::string padded(object);
+        padded.resize(n_stripes * stripe_size, 0);
+        std::vector<std::string> data(this->n_data);
+        for (size_t s = 0; s < n_stripes; s++) {
+            for (unsigned i = 0; i < this->n_data; i++) {
+                data[i].append(
+                    padded,
+                    (s * this->n_data + i) * fec.buf_size,
+                    fec.buf_size);
+            }
+        }
+        std::vector<quadiron::Properties> props(n_outputs);
+        const std::vector<std::string> outputs =
+            this->encode_packets(fec, data, props);
+        for (unsigned i = 0; i < n_outputs; i++) {
+            ASSERT_EQ(frags[n_frags - n_outputs + i], outputs[i]);
+            ASSERT_EQ(
+                encoder.get_props()[i].get_map(), props[i].get_map());
+        }
+        if (systematic) {
+            for (unsigned i = 0; i < this->n_data; i++) {
+                ASSERT_EQ(frags[i], data[i]);
+            }
+        }
+
+        const auto check_decode = [&](const std::vector<unsigned>& lost) {
+            std::vector<bool> avail(n_frags, true);
+            for (const unsigned i : lost) {
+                avail[i] = false;
+            }
+            std::string decoded;
+            fec::DecodeSession<T> decoder(
+                fec,
+                avail,
+                encoder.get_props(),
+                size,
+                [&](const uint8_t* data, size_t len) {
+                    decoded.append(reinterpret_cast<const char*>(data), len);
+                });
+            ASSERT_EQ(decoder.get_fragments().size(), this->n_data);
+
+            // chunks of fragments are interleaved
+            std::vector<size_t> pos(n_frags, 0);
+            bool fed = true;
+            while (fed) {
+                fed = false;
+                for (unsigned i = 0; i < n_frags; i++) {
+                    if (!avail[i] || pos[i] == frags[i].size()) {
+                        continue;
+                    }
+                    const size_t len = std::min<size_t>(
+                        frags[i].size() - pos[i], 1 + std::rand() % 50);
+                    decoder.feed(
+                        i,
+                        reinterpret_cast<const uint8_t*>(&frags[i][pos[i]]),
+                        len);
+                    pos[i] += len;
+                    fed = true;
+                }
+            }
+            decoder.flush();
+            ASSERT_EQ(decoded, object);
+        };
+
+        check_decode({});
+        check_decode({0});
+        check_decode({0, 2, 4});
+        check_decode({n_frags - 1, n_frags - 2, n_frags - 3});
+
+        std::vector<bool> too_few(n_frags, false);
+        too_few[0] = true;
+        ASSERT_THROW(
+            fec::DecodeSession<T>(
+                fec, too_few, props, size, [](const uint8_t*, size_t) {}),
+            quadiron::InvalidArgument);
+
+        // sessions must not disturb decoding of other fragments
+        this->run_test_patterns(fec);
+    }
+
+    void run_test_range(fec::FecCode<T>& fec)
+    {
+        const unsigned n_outputs = fec.n_outputs;
+        const size_t frag_size = n_packets * fec.buf_size;
+
+        std::vector<std::string> data(this->n_data);
+        for (unsigned i = 0; i < this->n_data; i++) {
+            for (size_t j = 0; j < frag_size; j++) {
+                data[i].push_back(static_cast<char>(std::rand()));
+            }
+        }
+        std::vector<quadiron::Properties> props(n_outputs);
+        std::vector<std::string> outputs = encode_packets(fec, data, props);
+
+        // ranges: aligned, unaligned, inside a packet, up to the end
+        const std::vector<std::pair<size_t, size_t>> ranges = {
+            {0, frag_size},
+            {fec.buf_size, 2 * fec.buf_size},
+            {fec.buf_size + 3, 2 * fec.buf_size + 1},
+            {3 * fec.buf_size + 1, fec.buf_size / 2},
+            {frag_size - fec.buf_size - 5, fec.buf_size + 5},
+        };
+
+        // input streams are either copied or backed by memory
+        for (auto const& range : ranges) {
+            for (bool in_memory : {false, true}) {
+                run_test_range_streams(
+                    fec, data, outputs, props, range, in_memory);
+            }
+        }
+    }
+
+    /** Decode a range of fragments read from streams copied or in memory */
+    void run_test_range_streams(
+        fec::FecCode<T>& fec,
+        const std::vector<std::string>& data,
+        const std::vector<std::string>& outputs,
+        const std::vector<quadiron::Properties>& props,
+        const std::pair<size_t, size_t>& range,
+        bool in_memory)
+    {
+        const unsigned n_outputs = fec.n_outputs;
+        const bool systematic = fec.type == fec::FecType::SYSTEMATIC;
+
+        std::vector<std::string> areas(data);
+        areas.insert(areas.end(), outputs.begin(), outputs.end());
+        std::vector<std::unique_ptr<std::streambuf>> bufs;
+        std::vector<std::unique_ptr<std::istream>> streams;
+        std::vector<std::ostringstream> output_streams(this->n_data);
+        std::vector<std::istream*> input_data_bufs(this->n_data, nullptr);
+        std::vector<std::istream*> input_parities_bufs(n_outputs, nullptr);
+        std::vector<std::ostream*> output_data_bufs(this->n_data, nullptr);
+
+        for (std::string& area : areas) {
+            if (in_memory) {
+                bufs.emplace_back(new ArrayStreambuf(area));
+            } else {
+                bufs.emplace_back(new std::stringbuf(area));
+            }
+            streams.emplace_back(new std::istream(bufs.back().get()));
+        }
+        for (unsigned i = 0; i < this->n_data; i++) {
+            // only the first data fragment is available
+            if (systematic && i == 1) {
+                input_data_bufs[i] = streams[i].get();
+            } else {
+                output_data_bufs[i] = &output_streams[i];
+            }
+        }
+        // use the last outputs
+        for (unsigned i = 0; i < n_outputs; i++) {
+            if (i >= n_outputs - this->n_data) {
+                input_parities_bufs[i] = streams[this->n_data + i].get();
+            }
+        }
+
+        ASSERT_TRUE(fec.decode_range(
+            input_data_bufs,
+            input_parities_bufs,
+            props,
+            output_data_bufs,
+            range.first,
+            range.second));
+
+        for (unsigned i = 0; i < this->n_data; i++) {
+            if (output_data_bufs[i] != nullptr) {
+                ASSERT_EQ(
+                    output_streams[i].str(),
+                    data[i].substr(range.first, range.second));
+            }
+        }
+    }
+
+    /** Check checksums of fragments followed by `tail` bytes of a packet */
+    void run_test_checksum(fec::FecCode<T>& fec, size_t tail = 0)
+    {
+        const unsigned n_outputs = fec.n_outputs;
+        const bool systematic = fec.type == fec::FecType::SYSTEMATIC;
+        // only whole packets are encoded and hashed
+        const size_t pkts_size = n_packets * fec.buf_size;
+        const size_t frag_size = pkts_size + tail;
+
+        std::vector<std::string> data(this->n_data);
+        for (unsigned i = 0; i < this->n_data; i++) {
+            for (size_t j = 0; j < frag_size; j++) {
+                data[i].push_back(static_cast<char>(std::rand()));
+            }
+        }
+        std::vector<quadiron::Properties> props(n_outputs);
+        std::vector<uint32_t> data_checksums;
+        std::vector<uint32_t> parities_checksums;
+        std::vector<std::string> outputs = encode_packets(
+            fec, data, props, &data_checksums, &parities_checksums);
+
+        for (unsigned i = 0; i < this->n_data; i++) {
+            ASSERT_EQ(
+                data_checksums[i],
+                quadiron::crc32c(
+                    0,
+                    reinterpret_cast<const uint8_t*>(data[i].data()),
+                    pkts_size));
+        }
+        for (unsigned i = 0; i < n_outputs; i++) {
+            ASSERT_EQ(
+                parities_checksums[i],
+                quadiron::crc32c(
+                    0,
+                    reinterpret_cast<const uint8_t*>(outputs[i].data()),
+                    outputs[i].size()));
+        }
+
+        // decode with intact then corrupted fragments
+        for (bool corrupt : {false, true}) {
+            if (corrupt) {
+                outputs[n_outputs - this->n_data][fec.buf_size + 1] ^= 1;
+            }
+            std::vector<std::istringstream> data_streams;
+            std::vector<std::istringstream> parity_streams;
+            std::vector<std::ostringstream> output_streams(this->n_data);
+            std::vector<std::istream*> input_data_bufs(this->n_data, nullptr);
+            std::vector<std::istream*> input_parities_bufs(n_outputs, nullptr);
+            std::vector<std::ostream*> output_data_bufs(this->n_data, nullptr);
+
+            data_streams.reserve(this->n_data);
+            parity_streams.reserve(n_outputs);
+            for (unsigned i = 0; i < this->n_data; i++) {
+                data_streams.emplace_back(data[i]);
+                if (systematic && i == 1) {
+                    input_data_bufs[i] = &data_streams[i];
+                } else {
+                    output_data_bufs[i] = &output_streams[i];
+                }
+            }
+            for (unsigned i = 0; i < n_outputs; i++) {
+                parity_streams.emplace_back(outputs[i]);
+                if (i >= n_outputs - this->n_data) {
+                    input_parities_bufs[i] = &parity_streams[i];
+                }
+            }
+
+            ASSERT_EQ(
+                fec.decode_packet(
+                    input_data_bufs,
+                    input_parities_bufs,
+                    props,
+                    output_data_bufs,
+                    &data_checksums,
+                    &parities_checksums),
+                !corrupt);
+        }
+        if (!systematic) {
+            return;
+        }
+
+        // all data fragments are available: nothing to decode
+        for (bool corrupt : {false, true}) {
+            if (corrupt) {
+                data[0][fec.buf_size + 1] ^= 1;
+            }
+            std::vector<std::istringstream> data_streams;
+            std::vector<std::istream*> input_data_bufs;
+            std::vector<std::istream*> input_parities_bufs(n_outputs, nullptr);
+            std::vector<std::ostream*> output_data_bufs(this->n_data, nullptr);
+
+            data_streams.reserve(this->n_data);
+            for (unsigned i = 0; i < this->n_data; i++) {
+                data_streams.emplace_back(data[i]);
+                input_data_bufs.push_back(&data_streams[i]);
+            }
+
+            ASSERT_EQ(
+                fec.decode_packet(
+                    input_data_bufs,
+                    input_parities_bufs,
+                    props,
+                    output_data_bufs,
+                    &data_checksums,
+                    &parities_checksums),
+                !corrupt);
+        }
+    }
+
+    void run_test_memory(fec::FecCode<T>& fec)
+    {
+        const unsigned n_outputs = fec.n_outputs;
+        const bool systematic = fec.type == fec::FecType::SYSTEMATIC;
+        const size_t frag_size = n_packets * fec.buf_size;
+
+        std::vector<std::string> data(this->n_data);
+        for (unsigned i = 0; i < this->n_data; i++) {
+            for (size_t j = 0; j < frag_size; j++) {
+                data[i].push_back(static_cast<char>(std::rand()));
+            }
+        }
+        std::vector<quadiron::Properties> props(n_outputs);
+        const std::vector<std::string> outputs =
+            encode_packets(fec, data, props);
+
+        // encode from and to memory
+        std::vector<std::string> mem_data(data);
+        std::vector<std::string> mem_outputs(
+            n_outputs, std::string(frag_size, 0));
+        std::vector<std::unique_ptr<ArrayStreambuf>> bufs;
+        std::vector<std::unique_ptr<std::iostream>> streams;
+        std::vector<std::istream*> input_bufs;
+        std::vector<std::ostream*> output_bufs;
+        for (unsigned i = 0; i < this->n_data; i++) {
+            bufs.emplace_back(new ArrayStreambuf(mem_data[i]));
+            streams.emplace_back(new std::iostream(bufs.back().get()));
+            input_bufs.push_back(streams.back().get());
+        }
+        for (unsigned i = 0; i < n_outputs; i++) {
+            bufs.emplace_back(new ArrayStreambuf(mem_outputs[i]));
+            streams.emplace_back(new std::iostream(bufs.back().get()));
+            output_bufs.push_back(streams.back().get());
+        }
+        std::vector<quadiron::Properties> mem_props(n_outputs);
+        fec.encode_packet(input_bufs, output_bufs, mem_props);
+
+        ASSERT_EQ(mem_outputs, outputs);
+        for (unsigned i = 0; i < n_outputs; i++) {
+            std::ostringstream expected;
+            std::ostringstream actual;
+            expected << props[i];
+            actual << mem_props[i];
+            ASSERT_EQ(actual.str(), expected.str());
+        }
+
+        // decode from and to memory, with the last outputs
+        std::vector<std::string> mem_repaired(
+            this->n_data, std::string(frag_size, 0));
+        std::vector<std::istream*> input_data_bufs(this->n_data, nullptr);
+        std::vector<std::istream*> input_parities_bufs(n_outputs, nullptr);
+        std::vector<std::ostream*> output_data_bufs(this->n_data, nullptr);
+        for (unsigned i = 0; i < this->n_data; i++) {
+            if (systematic && i == 1) {
+                bufs.emplace_back(new ArrayStreambuf(mem_data[i]));
+                streams.emplace_back(new std::iostream(bufs.back().get()));
+                input_data_bufs[i] = streams.back().get();
+            } else {
+                bufs.emplace_back(new ArrayStreambuf(mem_repaired[i]));
+                streams.emplace_back(new std::iostream(bufs.back().get()));
+                output_data_bufs[i] = streams.back().get();
+            }
+        }
+        for (unsigned i = n_outputs - this->n_data; i < n_outputs; i++) {
+            bufs.emplace_back(new ArrayStreambuf(mem_outputs[i]));
+            streams.emplace_back(new std::iostream(bufs.back().get()));
+            input_parities_bufs[i] = streams.back().get();
+        }
+
+        ASSERT_TRUE(fec.decode_packet(
+            input_data_bufs, input_parities_bufs, props, output_data_bufs));
+        for (unsigned i = 0; i < this->n_data; i++) {
+            if (output_data_bufs[i] != nullptr) {
+                ASSERT_EQ(mem_repaired[i], data[i]);
+            }
+        }
+    }
+
+    void run_test_verify(fec::FecCode<T>& fec)
+    {
+        const unsigned n_outputs = fec.n_outputs;
+        const bool systematic = fec.type == fec::FecType::SYSTEMATIC;
+        const size_t frag_size = n_packets * fec.buf_size;
+
+        std::vector<std::string> data(this->n_data);
+        for (unsigned i = 0; i < this->n_data; i++) {
+            for (size_t j = 0; j < frag_size; j++) {
+                data[i].push_back(static_cast<char>(std::rand()));
+            }
+        }
+        std::vector<quadiron::Properties> props(n_outputs);
+        std::vector<std::string> outputs = encode_packets(fec, data, props);
+
+        // intact, then a corrupted output, then also a corrupted data
+        for (int step = 0; step < 3; step++) {
+            std::vector<off_t> expected;
+            if (step == 1) {
+                outputs[n_outputs - 1][2 * fec.buf_size + 3] ^= 1;
+            }
+            if (step >= 1) {
+                expected.push_back(2 * fec.pkt_size);
+            }
+            if (step == 2) {
+                // data are not stored if NON_SYSTEMATIC, corrupt another output
+                std::string& frag = systematic ? data[1] : outputs[0];
+                frag[5 * fec.buf_size] ^= 0x80;
+                expected.push_back(5 * fec.pkt_size);
+            }
+
+            std::vector<std::istringstream> data_streams;
+            std::vector<std::istringstream> parity_streams;
+            std::vector<std::istream*> input_data_bufs;
+            std::vector<std::istream*> input_parities_bufs;
+            data_streams.reserve(this->n_data);
+            parity_streams.reserve(n_outputs);
+            for (unsigned i = 0; i < this->n_data; i++) {
+                data_streams.emplace_back(data[i]);
+                input_data_bufs.push_back(&data_streams[i]);
+            }
+            for (unsigned i = 0; i < n_outputs; i++) {
+                parity_streams.emplace_back(outputs[i]);
+                input_parities_bufs.push_back(&parity_streams[i]);
+            }
+
+            std::vector<off_t> bad_offsets;
+            ASSERT_EQ(
+                fec.verify_packet(
+                    input_data_bufs, input_parities_bufs, props, bad_offsets),
+                expected.empty());
+            ASSERT_EQ(bad_offsets, expected);
+        }
+    }
+
+    void run_test_update(fec::FecCode<T>& fec)
+    {
+        const unsigned n_outputs = fec.n_outputs;
+        const size_t frag_size = n_packets * fec.buf_size;
+        const size_t first_pkt = 2;
+        const size_t nb_pkt = 3;
+        const size_t range_begin = first_pkt * fec.buf_size;
+        const size_t range_len = nb_pkt * fec.buf_size;
+
+        for (unsigned frag_index = 0; frag_index < this->n_data; frag_index++) {
+            std::vector<std::string> data(this->n_data);
+            for (unsigned i = 0; i < this->n_data; i++) {
+                for (size_t j = 0; j < frag_size; j++) {
+                    data[i].push_back(static_cast<char>(std::rand()));
+                }
+            }
+            std::vector<quadiron::Properties> props(n_outputs);
+            std::vector<std::string> outputs =
+                encode_packets(fec, data, props);
+
+            // overwrite a range of the data fragment
+            std::string old_range =
+                data[frag_index].substr(range_begin, range_len);
+            std::string new_range;
+            for (size_t j = 0; j < range_len; j++) {
+                new_range.push_back(static_cast<char>(std::rand()));
+            }
+            data[frag_index].replace(range_begin, range_len, new_range);
+
+            std::istringstream old_stream(old_range);
+            std::istringstream new_stream(new_range);
+            std::vector<std::istringstream> input_streams;
+            std::vector<std::ostringstream> output_streams(n_outputs);
+            std::vector<std::istream*> input_bufs;
+            std::vector<std::ostream*> output_bufs;
+            input_streams.reserve(n_outputs);
+            for (unsigned i = 0; i < n_outputs; i++) {
+                input_streams.emplace_back(
+                    outputs[i].substr(range_begin, range_len));
+                input_bufs.push_back(&input_streams[i]);
+                output_bufs.push_back(&output_streams[i]);
+            }
+
+            fec.update_packet(
+                frag_index,
+                range_begin,
+                &old_stream,
+                &new_stream,
+                input_bufs,
+                output_bufs,
+                props);
+
+            for (unsigned i = 0; i < n_outputs; i++) {
+                outputs[i].replace(
+                    range_begin, range_len, output_streams[i].str());
+            }
+
+            // compare with a full encoding of the updated data
+            std::vector<quadiron::Properties> expected_props(n_outputs);
+            std::vector<std::string> expected =
+                encode_packets(fec, data, expected_props);
+
+            ASSERT_EQ(outputs, expected);
+            for (unsigned i = 0; i < n_outputs; i++) {
+                ASSERT_EQ(props[i].get_map(), expected_props[i].get_map());
+            }
+        }
+    }
 };
 
 using No128 = ::testing::Types<uint32_t, uint64_t>;
@@ -158,6 +1196,34 @@ TYPED_TEST(FecTestNo128, TestFntSys) // NOLINT
     }
 }
 
+TYPED_TEST(FecTestNo128, TestFntAllocPolicy) // NOLINT
+{
+    const quadiron::simd::AllocPolicy policy(
+        quadiron::simd::HugePages::TRANSPARENT,
+        quadiron::simd::NumaPlacement::BIND_LOCAL);
+
+    for (auto type : {fec::FecType::SYSTEMATIC, fec::FecType::NON_SYSTEMATIC}) {
+        fec::RsFnt<TypeParam> fec(type, 2, this->n_data, this->n_parities);
+        fec.set_alloc_policy(policy);
+        ASSERT_EQ(fec.get_alloc_policy(), policy);
+        this->run_test(fec, true);
+    }
+}
+
+TYPED_TEST(FecTestNo128, TestFntBatch) // NOLINT
+{
+    for (unsigned word_size = 1; word_size <= 2; ++word_size) {
+        for (auto type :
+             {fec::FecType::SYSTEMATIC, fec::FecType::NON_SYSTEMATIC}) {
+            fec::RsFnt<TypeParam> fec(
+                type, word_size, this->n_data, this->n_parities, 64);
+            fec::RsFnt<TypeParam> ref_fec(
+                type, word_size, this->n_data, this->n_parities, 4);
+            this->run_test_batch(fec, ref_fec);
+        }
+    }
+}
+
 TYPED_TEST(FecTestNo128, TestGfpFft) // NOLINT
 {
     for (size_t word_size = 1; word_size <= 4 && word_size < sizeof(TypeParam);
@@ -167,3 +1233,530 @@ TYPED_TEST(FecTestNo128, TestGfpFft) // NOLINT
         this->run_test(fec, true);
     }
 }
+
+TYPED_TEST(FecTestNo128, TestFntUpdate) // NOLINT
+{
+    const size_t pkt_size = 64;
+
+    for (unsigned word_size = 1; word_size <= 2; ++word_size) {
+        for (auto type :
+             {fec::FecType::SYSTEMATIC, fec::FecType::NON_SYSTEMATIC}) {
+            fec::RsFnt<TypeParam> fec(
+                type, word_size, this->n_data, this->n_parities, pkt_size);
+            this->run_test_update(fec);
+        }
+    }
+}
+
+TYPED_TEST(FecTestNo128, TestFntRange) // NOLINT
+{
+    const size_t pkt_size = 64;
+
+    for (unsigned word_size = 1; word_size <= 2; ++word_size) {
+        for (auto type :
+             {fec::FecType::SYSTEMATIC, fec::FecType::NON_SYSTEMATIC}) {
+            fec::RsFnt<TypeParam> fec(
+                type, word_size, this->n_data, this->n_parities, pkt_size);
+            this->run_test_range(fec);
+        }
+    }
+}
+
+TYPED_TEST(FecTestNo128, TestFntChecksum) // NOLINT
+{
+    const size_t pkt_size = 64;
+
+    for (unsigned word_size = 1; word_size <= 2; ++word_size) {
+        for (auto type :
+             {fec::FecType::SYSTEMATIC, fec::FecType::NON_SYSTEMATIC}) {
+            fec::RsFnt<TypeParam> fec(
+                type, word_size, this->n_data, this->n_parities, pkt_size);
+            this->run_test_checksum(fec);
+            this->run_test_checksum(fec, 3);
+        }
+    }
+}
+
+TYPED_TEST(FecTestNo128, TestFntMemory) // NOLINT
+{
+    const size_t pkt_size = 64;
+
+    for (unsigned word_size = 1; word_size <= 2; ++word_size) {
+        for (auto type :
+             {fec::FecType::SYSTEMATIC, fec::FecType::NON_SYSTEMATIC}) {
+            fec::RsFnt<TypeParam> fec(
+                type, word_size, this->n_data, this->n_parities, pkt_size);
+            this->run_test_memory(fec);
+        }
+    }
+}
+
+#ifdef QUADIRON_USE_STATS
+TYPED_TEST(FecTestNo128, TestFntStats) // NOLINT
+{
+    const size_t pkt_size = 64;
+    fec::RsFnt<TypeParam> fec(
+        fec::FecType::SYSTEMATIC, 2, this->n_data, this->n_parities, pkt_size);
+    const size_t frag_size = this->n_packets * fec.buf_size;
+
+    std::vector<std::string> data(this->n_data, std::string(frag_size, 'a'));
+    std::vector<quadiron::Properties> props(fec.n_outputs);
+
+    quadiron::fec::reset_all_threads_stats();
+    this->encode_packets(fec, data, props);
+
+    const quadiron::fec::Stats& stats = fec.stats;
+    for (auto phase : {quadiron::fec::Phase::READ,
+                       quadiron::fec::Phase::PACK,
+                       quadiron::fec::Phase::ENCODE,
+                       quadiron::fec::Phase::POST_PROCESS,
+                       quadiron::fec::Phase::UNPACK,
+                       quadiron::fec::Phase::WRITE}) {
+        ASSERT_EQ(stats.get(phase).calls, this->n_packets);
+    }
+    ASSERT_EQ(stats.get(quadiron::fec::Phase::DECODE).calls, 0);
+    ASSERT_EQ(
+        stats.get(quadiron::fec::Phase::ENCODE).bytes,
+        this->n_data * frag_size);
+    ASSERT_EQ(stats.get_n_ops(), 1);
+    ASSERT_GT(stats.get_wall_ns(), 0);
+
+    // operations are accumulated per thread
+    this->encode_packets(fec, data, props);
+    ASSERT_EQ(quadiron::fec::get_thread_stats().get_n_ops(), 2);
+    ASSERT_EQ(quadiron::fec::get_all_threads_stats().get_n_ops(), 2);
+
+    fec.set_stats_enabled(false);
+    this->encode_packets(fec, data, props);
+    ASSERT_EQ(fec.stats.get(quadiron::fec::Phase::ENCODE).calls, 0);
+    ASSERT_EQ(quadiron::fec::get_thread_stats().get_n_ops(), 2);
+}
+#endif // #ifdef QUADIRON_USE_STATS
+
+TYPED_TEST(FecTestNo128, TestFntInlineProps) // NOLINT
+{
+    const size_t pkt_size = 64;
+
+    for (unsigned word_size = 1; word_size <= 2; ++word_size) {
+        for (auto type :
+             {fec::FecType::SYSTEMATIC, fec::FecType::NON_SYSTEMATIC}) {
+            fec::RsFnt<TypeParam> fec(
+                type, word_size, this->n_data, this->n_parities, pkt_size);
+            this->run_test_inline_props(fec);
+        }
+    }
+}
+
+TYPED_TEST(FecTestNo128, TestFntDecodeAlgo) // NOLINT
+{
+    const size_t pkt_size = 64;
+
+    // a single missing data fragment is decoded directly
+    fec::RsFnt<TypeParam> small(
+        fec::FecType::SYSTEMATIC, 2, this->n_data, this->n_parities, pkt_size);
+    quadiron::vec::Vector<TypeParam> ids(small.get_gf(), this->n_data);
+    for (unsigned i = 0; i < this->n_data; i++) {
+        ids.set(i, i + 1);
+    }
+    ASSERT_EQ(small.get_decode_algo(ids), fec::DecodeAlgo::DIRECT);
+
+    // all data of a large NON_SYSTEMATIC code are interpolated by FFT
+    fec::RsFnt<TypeParam> large(fec::FecType::NON_SYSTEMATIC, 2, 32, 16);
+    quadiron::vec::Vector<TypeParam> large_ids(large.get_gf(), 32);
+    for (unsigned i = 0; i < 32; i++) {
+        large_ids.set(i, i);
+    }
+    ASSERT_EQ(large.get_decode_algo(large_ids), fec::DecodeAlgo::FFT);
+    large.set_decode_algo(fec::DecodeAlgo::DIRECT);
+    ASSERT_EQ(large.get_decode_algo(large_ids), fec::DecodeAlgo::DIRECT);
+
+    // every algorithm decodes every erasure pattern
+    for (unsigned word_size = 1; word_size <= 2; ++word_size) {
+        for (auto type :
+             {fec::FecType::SYSTEMATIC, fec::FecType::NON_SYSTEMATIC}) {
+            fec::RsFnt<TypeParam> fec(
+                type, word_size, this->n_data, this->n_parities, pkt_size);
+            const bool systematic = type == fec::FecType::SYSTEMATIC;
+            const unsigned n_outputs = fec.n_outputs;
+            const unsigned code_len = this->n_data + this->n_parities;
+            const size_t frag_size = this->n_packets * fec.buf_size;
+
+            std::vector<std::string> data(this->n_data);
+            for (unsigned i = 0; i < this->n_data; i++) {
+                for (size_t j = 0; j < frag_size; j++) {
+                    data[i].push_back(static_cast<char>(std::rand()));
+                }
+            }
+            std::vector<quadiron::Properties> props(n_outputs);
+            const std::vector<std::string> outputs =
+                this->encode_packets(fec, data, props);
+
+            for (auto algo : {fec::DecodeAlgo::AUTO,
+                              fec::DecodeAlgo::FFT,
+                              fec::DecodeAlgo::DIRECT}) {
+                fec.set_decode_algo(algo);
+                for (unsigned mask = 0; mask < (1U << code_len); mask++) {
+                    std::vector<unsigned> avail;
+                    for (unsigned i = 0; i < code_len; i++) {
+                        if (mask & (1U << i)) {
+                            avail.push_back(i);
+                        }
+                    }
+                    if (avail.size() != this->n_data) {
+                        continue;
+                    }
+                    std::vector<std::istringstream> streams;
+                    std::vector<std::istream*> in_data(this->n_data, nullptr);
+                    std::vector<std::istream*> in_parities(n_outputs, nullptr);
+                    std::vector<std::ostringstream> decoded(this->n_data);
+                    std::vector<std::ostream*> out_data;
+                    streams.reserve(this->n_data);
+                    for (const unsigned i : avail) {
+                        if (systematic && i < this->n_data) {
+                            streams.emplace_back(data[i]);
+                            in_data[i] = &streams.back();
+                        } else {
+                            const unsigned j =
+                                systematic ? i - this->n_data : i;
+                            streams.emplace_back(outputs[j]);
+                            in_parities[j] = &streams.back();
+                        }
+                    }
+                    for (unsigned i = 0; i < this->n_data; i++) {
+                        out_data.push_back(&decoded[i]);
+                    }
+                    ASSERT_TRUE(fec.decode_packet(
+                        in_data, in_parities, props, out_data));
+                    for (unsigned i = 0; i < this->n_data; i++) {
+                        if (systematic && in_data[i] != nullptr) {
+                            continue;
+                        }
+                        ASSERT_EQ(decoded[i].str(), data[i]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TYPED_TEST(FecTestNo128, TestFntVerify) // NOLINT
+{
+    const size_t pkt_size = 64;
+
+    for (unsigned word_size = 1; word_size <= 2; ++word_size) {
+        for (auto type :
+             {fec::FecType::SYSTEMATIC, fec::FecType::NON_SYSTEMATIC}) {
+            fec::RsFnt<TypeParam> fec(
+                type, word_size, this->n_data, this->n_parities, pkt_size);
+            this->run_test_verify(fec);
+        }
+    }
+}
+
+TYPED_TEST(FecTestNo128, TestLrc) // NOLINT
+{
+    const unsigned n_data = 6;
+    const unsigned n_groups = 2;
+    fec::RsFnt<TypeParam> global(fec::FecType::SYSTEMATIC, 2, n_data, 3, 8);
+    fec::Lrc<TypeParam> lrc(global, n_groups);
+    const unsigned n_frags = lrc.get_n_fragments();
+    const unsigned n_global = global.n_outputs;
+    const size_t frag_size = this->n_packets * global.buf_size;
+
+    ASSERT_EQ(n_frags, n_data + n_groups + n_global);
+    ASSERT_THROW(fec::Lrc<TypeParam>(global, 0), quadiron::InvalidArgument);
+
+    std::vector<std::string> frags(n_frags);
+    for (unsigned i = 0; i < n_data; i++) {
+        for (size_t j = 0; j < frag_size; j++) {
+            frags[i].push_back(static_cast<char>(std::rand()));
+        }
+    }
+
+    std::vector<std::istringstream> data_streams;
+    std::vector<std::ostringstream> local_streams(n_groups);
+    std::vector<std::ostringstream> global_streams(n_global);
+    std::vector<std::istream*> data_bufs;
+    std::vector<std::ostream*> local_bufs;
+    std::vector<std::ostream*> global_bufs;
+    std::vector<quadiron::Properties> props(n_global);
+    data_streams.reserve(n_data);
+    for (unsigned i = 0; i < n_data; i++) {
+        data_streams.emplace_back(frags[i]);
+        data_bufs.push_back(&data_streams[i]);
+    }
+    for (unsigned g = 0; g < n_groups; g++) {
+        local_bufs.push_back(&local_streams[g]);
+    }
+    for (unsigned i = 0; i < n_global; i++) {
+        global_bufs.push_back(&global_streams[i]);
+    }
+    lrc.encode(data_bufs, local_bufs, global_bufs, props);
+    for (unsigned g = 0; g < n_groups; g++) {
+        frags[n_data + g] = local_streams[g].str();
+    }
+    for (unsigned i = 0; i < n_global; i++) {
+        frags[n_data + n_groups + i] = global_streams[i].str();
+    }
+
+    // local parities are the XOR of their groups
+    for (unsigned g = 0; g < n_groups; g++) {
+        std::string parity(frag_size, 0);
+        for (const unsigned i : lrc.get_group_members(g)) {
+            if (i < n_data) {
+                for (size_t j = 0; j < frag_size; j++) {
+                    parity[j] ^= frags[i][j];
+                }
+            }
+        }
+        ASSERT_EQ(frags[n_data + g], parity);
+    }
+
+    const auto check_repair = [&](unsigned lost,
+                                  const std::vector<unsigned>& erased,
+                                  bool local,
+                                  size_t n_reads) {
+        std::vector<bool> avail(n_frags, true);
+        avail[lost] = false;
+        for (const unsigned i : erased) {
+            avail[i] = false;
+        }
+        const fec::RepairPlan plan = lrc.plan_repair(lost, avail);
+        ASSERT_EQ(plan.local, local);
+        ASSERT_EQ(plan.reads.size(), n_reads);
+
+        std::vector<std::istringstream> streams;
+        std::vector<std::istream*> inputs(n_frags, nullptr);
+        streams.reserve(n_frags);
+        for (const unsigned i : plan.reads) {
+            ASSERT_TRUE(avail[i]);
+            streams.emplace_back(frags[i]);
+            inputs[i] = &streams.back();
+        }
+        std::ostringstream output;
+        quadiron::Properties output_props;
+        ASSERT_EQ(
+            lrc.repair(lost, plan, inputs, props, &output, &output_props),
+            n_reads > 0);
+        if (n_reads == 0) {
+            return;
+        }
+        ASSERT_EQ(output.str(), frags[lost]);
+        if (lost >= n_data + n_groups) {
+            ASSERT_EQ(
+                output_props.get_map(),
+                props[lost - n_data - n_groups].get_map());
+        }
+    };
+
+    // a single loss is repaired from its group
+    const size_t group_size = n_data / n_groups;
+    for (unsigned lost = 0; lost < n_data + n_groups; lost++) {
+        check_repair(lost, {}, true, group_size);
+    }
+    for (unsigned lost = n_data + n_groups; lost < n_frags; lost++) {
+        check_repair(lost, {}, false, n_data);
+    }
+
+    // other losses fall back to the global code
+    check_repair(0, {1}, false, n_data);
+    check_repair(n_data, {0}, false, n_data);
+    check_repair(n_data + n_groups, {0}, false, n_data);
+    check_repair(0, {1, 2, 3}, false, 0);
+}
+
+TYPED_TEST(FecTestNo128, TestPiggyback) // NOLINT
+{
+    const unsigned n_data = 4;
+    const unsigned n_parities = 3;
+    const unsigned code_len = n_data + n_parities;
+    fec::RsPiggyback<TypeParam> fec(2, n_data, n_parities, 8);
+    fec::RsFnt<TypeParam> rs(fec::FecType::SYSTEMATIC, 2, n_data, 3, 8);
+    const size_t frag_size = this->n_packets * fec.buf_size;
+
+    ASSERT_THROW(
+        fec::RsPiggyback<TypeParam>(2, n_data, 1, 8),
+        quadiron::InvalidArgument);
+    ASSERT_THROW(
+        fec::RsPiggyback<TypeParam>(2, n_data, n_parities, 7),
+        quadiron::InvalidArgument);
+
+    std::vector<std::string> frags(code_len);
+    for (unsigned i = 0; i < n_data; i++) {
+        for (size_t j = 0; j < frag_size; j++) {
+            frags[i].push_back(static_cast<char>(std::rand()));
+        }
+    }
+
+    std::vector<std::istringstream> data_streams;
+    std::vector<std::ostringstream> output_streams(n_parities);
+    std::vector<std::istream*> data_bufs;
+    std::vector<std::ostream*> output_bufs;
+    std::vector<quadiron::Properties> props(n_parities);
+    data_streams.reserve(n_data);
+    for (unsigned i = 0; i < n_data; i++) {
+        data_streams.emplace_back(frags[i]);
+        data_bufs.push_back(&data_streams[i]);
+    }
+    for (unsigned i = 0; i < n_parities; i++) {
+        output_bufs.push_back(&output_streams[i]);
+    }
+    fec.encode_packet(data_bufs, output_bufs, props);
+    for (unsigned i = 0; i < n_parities; i++) {
+        frags[n_data + i] = output_streams[i].str();
+    }
+
+    // the first parity is not piggybacked
+    std::vector<std::ostringstream> rs_streams(n_parities);
+    std::vector<std::ostream*> rs_bufs;
+    std::vector<quadiron::Properties> rs_props(n_parities);
+    for (unsigned i = 0; i < n_data; i++) {
+        data_streams[i].clear();
+        data_streams[i].seekg(0);
+    }
+    for (unsigned i = 0; i < n_parities; i++) {
+        rs_bufs.push_back(&rs_streams[i]);
+    }
+    rs.encode_packet(data_bufs, rs_bufs, rs_props);
+    ASSERT_EQ(frags[n_data], rs_streams[0].str());
+    ASSERT_EQ(props[0].get_map(), rs_props[0].get_map());
+    ASSERT_NE(frags[n_data + 1], rs_streams[1].str());
+
+    // decode from any n_data fragments
+    for (unsigned mask = 0; mask < (1U << code_len); mask++) {
+        std::vector<unsigned> avail;
+        for (unsigned i = 0; i < code_len; i++) {
+            if (mask & (1U << i)) {
+                avail.push_back(i);
+            }
+        }
+        if (avail.size() != n_data) {
+            continue;
+        }
+        std::vector<std::istringstream> streams;
+        std::vector<std::istream*> in_data(n_data, nullptr);
+        std::vector<std::istream*> in_parities(n_parities, nullptr);
+        std::vector<std::ostringstream> decoded(n_data);
+        std::vector<std::ostream*> out_data;
+        streams.reserve(n_data);
+        for (const unsigned i : avail) {
+            streams.emplace_back(frags[i]);
+            if (i < n_data) {
+                in_data[i] = &streams.back();
+            } else {
+                in_parities[i - n_data] = &streams.back();
+            }
+        }
+        for (unsigned i = 0; i < n_data; i++) {
+            out_data.push_back(in_data[i] ? nullptr : &decoded[i]);
+        }
+        ASSERT_TRUE(fec.decode_packet(in_data, in_parities, props, out_data));
+        for (unsigned i = 0; i < n_data; i++) {
+            if (in_data[i] == nullptr) {
+                ASSERT_EQ(decoded[i].str(), frags[i]);
+            }
+        }
+    }
+
+    // substripes served for repairs
+    std::vector<std::string> subs_a(code_len);
+    std::vector<std::string> subs_b(code_len);
+    for (unsigned i = 0; i < code_len; i++) {
+        std::istringstream frag(frags[i]);
+        std::ostringstream sub_a;
+        std::ostringstream sub_b;
+        fec.split_substripes(frag, sub_a, sub_b);
+        subs_a[i] = sub_a.str();
+        subs_b[i] = sub_b.str();
+        ASSERT_EQ(subs_a[i].size(), frag_size / 2);
+    }
+
+    const auto check_repair = [&](unsigned lost,
+                                  const std::vector<unsigned>& erased,
+                                  bool piggyback,
+                                  size_t n_reads) {
+        std::vector<bool> avail(code_len, true);
+        avail[lost] = false;
+        for (const unsigned i : erased) {
+            avail[i] = false;
+        }
+        const fec::PiggybackRepairPlan plan = fec.plan_repair(lost, avail);
+        ASSERT_EQ(plan.piggyback, piggyback);
+        ASSERT_EQ(plan.reads_a.size() + plan.reads_b.size(), n_reads);
+
+        std::vector<std::istringstream> streams;
+        std::vector<std::istream*> inputs_a(code_len, nullptr);
+        std::vector<std::istream*> inputs_b(code_len, nullptr);
+        streams.reserve(2 * code_len);
+        for (const unsigned i : plan.reads_a) {
+            ASSERT_TRUE(avail[i]);
+            streams.emplace_back(subs_a[i]);
+            inputs_a[i] = &streams.back();
+        }
+        for (const unsigned i : plan.reads_b) {
+            ASSERT_TRUE(avail[i]);
+            streams.emplace_back(subs_b[i]);
+            inputs_b[i] = &streams.back();
+        }
+        std::ostringstream output;
+        quadiron::Properties output_props;
+        ASSERT_EQ(
+            fec.repair(
+                lost, plan, inputs_a, inputs_b, props, &output, &output_props),
+            n_reads > 0);
+        if (n_reads == 0) {
+            return;
+        }
+        ASSERT_EQ(output.str(), frags[lost]);
+        if (lost >= n_data) {
+            ASSERT_EQ(output_props.get_map(), props[lost - n_data].get_map());
+        }
+    };
+
+    // a data fragment is repaired from n_data + |S_i| substripes
+    for (unsigned lost = 0; lost < n_data; lost++) {
+        const size_t group_size =
+            fec.get_group(fec.get_piggyback(lost)).size();
+        check_repair(lost, {}, true, n_data + group_size);
+    }
+
+    // other repairs read n_data whole fragments
+    for (unsigned lost = n_data; lost < code_len; lost++) {
+        check_repair(lost, {}, false, 2 * n_data);
+    }
+    check_repair(0, {n_data + 1}, false, 2 * n_data);
+    check_repair(n_data + 1, {0, 1}, false, 2 * n_data);
+    check_repair(0, {1, 2, 3}, false, 0);
+
+    // packets are updated and verified with piggybacks
+    fec::RsPiggyback<TypeParam> small_fec(
+        2, this->n_data, this->n_parities, 8);
+    this->run_test_update(small_fec);
+    this->run_test_verify(small_fec);
+}
+
+TYPED_TEST(FecTestNo128, TestSession) // NOLINT
+{
+    const size_t pkt_size = 8;
+
+    for (auto type :
+         {fec::FecType::SYSTEMATIC, fec::FecType::NON_SYSTEMATIC}) {
+        fec::RsFnt<TypeParam> fec(
+            type, 2, this->n_data, this->n_parities, pkt_size);
+        this->run_test_session(fec);
+    }
+
+    fec::RsNf4<TypeParam> nf4_fec(
+        2, this->n_data, this->n_parities, pkt_size, true);
+    this->run_test_session(nf4_fec);
+
+    for (size_t word_size = 1; word_size <= 2; word_size *= 2) {
+        fec::RsGf2n<TypeParam> gf2n_fec(
+            word_size,
+            this->n_data,
+            this->n_parities,
+            fec::RsMatrixType::CAUCHY,
+            pkt_size);
+        this->run_test_session(gf2n_fec);
+    }
+}
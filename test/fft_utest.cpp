@@ -37,6 +37,7 @@
 #include "fft_single.h"
 #include "gf_bin_ext.h"
 #include "gf_prime.h"
+#include "simd.h"
 
 namespace fft = quadiron::fft;
 namespace gf = quadiron::gf;
@@ -335,6 +336,43 @@ TYPED_TEST(FftTest, TestNaiveVsFft2kVecp) // NOLINT
     }
 }
 
+TYPED_TEST(FftTest, TestNaiveVsFft2kVecpLayers) // NOLINT
+{
+    auto gf(gf::create<gf::Prime<TypeParam>>(this->q));
+    // vectorized elements followed by trailing ones
+    const size_t size = 37;
+
+    // all combinations of layers processed three, two or one at a time
+    for (unsigned n = 2; n <= 256; n *= 2) {
+        const unsigned r = gf.get_nth_root(n);
+        fft::Naive<TypeParam> fft_naive(gf, n, r, size);
+
+        for (unsigned data_len = 1; data_len <= n; data_len *= 2) {
+            fft::Radix2<TypeParam> fft_2n(gf, n, data_len, size);
+
+            quadiron::vec::Buffers<TypeParam> v(data_len, size);
+            quadiron::vec::Buffers<TypeParam> v_ext(n, size);
+            quadiron::vec::Buffers<TypeParam> fft1(n, size);
+            quadiron::vec::Buffers<TypeParam> fft2(n, size);
+            quadiron::vec::Buffers<TypeParam> ifft2(n, size);
+            v_ext.zero_fill();
+            for (unsigned i = 0; i < data_len; i++) {
+                for (size_t u = 0; u < size; u++) {
+                    v.get(i)[u] = gf.rand();
+                    v_ext.get(i)[u] = v.get(i)[u];
+                }
+            }
+
+            fft_naive.fft(fft1, v_ext);
+            fft_2n.fft(fft2, v);
+            ASSERT_EQ(fft1, fft2);
+
+            fft_2n.ifft(ifft2, fft2);
+            ASSERT_EQ(ifft2, v_ext);
+        }
+    }
+}
+
 TYPED_TEST(FftTest, TestFftGt) // NOLINT
 {
     auto gf(gf::create<gf::BinExtension<TypeParam>>(16));
@@ -483,3 +521,175 @@ TYPED_TEST(FftTest, TestFftGf2n) // NOLINT
         this->test_fft_codec(gf, &fft, len);
     }
 }
+
+#ifdef QUADIRON_USE_SIMD
+
+namespace simd = quadiron::simd;
+namespace vec = quadiron::vec;
+
+class FftPackedF4Test : public ::testing::Test {
+  public:
+    // registers of packed elements per buffer
+    const size_t len = 5;
+    const size_t pkt_size = len * simd::countof<uint16_t>();
+
+    // random elements where edge values are frequent
+    void
+    random_fill(const gf::Field<uint32_t>& gf, vec::Buffers<uint32_t>& buf)
+    {
+        const uint32_t edges[] = {0, 1, 2, 32768, 65535, 65536};
+        for (int i = 0; i < buf.get_n(); ++i) {
+            for (size_t j = 0; j < pkt_size; ++j) {
+                buf.get(i)[j] =
+                    (gf.rand() % 2) ? edges[gf.rand() % 6] : gf.rand();
+            }
+        }
+    }
+
+    void pack(
+        vec::Buffers<uint32_t>& buf,
+        vec::Buffers<uint16_t>& val,
+        vec::Buffers<uint32_t>& oor)
+    {
+        for (int i = 0; i < buf.get_n(); ++i) {
+            simd::pack_f4_buf(buf.get(i), val.get(i), oor.get(i), len);
+        }
+    }
+
+    void unpack(
+        vec::Buffers<uint16_t>& val,
+        vec::Buffers<uint32_t>& oor,
+        vec::Buffers<uint32_t>& buf)
+    {
+        for (int i = 0; i < buf.get_n(); ++i) {
+            simd::unpack_f4_buf(val.get(i), oor.get(i), buf.get(i), len);
+        }
+    }
+};
+
+TEST_F(FftPackedF4Test, TestPackedArith) // NOLINT
+{
+    auto gf(gf::create<gf::Prime<uint32_t>>(65537));
+    vec::Buffers<uint32_t> input(2, pkt_size);
+    vec::Buffers<uint32_t> output(2, pkt_size);
+    vec::Buffers<uint16_t> val(2, pkt_size);
+    vec::Buffers<uint32_t> oor(2, len);
+    vec::Buffers<uint16_t> res_val(1, pkt_size);
+    vec::Buffers<uint32_t> res_oor(1, len);
+    vec::Buffers<uint32_t> res(1, pkt_size);
+
+    for (int iter = 0; iter < 100; ++iter) {
+        random_fill(gf, input);
+        pack(input, val, oor);
+        unpack(val, oor, output);
+        ASSERT_EQ(output, input);
+
+        auto x_val = reinterpret_cast<simd::VecType*>(val.get(0));
+        auto y_val = reinterpret_cast<simd::VecType*>(val.get(1));
+        auto z_val = reinterpret_cast<simd::VecType*>(res_val.get(0));
+
+        for (int op = 0; op < 4; ++op) {
+            for (size_t j = 0; j < len; ++j) {
+                const simd::PackedF4 x =
+                    simd::packed_load(x_val + j, oor.get(0)[j]);
+                const simd::PackedF4 y =
+                    simd::packed_load(y_val + j, oor.get(1)[j]);
+                simd::PackedF4 z;
+                switch (op) {
+                case 0:
+                    z = simd::mod_add(x, y);
+                    break;
+                case 1:
+                    z = simd::mod_sub(x, y);
+                    break;
+                case 2:
+                    z = simd::mod_mul(x, y);
+                    break;
+                default:
+                    z = simd::mod_neg(x);
+                    break;
+                }
+                res_oor.get(0)[j] = simd::packed_store(z_val + j, z);
+            }
+            unpack(res_val, res_oor, res);
+
+            for (size_t j = 0; j < pkt_size; ++j) {
+                const uint32_t a = input.get(0)[j];
+                const uint32_t b = input.get(1)[j];
+                uint32_t expected;
+                switch (op) {
+                case 0:
+                    expected = gf.add(a, b);
+                    break;
+                case 1:
+                    expected = gf.sub(a, b);
+                    break;
+                case 2:
+                    expected = gf.mul(a, b);
+                    break;
+                default:
+                    expected = gf.neg(a);
+                    break;
+                }
+                ASSERT_EQ(res.get(0)[j], expected);
+            }
+        }
+    }
+}
+
+TEST_F(FftPackedF4Test, TestPackedButterflies) // NOLINT
+{
+    auto gf(gf::create<gf::Prime<uint32_t>>(65537));
+    const unsigned n = 8;
+    vec::Buffers<uint32_t> input(n, pkt_size);
+    vec::Buffers<uint32_t> expected(n, pkt_size);
+    vec::Buffers<uint32_t> output(n, pkt_size);
+    vec::Buffers<uint16_t> val(n, pkt_size);
+    vec::Buffers<uint32_t> oor(n, len);
+
+    const std::vector<uint32_t> coefs = {
+        1, 65536, gf.get_nth_root(n), 2 + gf.rand() % 65534};
+    for (int op = 0; op < 3; ++op) {
+        for (const uint32_t r : coefs) {
+            for (unsigned m = 1; m < n; m <<= 1) {
+                for (unsigned start = 0; start < m; ++start) {
+                    random_fill(gf, input);
+                    expected.copy(input);
+                    pack(input, val, oor);
+
+                    for (unsigned i = start; i < n; i += 2 * m) {
+                        uint32_t* a = expected.get(i);
+                        uint32_t* b = expected.get(i + m);
+                        for (size_t j = 0; j < pkt_size; ++j) {
+                            const uint32_t x = a[j];
+                            const uint32_t y = b[j];
+                            if (op == 0) {
+                                a[j] = gf.add(x, gf.mul(r, y));
+                                b[j] = gf.sub(x, gf.mul(r, y));
+                            } else if (op == 1) {
+                                a[j] = gf.add(x, y);
+                                b[j] = gf.mul(r, gf.sub(x, y));
+                            } else {
+                                b[j] = gf.mul(r, x);
+                            }
+                        }
+                    }
+                    if (op == 0) {
+                        simd::butterfly_ct_step_packed(
+                            val, oor, r, start, m, len);
+                    } else if (op == 1) {
+                        simd::butterfly_gs_step_packed(
+                            val, oor, r, start, m, len);
+                    } else {
+                        simd::butterfly_gs_step_simple_packed(
+                            val, oor, r, start, m, len);
+                    }
+                    unpack(val, oor, output);
+                    ASSERT_EQ(output, expected);
+                }
+            }
+        }
+    }
+}
+
+#endif // #ifdef QUADIRON_USE_SIMD
@@ -0,0 +1,835 @@
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define QUADIRON_HAVE_IO_URING
+#endif
+#endif
+
+#ifdef QUADIRON_HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+#include "membuf.h"
+
+#include "fragment_io.h"
+
+namespace fragment_io {
+
+// alignment of buffers, offsets and lengths of O_DIRECT I/O
+static constexpr size_t DIRECT_ALIGN = 4096;
+
+#ifdef QUADIRON_HAVE_IO_URING
+
+/** Asynchronous request, completed once `done` is set */
+struct Request {
+    struct iovec iov;
+    bool done = true;
+    int res = 0;
+};
+
+/** Minimal io_uring submission and completion queues
+ *
+ * Only one thread submits requests and reaps their completions.
+ */
+class Ring {
+  public:
+    explicit Ring(unsigned entries);
+    ~Ring();
+
+    void read(int fd, void* buf, size_t len, uint64_t offset, Request* req)
+    {
+        submit(IORING_OP_READV, fd, buf, len, offset, req);
+    }
+
+    void write(int fd, void* buf, size_t len, uint64_t offset, Request* req)
+    {
+        submit(IORING_OP_WRITEV, fd, buf, len, offset, req);
+    }
+
+    /** Wait for the completion of a request */
+    void wait(Request* req);
+
+  private:
+    int fd;
+    unsigned entries;
+    unsigned in_flight = 0;
+
+    void* sq_ptr = MAP_FAILED;
+    void* cq_ptr = MAP_FAILED;
+    size_t sq_size;
+    size_t cq_size;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqes_size;
+
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    io_uring_cqe* cqes;
+
+    void release();
+    int enter(unsigned to_submit, unsigned min_complete, unsigned flags);
+    void submit(
+        uint8_t opcode,
+        int fd,
+        void* buf,
+        size_t len,
+        uint64_t offset,
+        Request* req);
+    void reap();
+};
+
+template <typename T>
+static inline T* ring_field(void* ring, uint32_t offset)
+{
+    return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+}
+
+Ring::Ring(unsigned entries)
+{
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+
+    fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (fd < 0) {
+        throw std::system_error(errno, std::system_category(), "io_uring");
+    }
+    this->entries = params.sq_entries;
+
+    sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    bool single_mmap = false;
+#ifdef IORING_FEAT_SINGLE_MMAP
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        single_mmap = true;
+        sq_size = cq_size = std::max(sq_size, cq_size);
+    }
+#endif
+
+    const int prot = PROT_READ | PROT_WRITE;
+    const int flags = MAP_SHARED | MAP_POPULATE;
+    sq_ptr = mmap(nullptr, sq_size, prot, flags, fd, IORING_OFF_SQ_RING);
+    if (sq_ptr != MAP_FAILED) {
+        cq_ptr = single_mmap ? sq_ptr
+                             : mmap(nullptr,
+                                    cq_size,
+                                    prot,
+                                    flags,
+                                    fd,
+                                    IORING_OFF_CQ_RING);
+    }
+    if (cq_ptr != MAP_FAILED) {
+        sqes = static_cast<io_uring_sqe*>(
+            mmap(nullptr, sqes_size, prot, flags, fd, IORING_OFF_SQES));
+    }
+    if (sqes == MAP_FAILED) {
+        const int error = errno;
+        release();
+        throw std::system_error(error, std::system_category(), "io_uring");
+    }
+
+    sq_tail = ring_field<unsigned>(sq_ptr, params.sq_off.tail);
+    sq_mask = ring_field<unsigned>(sq_ptr, params.sq_off.ring_mask);
+    sq_array = ring_field<unsigned>(sq_ptr, params.sq_off.array);
+    cq_head = ring_field<unsigned>(cq_ptr, params.cq_off.head);
+    cq_tail = ring_field<unsigned>(cq_ptr, params.cq_off.tail);
+    cq_mask = ring_field<unsigned>(cq_ptr, params.cq_off.ring_mask);
+    cqes = ring_field<io_uring_cqe>(cq_ptr, params.cq_off.cqes);
+}
+
+Ring::~Ring()
+{
+    release();
+}
+
+void Ring::release()
+{
+    if (sqes != MAP_FAILED) {
+        munmap(sqes, sqes_size);
+    }
+    if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) {
+        munmap(cq_ptr, cq_size);
+    }
+    if (sq_ptr != MAP_FAILED) {
+        munmap(sq_ptr, sq_size);
+    }
+    close(fd);
+}
+
+int Ring::enter(unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    int ret;
+    do {
+        ret = static_cast<int>(syscall(
+            __NR_io_uring_enter,
+            fd,
+            to_submit,
+            min_complete,
+            flags,
+            nullptr,
+            0));
+    } while (ret < 0 && errno == EINTR);
+
+    if (ret < 0) {
+        throw std::system_error(errno, std::system_category(), "io_uring");
+    }
+    return ret;
+}
+
+void Ring::submit(
+    uint8_t opcode,
+    int file,
+    void* buf,
+    size_t len,
+    uint64_t offset,
+    Request* req)
+{
+    // keep room in the completion queue for all requests in flight
+    while (in_flight >= entries) {
+        reap();
+        if (in_flight >= entries) {
+            enter(0, 1, IORING_ENTER_GETEVENTS);
+        }
+    }
+
+    req->iov.iov_base = buf;
+    req->iov.iov_len = len;
+    req->done = false;
+    req->res = 0;
+
+    const unsigned tail = *sq_tail;
+    const unsigned index = tail & *sq_mask;
+    io_uring_sqe* sqe = &sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->fd = file;
+    sqe->addr = reinterpret_cast<uint64_t>(&req->iov);
+    sqe->len = 1;
+    sqe->off = offset;
+    sqe->user_data = reinterpret_cast<uint64_t>(req);
+    sq_array[index] = index;
+    __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    in_flight++;
+    enter(1, 0, 0);
+}
+
+void Ring::reap()
+{
+    unsigned head = *cq_head;
+    const unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+
+    for (; head != tail; ++head) {
+        const io_uring_cqe& cqe = cqes[head & *cq_mask];
+        Request* req = reinterpret_cast<Request*>(cqe.user_data);
+        req->res = cqe.res;
+        req->done = true;
+        in_flight--;
+    }
+    __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+}
+
+void Ring::wait(Request* req)
+{
+    while (!req->done) {
+        reap();
+        if (!req->done) {
+            enter(0, 1, IORING_ENTER_GETEVENTS);
+        }
+    }
+}
+
+/** Buffer of a fragment and its request in flight */
+struct Slot {
+    char* buf = nullptr;
+    // offset in the file and length of the request
+    uint64_t offset = 0;
+    size_t len = 0;
+    Request req;
+};
+
+static char* alloc_buf(size_t size)
+{
+    void* buf = nullptr;
+    if (posix_memalign(&buf, DIRECT_ALIGN, size) != 0) {
+        throw std::bad_alloc();
+    }
+    return static_cast<char*>(buf);
+}
+
+/** Read a fragment ahead: a buffer is consumed while the other is read */
+class UringSourceBuf : public std::streambuf {
+  public:
+    UringSourceBuf(Ring* ring, int fd, size_t buf_size)
+        : ring(ring), fd(fd), buf_size(buf_size)
+    {
+        struct stat st;
+        file_size = fstat(fd, &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+
+        for (Slot& slot : slots) {
+            slot.buf = alloc_buf(buf_size);
+            read_ahead(&slot);
+        }
+        setg(nullptr, nullptr, nullptr);
+    }
+
+    ~UringSourceBuf() override
+    {
+        for (Slot& slot : slots) {
+            ring->wait(&slot.req);
+            free(slot.buf);
+        }
+        close(fd);
+    }
+
+  protected:
+    int_type underflow() override
+    {
+        if (gptr() < egptr()) {
+            return traits_type::to_int_type(*gptr());
+        }
+
+        // the consumed buffer reads ahead while the other one is consumed
+        if (current >= 0) {
+            read_ahead(&slots[current]);
+        }
+        current = current < 0 ? 0 : 1 - current;
+
+        Slot& slot = slots[current];
+        ring->wait(&slot.req);
+        if (slot.req.res < 0) {
+            throw std::system_error(
+                -slot.req.res, std::system_category(), "fragment read");
+        }
+        const auto len = static_cast<size_t>(slot.req.res);
+        if (len < slot.len && slot.offset + len < file_size) {
+            throw std::system_error(
+                EIO, std::system_category(), "short fragment read");
+        }
+        if (len == 0) {
+            return traits_type::eof();
+        }
+        setg(slot.buf, slot.buf, slot.buf + len);
+
+        return traits_type::to_int_type(*gptr());
+    }
+
+  private:
+    Ring* ring;
+    int fd;
+    size_t buf_size;
+    uint64_t file_size;
+    // offset of the next read ahead
+    uint64_t next_offset = 0;
+    // slot being consumed, -1 before the first read
+    int current = -1;
+    Slot slots[2];
+
+    void read_ahead(Slot* slot)
+    {
+        slot->offset = next_offset;
+        if (next_offset >= file_size) {
+            slot->len = 0;
+            slot->req.res = 0;
+            return;
+        }
+        slot->len = buf_size;
+        ring->read(fd, slot->buf, buf_size, next_offset, &slot->req);
+        next_offset += buf_size;
+    }
+};
+
+/** Write a fragment behind: a buffer is filled while the other is written
+ *
+ * With O_DIRECT, the last partial block is written padded with zeros and the
+ * file is then truncated to its actual size.
+ */
+class UringSinkBuf : public std::streambuf {
+  public:
+    UringSinkBuf(Ring* ring, int fd, size_t buf_size, bool direct)
+        : ring(ring), fd(fd), buf_size(buf_size), direct(direct)
+    {
+        for (Slot& slot : slots) {
+            slot.buf = alloc_buf(buf_size);
+        }
+        setp(slots[0].buf, slots[0].buf + buf_size);
+    }
+
+    // data is flushed by `Sink::close()`
+    ~UringSinkBuf() override
+    {
+        for (Slot& slot : slots) {
+            ring->wait(&slot.req);
+            free(slot.buf);
+        }
+        close(fd);
+    }
+
+  protected:
+    int_type overflow(int_type c) override
+    {
+        if (pptr() == epptr()) {
+            Slot& slot = slots[current];
+            write(&slot, buf_size);
+            offset += buf_size;
+
+            current = 1 - current;
+            if (!complete(&slots[current])) {
+                return traits_type::eof();
+            }
+            setp(slots[current].buf, slots[current].buf + buf_size);
+        }
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    int sync() override
+    {
+        const auto len = static_cast<size_t>(pptr() - pbase());
+        bool ok = complete(&slots[1 - current]);
+
+        // buffered data is kept so that it is rewritten once completed
+        if (len > 0) {
+            Slot& slot = slots[current];
+            size_t padded = len;
+            if (direct) {
+                padded = (len + DIRECT_ALIGN - 1) / DIRECT_ALIGN * DIRECT_ALIGN;
+                std::memset(pptr(), 0, padded - len);
+            }
+            write(&slot, padded);
+            ok = complete(&slot) && ok;
+        }
+        const auto size = static_cast<off_t>(offset + len);
+        if (ftruncate(fd, size) != 0) {
+            ok = false;
+        }
+
+        return ok && !error ? 0 : -1;
+    }
+
+  private:
+    Ring* ring;
+    int fd;
+    size_t buf_size;
+    bool direct;
+    bool error = false;
+    // offset of the buffer being filled
+    uint64_t offset = 0;
+    int current = 0;
+    Slot slots[2];
+
+    void write(Slot* slot, size_t len)
+    {
+        slot->offset = offset;
+        slot->len = len;
+        ring->write(fd, slot->buf, len, offset, &slot->req);
+    }
+
+    /** Wait for the write of a slot, if any, and check it is complete */
+    bool complete(Slot* slot)
+    {
+        ring->wait(&slot->req);
+        if (slot->len > 0 && slot->req.res != static_cast<int>(slot->len)) {
+            error = true;
+        }
+        slot->len = 0;
+        return !error;
+    }
+};
+
+/** Open a file with O_DIRECT if the file system supports it */
+static int open_file(const std::string& filename, int flags, bool* direct)
+{
+    int fd = open(filename.c_str(), flags | O_DIRECT | O_CLOEXEC, 0644);
+    *direct = fd >= 0;
+    if (fd < 0 && errno == EINVAL) {
+        fd = open(filename.c_str(), flags | O_CLOEXEC, 0644);
+    }
+    return fd;
+}
+
+#else
+
+class Ring {
+};
+
+#endif // QUADIRON_HAVE_IO_URING
+
+// pages of input mappings are read at once
+#ifdef MAP_POPULATE
+static constexpr int POPULATE = MAP_POPULATE;
+#else
+static constexpr int POPULATE = 0;
+#endif
+
+/** Read a fragment from a memory mapping of the whole file */
+class MmapSourceBuf : public quadiron::MemoryStreambuf {
+  public:
+    explicit MmapSourceBuf(int fd) : fd(fd)
+    {
+        struct stat st;
+        if (fstat(fd, &st) == 0) {
+            size = static_cast<size_t>(st.st_size);
+        }
+        if (size > 0) {
+            void* addr =
+                mmap(nullptr, size, PROT_READ, MAP_PRIVATE | POPULATE, fd, 0);
+            if (addr == MAP_FAILED) {
+                // the destructor is not run
+                const int err = errno;
+                close(fd);
+                throw std::system_error(
+                    err, std::system_category(), "fragment mmap");
+            }
+            base = static_cast<char*>(addr);
+            madvise(base, size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+            madvise(base, size, MADV_HUGEPAGE);
+#endif
+        }
+        setg(base, base, base + size);
+    }
+
+    ~MmapSourceBuf() override
+    {
+        if (base != nullptr) {
+            munmap(base, size);
+        }
+        close(fd);
+    }
+
+  private:
+    int fd;
+    char* base = nullptr;
+    size_t size = 0;
+};
+
+/** Write a fragment into a growing memory mapping of the file
+ *
+ * Blocks of the file are allocated before being mapped, so that a full file
+ * system is reported as an error instead of a fault on access. The file is
+ * truncated to the written size when it is synced.
+ */
+class MmapSinkBuf : public quadiron::MemoryStreambuf {
+  public:
+    MmapSinkBuf(int fd, size_t size_hint) : fd(fd)
+    {
+        if (!reserve(std::max(size_hint, MIN_CAPACITY))) {
+            // the destructor is not run, nothing is mapped
+            const int err = errno;
+            close(fd);
+            throw std::system_error(
+                err, std::system_category(), "fragment mmap");
+        }
+    }
+
+    ~MmapSinkBuf() override
+    {
+        if (base != nullptr) {
+            munmap(base, capacity);
+        }
+        close(fd);
+    }
+
+  protected:
+    bool reserve(size_t len) override
+    {
+        const size_t used = get_used();
+        size_t new_capacity = std::max(2 * capacity, used + len);
+        new_capacity = std::max(new_capacity, MIN_CAPACITY);
+
+        if (!allocate(new_capacity)) {
+            return false;
+        }
+        void* addr;
+        if (base == nullptr) {
+            addr = mmap(
+                nullptr,
+                new_capacity,
+                PROT_READ | PROT_WRITE,
+                MAP_SHARED,
+                fd,
+                0);
+        } else {
+#ifdef MREMAP_MAYMOVE
+            addr = mremap(base, capacity, new_capacity, MREMAP_MAYMOVE);
+#else
+            munmap(base, capacity);
+            base = nullptr;
+            addr = mmap(
+                nullptr,
+                new_capacity,
+                PROT_READ | PROT_WRITE,
+                MAP_SHARED,
+                fd,
+                0);
+#endif
+        }
+        if (addr == MAP_FAILED) {
+            return false;
+        }
+        base = static_cast<char*>(addr);
+        capacity = new_capacity;
+        madvise(base, capacity, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+        madvise(base, capacity, MADV_HUGEPAGE);
+#endif
+        set_put_area(base, base + capacity, used);
+
+        return true;
+    }
+
+    int_type overflow(int_type c) override
+    {
+        if (traits_type::eq_int_type(c, traits_type::eof())) {
+            return traits_type::not_eof(c);
+        }
+        if (pptr() == epptr() && !reserve(1)) {
+            return traits_type::eof();
+        }
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+        return c;
+    }
+
+    int sync() override
+    {
+        // the file ends after written bytes, it grows again on next writes
+        const size_t used = get_used();
+        if (ftruncate(fd, static_cast<off_t>(used)) != 0) {
+            return -1;
+        }
+        allocated = used;
+        set_put_area(base, base + used, used);
+        return 0;
+    }
+
+  private:
+    static constexpr size_t MIN_CAPACITY = 1 << 20;
+
+    int fd;
+    char* base = nullptr;
+    // size of the mapping and of the file
+    size_t capacity = 0;
+    size_t allocated = 0;
+
+    size_t get_used() const
+    {
+        return base == nullptr ? 0 : static_cast<size_t>(pptr() - base);
+    }
+
+    /** Allocate blocks of the file up to `size` */
+    bool allocate(size_t size)
+    {
+        if (size <= allocated) {
+            return true;
+        }
+        int ret = -1;
+#ifdef __linux__
+        ret = fallocate(fd, 0, 0, static_cast<off_t>(size));
+        if (ret != 0 && errno != EOPNOTSUPP) {
+            return false;
+        }
+#endif
+        if (ret != 0 && ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            return false;
+        }
+        allocated = size;
+        return true;
+    }
+};
+
+constexpr size_t MmapSinkBuf::MIN_CAPACITY;
+
+Source::Source(std::unique_ptr<std::streambuf> sb)
+    : std::istream(sb.get()), buf(std::move(sb))
+{
+}
+
+Source::~Source() = default;
+
+void Source::close()
+{
+    rdbuf(nullptr);
+    buf.reset();
+}
+
+Sink::Sink(std::unique_ptr<std::streambuf> sb)
+    : std::ostream(sb.get()), buf(std::move(sb))
+{
+}
+
+Sink::~Sink()
+{
+    if (buf) {
+        close();
+    }
+}
+
+bool Sink::close()
+{
+    bool ok = !bad();
+    if (buf) {
+        ok = buf->pubsync() == 0 && ok;
+    }
+    rdbuf(nullptr);
+    buf.reset();
+    return ok;
+}
+
+Io::Io(Backend backend, unsigned n_fragments, size_t buf_size)
+    : backend(backend),
+      buf_size((buf_size + DIRECT_ALIGN - 1) / DIRECT_ALIGN * DIRECT_ALIGN)
+{
+    if (backend != Backend::URING) {
+        return;
+    }
+#ifdef QUADIRON_HAVE_IO_URING
+    try {
+        // each fragment has up to two requests in flight
+        ring.reset(new Ring(2 * n_fragments));
+    } catch (const std::system_error& e) {
+        std::cerr << "io_uring is not available (" << e.what()
+                  << "), using streams\n";
+        this->backend = Backend::STREAM;
+    }
+#else
+    (void)n_fragments;
+    std::cerr << "io_uring is not supported, using streams\n";
+    this->backend = Backend::STREAM;
+#endif
+}
+
+Io::~Io() = default;
+
+Source* Io::open_source(const std::string& filename)
+{
+    if (backend == Backend::MMAP) {
+        const int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return new Source(nullptr);
+        }
+        try {
+            return new Source(
+                std::unique_ptr<std::streambuf>(new MmapSourceBuf(fd)));
+        } catch (const std::system_error&) {
+            return new Source(nullptr);
+        }
+    }
+#ifdef QUADIRON_HAVE_IO_URING
+    if (backend == Backend::URING) {
+        bool direct;
+        const int fd = open_file(filename, O_RDONLY, &direct);
+        if (fd < 0) {
+            return new Source(nullptr);
+        }
+        return new Source(std::unique_ptr<std::streambuf>(
+            new UringSourceBuf(ring.get(), fd, buf_size)));
+    }
+#endif
+    std::unique_ptr<std::filebuf> fb(new std::filebuf());
+    if (fb->open(filename, std::ios::in | std::ios::binary) == nullptr) {
+        return new Source(nullptr);
+    }
+    return new Source(std::move(fb));
+}
+
+Sink* Io::open_sink(const std::string& filename, size_t size_hint)
+{
+    if (backend == Backend::MMAP) {
+        const int flags = O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC;
+        const int fd = open(filename.c_str(), flags, 0644);
+        if (fd < 0) {
+            return new Sink(nullptr);
+        }
+        try {
+            return new Sink(std::unique_ptr<std::streambuf>(
+                new MmapSinkBuf(fd, size_hint)));
+        } catch (const std::system_error&) {
+            return new Sink(nullptr);
+        }
+    }
+#ifdef QUADIRON_HAVE_IO_URING
+    if (backend == Backend::URING) {
+        bool direct;
+        const int fd =
+            open_file(filename, O_WRONLY | O_CREAT | O_TRUNC, &direct);
+        if (fd < 0) {
+            return new Sink(nullptr);
+        }
+        return new Sink(std::unique_ptr<std::streambuf>(
+            new UringSinkBuf(ring.get(), fd, buf_size, direct)));
+    }
+#endif
+    std::unique_ptr<std::filebuf> fb(new std::filebuf());
+    if (fb->open(filename, std::ios::out | std::ios::binary) == nullptr) {
+        return new Sink(nullptr);
+    }
+    return new Sink(std::move(fb));
+}
+
+bool parse_backend(const std::string& name, Backend* backend)
+{
+    if (name == "stream") {
+        *backend = Backend::STREAM;
+    } else if (name == "uring") {
+        *backend = Backend::URING;
+    } else if (name == "mmap") {
+        *backend = Backend::MMAP;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+} // namespace fragment_io
@@ -0,0 +1,139 @@
+/* -*- mode: c++ -*- */
+/*
+ * Copyright 2017-2018 Scality
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __QUAD_FRAGMENT_IO_H__
+#define __QUAD_FRAGMENT_IO_H__
+
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+/** Sequential I/O of fragment files
+ *
+ * Fragments are read through `Source` and written through `Sink` streams, so
+ * that they can be given as is to the encoding and decoding functions. The
+ * way they access files depends on the backend of the `Io` context that
+ * opened them.
+ */
+namespace fragment_io {
+
+enum class Backend {
+    /** Synchronous I/O through standard file streams */
+    STREAM = 0,
+    /** Asynchronous O_DIRECT I/O through io_uring, with double buffering */
+    URING,
+    /** Memory mappings from and to which packets are accessed in place */
+    MMAP,
+};
+
+class Ring;
+
+/** Fragment being read */
+class Source : public std::istream {
+  public:
+    explicit Source(std::unique_ptr<std::streambuf> buf);
+    ~Source() override;
+    void close();
+
+  private:
+    std::unique_ptr<std::streambuf> buf;
+};
+
+/** Fragment being written */
+class Sink : public std::ostream {
+  public:
+    explicit Sink(std::unique_ptr<std::streambuf> buf);
+    ~Sink() override;
+    /** Flush buffered data and close the file
+     *
+     * @return false if some data could not be written
+     */
+    bool close();
+
+  private:
+    std::unique_ptr<std::streambuf> buf;
+};
+
+/** Context shared by fragments of an operation
+ *
+ * With the io_uring backend, all fragments share a single ring in which the
+ * reads ahead and writes behind of each fragment are kept in flight while
+ * packets are being coded. The backend falls back to standard streams if
+ * io_uring is not available.
+ *
+ * Fragments must be closed or deleted before their context.
+ */
+class Io {
+  public:
+    /**
+     * @param backend requested backend
+     * @param n_fragments number of fragments opened at the same time
+     * @param buf_size size of each of the two buffers of a fragment, a
+     * multiple of the block size of O_DIRECT I/O
+     */
+    Io(Backend backend,
+       unsigned n_fragments,
+       size_t buf_size = DEFAULT_BUF_SIZE);
+    ~Io();
+
+    Backend get_backend() const
+    {
+        return backend;
+    }
+
+    /** Open a fragment for reading, `fail()` is set on error */
+    Source* open_source(const std::string& filename);
+    /** Create or truncate a fragment for writing, `fail()` is set on error
+     *
+     * @param filename name of the fragment file
+     * @param size_hint expected size of the fragment, 0 if unknown
+     */
+    Sink* open_sink(const std::string& filename, size_t size_hint = 0);
+
+    static constexpr size_t DEFAULT_BUF_SIZE = 256 * 1024;
+
+  private:
+    Backend backend;
+    size_t buf_size;
+    std::unique_ptr<Ring> ring;
+};
+
+/** Parse the name of a backend, i.e. `stream`, `uring` or `mmap`
+ *
+ * @return true if `name` is a known backend
+ */
+bool parse_backend(const std::string& name, Backend* backend);
+
+} // namespace fragment_io
+
+#endif
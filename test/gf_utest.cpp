@@ -27,6 +27,8 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  */
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include "gf_bin_ext.h"
@@ -152,6 +154,59 @@ TYPED_TEST(GfTestCommon, TestGf2n) // NOLINT
     }
 }
 
+// Bit-serial reference multiplication in GF(2^n), n >= 32
+template <typename T>
+T gf2n_ref_mul(T a, T b, unsigned n, T poly)
+{
+    const T top = T(1) << (n - 1);
+    T res = 0;
+    for (unsigned i = 0; i < n; i++) {
+        if ((b >> i) & 1) {
+            res ^= a;
+        }
+        const bool carry = (a & top) != 0;
+        a = (a ^ (carry ? top : 0)) << 1;
+        if (carry) {
+            a ^= poly;
+        }
+    }
+    return res;
+}
+
+TYPED_TEST(GfTestCommon, TestGf2nWide) // NOLINT
+{
+    const TypeParam polys[] = {0x8d, 0x1b, 0x87};
+    unsigned idx = 0;
+    for (unsigned n = 32; n <= 8 * sizeof(TypeParam); n *= 2, idx++) {
+        auto gf(gf::create<gf::BinExtension<TypeParam>>(n));
+        const size_t len = 64;
+        std::vector<TypeParam> src(len);
+        std::vector<TypeParam> dest(len);
+
+        for (int i = 0; i < 100; i++) {
+            const TypeParam a = gf.rand();
+            for (size_t j = 0; j < len; j++) {
+                src[j] = gf.rand();
+            }
+            src[0] = 0;
+            src[1] = 1;
+            src[2] = gf.card_minus_one();
+
+            gf.mul_coef_to_buf(a, src.data(), dest.data(), len);
+            for (size_t j = 0; j < len; j++) {
+                const TypeParam expected =
+                    gf2n_ref_mul<TypeParam>(a, src[j], n, polys[idx]);
+                ASSERT_EQ(gf.mul(a, src[j]), expected);
+                ASSERT_EQ(dest[j], expected);
+            }
+            if (a != 0) {
+                ASSERT_EQ(gf.mul(a, gf.inv(a)), 1);
+                ASSERT_EQ(gf.div(gf.mul(a, src[3]), a), src[3]);
+            }
+        }
+    }
+}
+
 template <typename T>
 class GfTestNo128 : public GfTestCommon<T> {
 };